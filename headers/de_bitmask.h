@@ -5,14 +5,23 @@
   To get function definitions include
   `#define DE_CONTAINER_BITMASK_IMPLEMENTATION`
   before including this file.
+  de_bvec_to_indices fills a de_vec, its definition is only emitted when
+  DE_CONTAINER_VECTOR_IMPLEMENTATION is defined in the same translation unit.
 */
 
 #include <common.h>
+#include <de_vector.h>
 #include <stdbool.h>
 
 #ifndef DE_CONTAINER_BITMASK_OPTIONS
 #ifdef DE_CONTAINER_BITMASK_OPTIONS
 #define DE_CONTAINER_NO_SAFETY_CHECKS
+/* never select the avx-512 block kernels (avoids the clock drop on some cpus) */
+#define DE_CONTAINER_BITMASK_NO_AVX512
+/* min blocks per thread of the parallel bulk operations, defaults to 16384 (1M bits) */
+#define DE_CONTAINER_BITMASK_PARALLEL_MIN_BLOCKS 16384
+/* max stack depth of de_bvec_eval programs, defaults to 8 */
+#define DE_CONTAINER_BITMASK_EXPR_MAX_DEPTH 8
 #endif
 #endif
 
@@ -31,6 +40,41 @@
 typedef u64 mblk_t;
 #define DE_BVEC_MBLK_BITS 64
 
+/* ---- Cpu dispatch ----
+  shared by the runtime dispatched kernels of de_bvec, de_bloom and
+  de_vec_stats. DE_BVEC_CPU_AVX512 means f, bw, dq and vl
+*/
+typedef enum {
+  DE_BVEC_CPU_BASELINE,
+  DE_BVEC_CPU_AVX2,
+  DE_BVEC_CPU_AVX512
+} DE_BVEC_cpu_level;
+
+static inline DE_BVEC_cpu_level DE_BVEC_cpu_detect(u0) {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+      __builtin_cpu_supports("avx512dq") &&
+      __builtin_cpu_supports("avx512vl"))
+    return DE_BVEC_CPU_AVX512;
+  if (__builtin_cpu_supports("avx2"))
+    return DE_BVEC_CPU_AVX2;
+#endif
+  return DE_BVEC_CPU_BASELINE;
+}
+
+/* the kernel table cached in *_slot, picked by _pick on first use. racing
+   threads all pick the same table, so a second store changes nothing */
+static inline const u0 *DE_BVEC_dispatch(const u0 **const _slot,
+                                         const u0 *(*_pick)(u0)) {
+  const u0 *out = __atomic_load_n(_slot, __ATOMIC_ACQUIRE);
+  if (out)
+    return out;
+  out = _pick();
+  __atomic_store_n(_slot, out, __ATOMIC_RELEASE);
+  return out;
+}
+
 // clang-format off
 
 /* ---- Struct ---- */
@@ -40,7 +84,7 @@ typedef struct {
     mblk_t* blocks;  /* pointer to heap blocks (length = block_count) */
   } data;
   usize bits_amount;       /* logical number of bits */
-  usize block_count;     /* number of blocks allocated or used */
+  usize block_count;     /* number of blocks allocated (capacity), 0 when small */
   usize last_block_bits_count;     /* number of used bits in last block */
   bool   is_small;        /* true => use .data.small */
 } de_bvec;
@@ -74,8 +118,8 @@ de_bvec_delete(
   de_bvec* const _msk
 );
 /*
-increase the structs size till its >= _amount_bits.
-Does not decrease size
+sets the size to _amount_bits, growing the capacity to exactly fit it if needed.
+Does not decrease the capacity, bits past a smaller size are cleared
 */
 DE_CONTAINER_BITMASK_API u0
 de_bvec_reserve(
@@ -85,8 +129,9 @@ de_bvec_reserve(
 
 /*
 increase or decrease the size.
-will loose data if _amount_bits is smaller that previous
-may contain a behaviourbug on same data_size as before, todo: fix
+will loose data if _amount_bits is smaller that previous.
+grows the capacity geometrically (at least doubling), a size that still fits only
+updates the size, the capacity is never decreased
 */
 DE_CONTAINER_BITMASK_API u0
 de_bvec_resize(
@@ -94,6 +139,33 @@ de_bvec_resize(
   const usize         _amount_bits
 );
 
+/*
+releases the capacity past the used blocks, masks of <= 64 bits go back to soo
+*/
+DE_CONTAINER_BITMASK_API u0
+de_bvec_shrink_to_fit(
+  de_bvec* const _msk
+);
+
+/*
+appends one bit, amortized O(1)
+*/
+DE_CONTAINER_BITMASK_API u0
+de_bvec_push_back(
+  de_bvec* const _msk,
+  const bool     _value
+);
+
+/*
+appends the low _amount (<= 64) bits of _bits, bit 0 first
+*/
+DE_CONTAINER_BITMASK_API u0
+de_bvec_append_bits(
+  de_bvec* const _msk,
+  const mblk_t   _bits,
+  const usize    _amount
+);
+
 
 /* 
 deep copies _src into _dst
@@ -237,6 +309,343 @@ de_bvec_not(
   de_bvec* const _dst
 );
 
+/* ---- Shifts / rotates ----
+  shl moves bit i to i + _amount (towards higher indices), shr to i - _amount.
+  bits moved past either end are dropped and the vacated ones become 0, rotates
+  bring them in at the other end. any _amount is allowed (>= size clears for
+  shifts, is taken modulo the size for rotates).
+  the _to variants write _src shifted into _dst, which gets _src's size.
+  _dst has to be a created mask, _dst == _src works like the in place call
+*/
+
+DE_CONTAINER_BITMASK_API u0
+de_bvec_shl(
+  de_bvec* const _msk,
+  const usize    _amount
+);
+
+DE_CONTAINER_BITMASK_API u0
+de_bvec_shr(
+  de_bvec* const _msk,
+  const usize    _amount
+);
+
+DE_CONTAINER_BITMASK_API u0
+de_bvec_rotl(
+  de_bvec* const _msk,
+  const usize    _amount
+);
+
+DE_CONTAINER_BITMASK_API u0
+de_bvec_rotr(
+  de_bvec* const _msk,
+  const usize    _amount
+);
+
+DE_CONTAINER_BITMASK_API u0
+de_bvec_shl_to(
+  de_bvec* const       _dst,
+  const de_bvec* const _src,
+  const usize          _amount
+);
+
+DE_CONTAINER_BITMASK_API u0
+de_bvec_shr_to(
+  de_bvec* const       _dst,
+  const de_bvec* const _src,
+  const usize          _amount
+);
+
+DE_CONTAINER_BITMASK_API u0
+de_bvec_rotl_to(
+  de_bvec* const       _dst,
+  const de_bvec* const _src,
+  const usize          _amount
+);
+
+DE_CONTAINER_BITMASK_API u0
+de_bvec_rotr_to(
+  de_bvec* const       _dst,
+  const de_bvec* const _src,
+  const usize          _amount
+);
+
+/* ---- Fused / multi-operand ----
+  results are computed chunk by chunk in a small stack buffer, so every
+  operand block is read once, the result written once and nothing is
+  allocated. all operands need the same size, _dst (if given) gets it too
+  and may be one of the operands.
+
+  de_bvec_eval runs a postfix program: PUSH pushes its operand, a binary op
+  combines the top with its operand, or pops the right hand side from the
+  stack when the operand is NULL, NOT inverts the top. exactly one value has
+  to remain. popcount(a & b & ~c) without a result mask:
+    const de_bvec_expr prog[] = {{DE_BVEC_EXPR_PUSH, &a},
+                                 {DE_BVEC_EXPR_AND, &b},
+                                 {DE_BVEC_EXPR_ANDNOT, &c}};
+    usize ones = de_bvec_eval(NULL, prog, 3);
+*/
+
+typedef enum {
+  DE_BVEC_EXPR_PUSH,
+  DE_BVEC_EXPR_AND,
+  DE_BVEC_EXPR_OR,
+  DE_BVEC_EXPR_XOR,
+  DE_BVEC_EXPR_ANDNOT, /* lhs & ~rhs */
+  DE_BVEC_EXPR_NOT
+} de_bvec_expr_op;
+
+typedef struct {
+  de_bvec_expr_op op;
+  const de_bvec*  operand;
+} de_bvec_expr;
+
+/*
+evaluates _steps steps of _expr into _dst (NULL to only count) and returns
+the number of set bits of the result
+*/
+DE_CONTAINER_BITMASK_API usize
+de_bvec_eval(
+  de_bvec* const            _dst,
+  const de_bvec_expr* const _expr,
+  const usize               _steps
+);
+
+/*
+_dst = _a op _b, andnot is _a & ~_b
+*/
+DE_CONTAINER_BITMASK_API u0
+de_bvec_and_into(
+  de_bvec* const       _dst,
+  const de_bvec* const _a,
+  const de_bvec* const _b
+);
+
+DE_CONTAINER_BITMASK_API u0
+de_bvec_or_into(
+  de_bvec* const       _dst,
+  const de_bvec* const _a,
+  const de_bvec* const _b
+);
+
+DE_CONTAINER_BITMASK_API u0
+de_bvec_xor_into(
+  de_bvec* const       _dst,
+  const de_bvec* const _a,
+  const de_bvec* const _b
+);
+
+DE_CONTAINER_BITMASK_API u0
+de_bvec_andnot_into(
+  de_bvec* const       _dst,
+  const de_bvec* const _a,
+  const de_bvec* const _b
+);
+
+/*
+popcount(_a & _b) / popcount(_a & ~_b) without a result mask
+*/
+DE_CONTAINER_BITMASK_API usize
+de_bvec_and_count(
+  const de_bvec* const _a,
+  const de_bvec* const _b
+);
+
+DE_CONTAINER_BITMASK_API usize
+de_bvec_andnot_count(
+  const de_bvec* const _a,
+  const de_bvec* const _b
+);
+
+/*
+true when _a and _b share a set bit, stops at the first one
+*/
+DE_CONTAINER_BITMASK_API bool
+de_bvec_intersects(
+  const de_bvec* const _a,
+  const de_bvec* const _b
+);
+
+/* ---- Atomic access ----
+  for several threads writing one mask (e.g. a shared visited set). _order is
+  one of the gcc __ATOMIC_* constants: __ATOMIC_RELAXED when only the bits
+  matter, __ATOMIC_ACQ_REL (__ATOMIC_ACQUIRE for get, __ATOMIC_RELEASE for set
+  and clear) to order the data guarded by the bit. the mask must not be resized
+  meanwhile, and plain writes to the same block race with the atomic ones
+*/
+
+/*
+atomically sets the bit at the given index to 1
+*/
+DE_CONTAINER_BITMASK_API u0
+de_bvec_atomic_set(
+  de_bvec* const _msk,
+  const usize    _idx,
+  const i32      _order
+);
+
+/*
+atomically sets the bit at the given index to 1 and returns its previous state.
+exactly one of several threads racing on a 0 bit gets false
+*/
+DE_CONTAINER_BITMASK_API bool
+de_bvec_atomic_test_and_set(
+  de_bvec* const _msk,
+  const usize    _idx,
+  const i32      _order
+);
+
+/*
+atomically sets the bit at the given index to 0
+*/
+DE_CONTAINER_BITMASK_API u0
+de_bvec_atomic_clear(
+  de_bvec* const _msk,
+  const usize    _idx,
+  const i32      _order
+);
+
+/*
+atomically reads the bit at the given index
+*/
+DE_CONTAINER_BITMASK_API bool
+de_bvec_atomic_get(
+  const de_bvec* const _msk,
+  const usize          _idx,
+  const i32            _order
+);
+
+/*
+atomically ors _bits into the block holding bits [_block_idx * 64, _block_idx * 64 + 64)
+and returns the previous block. _bits & ~previous are the bits this call set
+*/
+DE_CONTAINER_BITMASK_API mblk_t
+de_bvec_atomic_fetch_or_block(
+  de_bvec* const _msk,
+  const usize    _block_idx,
+  const mblk_t   _bits,
+  const i32      _order
+);
+
+/* ---- Parallel bulk operations ----
+  _threads: 1 runs on the calling thread, 0 uses one thread per logical cpu.
+  the blocks are split in contiguous ranges of at least
+  DE_CONTAINER_BITMASK_PARALLEL_MIN_BLOCKS blocks, one per thread.
+  uses pthreads (link with -pthread), on _WIN32 it runs serial
+*/
+
+/*
+de_bvec_fill split across threads
+*/
+DE_CONTAINER_BITMASK_API u0
+de_bvec_parallel_fill(
+  de_bvec* const _msk,
+  const usize    _threads
+);
+
+/*
+de_bvec_clear split across threads
+*/
+DE_CONTAINER_BITMASK_API u0
+de_bvec_parallel_clear(
+  de_bvec* const _msk,
+  const usize    _threads
+);
+
+/*
+de_bvec_count split across threads
+*/
+DE_CONTAINER_BITMASK_API usize
+de_bvec_parallel_count(
+  const de_bvec* const _msk,
+  const usize          _threads
+);
+
+/* ---- Search / iteration ---- */
+
+/*
+returns the index of the first 1 bit at or after _from_idx,
+bits_amount if there is none (also for _from_idx >= bits_amount)
+*/
+DE_CONTAINER_BITMASK_API usize
+de_bvec_find_next_set(
+  const de_bvec* const _msk,
+  const usize          _from_idx
+);
+
+/*
+returns the index of the first 0 bit at or after _from_idx,
+bits_amount if there is none
+*/
+DE_CONTAINER_BITMASK_API usize
+de_bvec_find_next_clear(
+  const de_bvec* const _msk,
+  const usize          _from_idx
+);
+
+/*
+returns the index of the last 1 bit at or before _from_idx,
+bits_amount if there is none. _from_idx >= bits_amount searches from the end
+*/
+DE_CONTAINER_BITMASK_API usize
+de_bvec_find_prev_set(
+  const de_bvec* const _msk,
+  const usize          _from_idx
+);
+
+/*
+returns the index of the first 0 bit, bits_amount if all bits are 1
+*/
+DE_CONTAINER_BITMASK_API usize
+de_bvec_find_first_clear(
+  const de_bvec* const _msk
+);
+
+/*
+returns the start of the first run of _amount consecutive 0 bits that starts
+at or after _from_idx, bits_amount if there is none. full blocks are skipped
+*/
+DE_CONTAINER_BITMASK_API usize
+de_bvec_find_clear_run(
+  const de_bvec* const _msk,
+  const usize          _amount,
+  const usize          _from_idx
+);
+
+/*
+slot allocator: finds a run of _amount 0 bits, sets it to 1 and returns its start,
+bits_amount if there is none (nothing is changed then).
+next fit: the search starts at *_cursor and wraps around once, *_cursor is moved
+past the claimed run. _cursor may be NULL for first fit.
+give runs back with de_bvec_clear_range(_msk, start, start + _amount - 1)
+*/
+DE_CONTAINER_BITMASK_API usize
+de_bvec_claim_run(
+  de_bvec* const _msk,
+  const usize    _amount,
+  usize* const   _cursor
+);
+
+/*
+writes the indices of all 1 bits in ascending order into _out.
+_out has to be created with item_size 4 (u32) or 8 (u64), previous contents are dropped.
+decodes whole blocks at a time
+*/
+extern u0
+de_bvec_to_indices(
+  const de_bvec* const _msk,
+  de_vec* const        _out
+);
+
+/*
+iterates _it (usize, declared by the macro) over the indices of all 1 bits in ascending order.
+_msk must not be resized inside the loop, setting or clearing bits ahead of _it is seen
+*/
+#define DE_BVEC_FOR_EACH_SET(_it, _msk)                                        \
+  for (usize _it = de_bvec_find_next_set((_msk), 0);                           \
+       _it < (_msk)->bits_amount;                                              \
+       _it = de_bvec_find_next_set((_msk), _it + 1))
+
 /* ---- Info / Introspection ---- */
 
 /*
@@ -247,6 +656,14 @@ de_bvec_info_size(
   const de_bvec* const _msk
 );
 
+/*
+retuns the amount of bits that fit without reallocating
+*/
+DE_CONTAINER_BITMASK_API usize
+de_bvec_info_capacity(
+  const de_bvec* const _msk
+);
+
 /*
 retuns if the struct is valid
 if malloc worked etc
@@ -321,6 +738,13 @@ DE_CONTAINER_BITMASK_API u0 de_bvec_print(
 #include <stdlib.h>
 #include <string.h>
 
+#ifndef DE_CONTAINER_BITMASK_PARALLEL_MIN_BLOCKS
+#define DE_CONTAINER_BITMASK_PARALLEL_MIN_BLOCKS 16384
+#endif
+#ifndef DE_CONTAINER_BITMASK_EXPR_MAX_DEPTH
+#define DE_CONTAINER_BITMASK_EXPR_MAX_DEPTH 8
+#endif
+
 #define DE_BVEC_MBLK_FILLED (~(mblk_t)0)
 
 #define DE_BVEC_GET_BLOCKS_AMOUNT(amount)                                      \
@@ -356,43 +780,816 @@ DE_CONTAINER_BITMASK_INTERNAL u0 DE_BVEC_memmov(mblk_t *const _dst,
   memmove(_dst, _src, _size * sizeof(mblk_t));
 }
 
-DE_CONTAINER_BITMASK_INTERNAL u0 DE_BVEC_memset(mblk_t *const _data,
-                                                const mblk_t _value,
-                                                const usize _size) {
-  for (usize i = 0; i < _size; ++i)
-    _data[i] = _value;
+/* ---- Block kernels ----
+  the bulk operations run over whole block arrays through a kernel table,
+  picked once from the cpu feature bits: scalar, avx2, avx-512 (f + bw) and
+  avx-512 with vpopcntdq for count. popcount without vpopcntdq uses
+  harley-seal (carry save adders over 16 vectors, one lookup popcount per 16).
+  index decoding goes byte by byte through a table of packed bit positions
+  on avx2 and through vpcompress on avx-512
+*/
+
+typedef struct {
+  u0 (*and_blocks)(mblk_t *_dst, const mblk_t *_src, usize _n);
+  u0 (*or_blocks)(mblk_t *_dst, const mblk_t *_src, usize _n);
+  u0 (*xor_blocks)(mblk_t *_dst, const mblk_t *_src, usize _n);
+  u0 (*not_blocks)(mblk_t *_dst, usize _n);
+  u0 (*fill_blocks)(mblk_t *_dst, mblk_t _value, usize _n);
+  usize (*count_blocks)(const mblk_t *_src, usize _n);
+  bool (*any_blocks)(const mblk_t *_src, usize _n);  /* any bit set */
+  bool (*full_blocks)(const mblk_t *_src, usize _n); /* all bits set */
+  /* indices (_base + bit position) of the 1 bits, returns the amount written.
+     may store up to 16 entries past the last written one */
+  usize (*decode_u32)(const mblk_t *_src, usize _n, usize _base, u32 *_out);
+  usize (*decode_u64)(const mblk_t *_src, usize _n, usize _base, u64 *_out);
+  /* funnel shifts by 0 < _r < 64, dst may equal src (or lie above it for
+     left, below it for right: left runs downwards, right upwards).
+     left:  dst[i] = src[i] << r | src[i - 1] >> (64 - r), src[-1] reads 0
+     right: dst[i] = src[i] >> r | src[i + 1] << (64 - r), src[n - 1] reads
+            as _top and src[n] as 0 */
+  u0 (*shl_blocks)(mblk_t *_dst, const mblk_t *_src, usize _n, u32 _r);
+  u0 (*shr_blocks)(mblk_t *_dst, const mblk_t *_src, usize _n, u32 _r,
+                   mblk_t _top);
+  u0 (*andnot_blocks)(mblk_t *_dst, const mblk_t *_src, usize _n); /* &= ~ */
+} DE_BVEC_kernels_t;
+
+/* generic loops, used for the tails of the vector kernels as well */
+DE_CONTAINER_BITMASK_INTERNAL u0 DE_BVEC_and_scalar(mblk_t *_dst,
+                                                    const mblk_t *_src,
+                                                    usize _n) {
+  for (usize i = 0; i < _n; ++i)
+    _dst[i] &= _src[i];
+}
+DE_CONTAINER_BITMASK_INTERNAL u0 DE_BVEC_or_scalar(mblk_t *_dst,
+                                                   const mblk_t *_src,
+                                                   usize _n) {
+  for (usize i = 0; i < _n; ++i)
+    _dst[i] |= _src[i];
+}
+DE_CONTAINER_BITMASK_INTERNAL u0 DE_BVEC_xor_scalar(mblk_t *_dst,
+                                                    const mblk_t *_src,
+                                                    usize _n) {
+  for (usize i = 0; i < _n; ++i)
+    _dst[i] ^= _src[i];
+}
+DE_CONTAINER_BITMASK_INTERNAL u0 DE_BVEC_andnot_scalar(mblk_t *_dst,
+                                                       const mblk_t *_src,
+                                                       usize _n) {
+  for (usize i = 0; i < _n; ++i)
+    _dst[i] &= ~_src[i];
+}
+DE_CONTAINER_BITMASK_INTERNAL u0 DE_BVEC_not_scalar(mblk_t *_dst, usize _n) {
+  for (usize i = 0; i < _n; ++i)
+    _dst[i] = ~_dst[i];
+}
+DE_CONTAINER_BITMASK_INTERNAL u0 DE_BVEC_fill_scalar(mblk_t *_dst,
+                                                     mblk_t _value, usize _n) {
+  for (usize i = 0; i < _n; ++i)
+    _dst[i] = _value;
+}
+DE_CONTAINER_BITMASK_INTERNAL usize DE_BVEC_count_scalar(const mblk_t *_src,
+                                                         usize _n) {
+  usize out = 0;
+  for (usize i = 0; i < _n; ++i)
+    out += (usize)__builtin_popcountll(_src[i]);
+  return out;
+}
+DE_CONTAINER_BITMASK_INTERNAL bool DE_BVEC_any_scalar(const mblk_t *_src,
+                                                      usize _n) {
+  for (usize i = 0; i < _n; ++i)
+    if (_src[i])
+      return true;
+  return false;
+}
+DE_CONTAINER_BITMASK_INTERNAL bool DE_BVEC_full_scalar(const mblk_t *_src,
+                                                       usize _n) {
+  for (usize i = 0; i < _n; ++i)
+    if (~_src[i])
+      return false;
+  return true;
+}
+/* one tzcnt per set bit, cheap for sparse blocks and skips empty ones */
+DE_CONTAINER_BITMASK_INTERNAL usize DE_BVEC_decode_u32_scalar(
+    const mblk_t *_src, usize _n, usize _base, u32 *_out) {
+  u32 *o = _out;
+  for (usize i = 0; i < _n; ++i, _base += DE_BVEC_MBLK_BITS) {
+    for (mblk_t w = _src[i]; w; w &= w - 1)
+      *o++ = (u32)(_base + (usize)__builtin_ctzll(w));
+  }
+  return (usize)(o - _out);
+}
+DE_CONTAINER_BITMASK_INTERNAL usize DE_BVEC_decode_u64_scalar(
+    const mblk_t *_src, usize _n, usize _base, u64 *_out) {
+  u64 *o = _out;
+  for (usize i = 0; i < _n; ++i, _base += DE_BVEC_MBLK_BITS) {
+    for (mblk_t w = _src[i]; w; w &= w - 1)
+      *o++ = (u64)(_base + (usize)__builtin_ctzll(w));
+  }
+  return (usize)(o - _out);
 }
 
-// #define _memmov memcpy
+/* _i counts down from _n, the vector kernels hand over the low remainder */
+DE_CONTAINER_BITMASK_INTERNAL u0 DE_BVEC_shl_scalar(mblk_t *_dst,
+                                                    const mblk_t *_src,
+                                                    usize _n, u32 _r) {
+  for (usize i = _n; i-- > 1;)
+    _dst[i] = (_src[i] << _r) | (_src[i - 1] >> (DE_BVEC_MBLK_BITS - _r));
+  if (_n)
+    _dst[0] = _src[0] << _r;
+}
+DE_CONTAINER_BITMASK_INTERNAL u0 DE_BVEC_shr_scalar(mblk_t *_dst,
+                                                    const mblk_t *_src,
+                                                    usize _n, u32 _r,
+                                                    mblk_t _top) {
+  if (!_n)
+    return;
+  for (usize i = 0; i + 2 < _n; ++i)
+    _dst[i] = (_src[i] >> _r) | (_src[i + 1] << (DE_BVEC_MBLK_BITS - _r));
+  if (_n >= 2)
+    _dst[_n - 2] =
+        (_src[_n - 2] >> _r) | (_top << (DE_BVEC_MBLK_BITS - _r));
+  _dst[_n - 1] = _top >> _r;
+}
 
-/* ---- Lifecycle ---- */
-DE_CONTAINER_BITMASK_INTERNAL de_bvec de_bvec_create(const usize _amount_bits) {
-  if (_amount_bits <= DE_BVEC_MBLK_BITS) {
-    return (de_bvec){.data.small = 0,
-                     .is_small = true,
-                     .bits_amount = _amount_bits,
-                     .block_count = 0,
-                     .last_block_bits_count =
-                         DE_BVEC_BITS_MOD_MBLK(_amount_bits)};
-  } else {
-    const usize blocks = DE_BVEC_GET_BLOCKS_AMOUNT(_amount_bits);
-    return (de_bvec){.data.blocks = (mblk_t *)DE_BVEC_calloc(blocks),
-                     .is_small = false,
-                     .bits_amount = _amount_bits,
-                     .block_count = blocks,
-                     .last_block_bits_count =
-                         DE_BVEC_BITS_MOD_MBLK(_amount_bits)};
+static const DE_BVEC_kernels_t DE_BVEC_kernels_scalar = {
+    DE_BVEC_and_scalar,        DE_BVEC_or_scalar,
+    DE_BVEC_xor_scalar,        DE_BVEC_not_scalar,
+    DE_BVEC_fill_scalar,       DE_BVEC_count_scalar,
+    DE_BVEC_any_scalar,        DE_BVEC_full_scalar,
+    DE_BVEC_decode_u32_scalar, DE_BVEC_decode_u64_scalar,
+    DE_BVEC_shl_scalar,        DE_BVEC_shr_scalar,
+    DE_BVEC_andnot_scalar};
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DE_BVEC_HAVE_DISPATCH
+
+/* dst op= src for the full vectors, the scalar loop takes the rest */
+#define DE_BVEC_DEFINE_BINARY_KERNEL(_name, _target, _vec, _lanes, _load,      \
+                                     _store, _op, _tail)                       \
+  _target DE_CONTAINER_BITMASK_INTERNAL u0 _name(                              \
+      mblk_t *_dst, const mblk_t *_src, usize _n) {                            \
+    usize i = 0;                                                               \
+    for (; i + 4 * (_lanes) <= _n; i += 4 * (_lanes)) {                        \
+      for (usize k = 0; k < 4 * (_lanes); k += (_lanes)) {                     \
+        const _vec a = _load((const _vec *)(_dst + i + k));                    \
+        const _vec b = _load((const _vec *)(_src + i + k));                    \
+        _store((_vec *)(_dst + i + k), _op(a, b));                             \
+      }                                                                        \
+    }                                                                          \
+    _tail(_dst + i, _src + i, _n - i);                                         \
+  }
+
+/* funnel shifts, _lanes blocks per vector. left walks down from the top and
+   leaves [0, i) to the scalar loop, right walks up and leaves the top */
+#define DE_BVEC_DEFINE_SHIFT_KERNELS(_left, _right, _target, _vec, _lanes,     \
+                                     _load, _store, _sll, _srl, _or)           \
+  _target DE_CONTAINER_BITMASK_INTERNAL u0 _left(                              \
+      mblk_t *_dst, const mblk_t *_src, usize _n, u32 _r) {                    \
+    const __m128i up = _mm_cvtsi32_si128((i32)_r);                             \
+    const __m128i down = _mm_cvtsi32_si128((i32)(DE_BVEC_MBLK_BITS - _r));     \
+    usize i = _n;                                                              \
+    for (; i >= (_lanes) + 1; i -= (_lanes)) {                                 \
+      const _vec v = _load((const _vec *)(_src + i - (_lanes)));               \
+      const _vec p = _load((const _vec *)(_src + i - (_lanes)-1));             \
+      _store((_vec *)(_dst + i - (_lanes)), _or(_sll(v, up), _srl(p, down)));  \
+    }                                                                          \
+    DE_BVEC_shl_scalar(_dst, _src, i, _r);                                     \
+  }                                                                            \
+  _target DE_CONTAINER_BITMASK_INTERNAL u0 _right(                             \
+      mblk_t *_dst, const mblk_t *_src, usize _n, u32 _r, mblk_t _top) {       \
+    const __m128i down = _mm_cvtsi32_si128((i32)_r);                           \
+    const __m128i up = _mm_cvtsi32_si128((i32)(DE_BVEC_MBLK_BITS - _r));       \
+    usize i = 0;                                                               \
+    /* the loads stay below src[n - 1], which reads as _top */                 \
+    for (; i + (_lanes) + 2 <= _n; i += (_lanes)) {                            \
+      const _vec v = _load((const _vec *)(_src + i));                          \
+      const _vec q = _load((const _vec *)(_src + i + 1));                      \
+      _store((_vec *)(_dst + i), _or(_srl(v, down), _sll(q, up)));             \
+    }                                                                          \
+    DE_BVEC_shr_scalar(_dst + i, _src + i, _n - i, _r, _top);                  \
+  }
+
+/* -- avx2 -- */
+
+DE_BVEC_DEFINE_BINARY_KERNEL(DE_BVEC_and_avx2, __attribute__((target("avx2"))),
+                             __m256i, 4, _mm256_loadu_si256,
+                             _mm256_storeu_si256, _mm256_and_si256,
+                             DE_BVEC_and_scalar)
+DE_BVEC_DEFINE_BINARY_KERNEL(DE_BVEC_or_avx2, __attribute__((target("avx2"))),
+                             __m256i, 4, _mm256_loadu_si256,
+                             _mm256_storeu_si256, _mm256_or_si256,
+                             DE_BVEC_or_scalar)
+DE_BVEC_DEFINE_BINARY_KERNEL(DE_BVEC_xor_avx2, __attribute__((target("avx2"))),
+                             __m256i, 4, _mm256_loadu_si256,
+                             _mm256_storeu_si256, _mm256_xor_si256,
+                             DE_BVEC_xor_scalar)
+/* vpandn negates its first operand */
+#define DE_BVEC_ANDNOT_AVX2(_a, _b) _mm256_andnot_si256(_b, _a)
+DE_BVEC_DEFINE_BINARY_KERNEL(DE_BVEC_andnot_avx2,
+                             __attribute__((target("avx2"))), __m256i, 4,
+                             _mm256_loadu_si256, _mm256_storeu_si256,
+                             DE_BVEC_ANDNOT_AVX2, DE_BVEC_andnot_scalar)
+
+__attribute__((target("avx2"))) DE_CONTAINER_BITMASK_INTERNAL u0
+DE_BVEC_not_avx2(mblk_t *_dst, usize _n) {
+  const __m256i ones = _mm256_set1_epi64x(-1);
+  usize i = 0;
+  for (; i + 4 <= _n; i += 4) {
+    const __m256i a = _mm256_loadu_si256((const __m256i *)(_dst + i));
+    _mm256_storeu_si256((__m256i *)(_dst + i), _mm256_xor_si256(a, ones));
   }
+  DE_BVEC_not_scalar(_dst + i, _n - i);
 }
-DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_create_i(de_bvec *const _msk,
-                                                  const usize _amount_bits) {
-  *_msk = de_bvec_create(_amount_bits);
+
+__attribute__((target("avx2"))) DE_CONTAINER_BITMASK_INTERNAL u0
+DE_BVEC_fill_avx2(mblk_t *_dst, mblk_t _value, usize _n) {
+  const __m256i v = _mm256_set1_epi64x((long long)_value);
+  usize i = 0;
+  for (; i + 4 <= _n; i += 4)
+    _mm256_storeu_si256((__m256i *)(_dst + i), v);
+  DE_BVEC_fill_scalar(_dst + i, _value, _n - i);
 }
 
-DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_free(de_bvec *const _msk) {
-  if (!_msk->is_small) {
-    free(_msk->data.blocks);
-  }
+/* per 64 bit lane popcount of a vector: nibble lookup + sum of bytes */
+__attribute__((target("avx2"))) static inline __m256i
+DE_BVEC_popcount_avx2(const __m256i _v) {
+  const __m256i lookup =
+      _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1,
+                       2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low = _mm256_set1_epi8(0x0f);
+  const __m256i lo = _mm256_and_si256(_v, low);
+  const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(_v, 4), low);
+  const __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+                                        _mm256_shuffle_epi8(lookup, hi));
+  return _mm256_sad_epu8(bytes, _mm256_setzero_si256());
+}
+
+/* carry save adder: (*_h, *_l) = a + b + c */
+#define DE_BVEC_CSA_AVX2(_h, _l, _a, _b, _c)                                   \
+  do {                                                                         \
+    const __m256i u_ = _mm256_xor_si256(_a, _b);                               \
+    *(_h) = _mm256_or_si256(_mm256_and_si256(_a, _b),                          \
+                            _mm256_and_si256(u_, _c));                         \
+    *(_l) = _mm256_xor_si256(u_, _c);                                          \
+  } while (0)
+
+__attribute__((target("avx2"))) DE_CONTAINER_BITMASK_INTERNAL usize
+DE_BVEC_count_avx2(const mblk_t *_src, usize _n) {
+  const __m256i *d = (const __m256i *)_src;
+  const usize vectors = _n / 4;
+  __m256i total = _mm256_setzero_si256();
+  __m256i ones = _mm256_setzero_si256(), twos = ones, fours = ones,
+          eights = ones, sixteens;
+  __m256i twos_a, twos_b, fours_a, fours_b, eights_a, eights_b;
+  usize i = 0;
+#define DE_BVEC_LD(_k) _mm256_loadu_si256(d + i + (_k))
+  for (; i + 16 <= vectors; i += 16) {
+    DE_BVEC_CSA_AVX2(&twos_a, &ones, ones, DE_BVEC_LD(0), DE_BVEC_LD(1));
+    DE_BVEC_CSA_AVX2(&twos_b, &ones, ones, DE_BVEC_LD(2), DE_BVEC_LD(3));
+    DE_BVEC_CSA_AVX2(&fours_a, &twos, twos, twos_a, twos_b);
+    DE_BVEC_CSA_AVX2(&twos_a, &ones, ones, DE_BVEC_LD(4), DE_BVEC_LD(5));
+    DE_BVEC_CSA_AVX2(&twos_b, &ones, ones, DE_BVEC_LD(6), DE_BVEC_LD(7));
+    DE_BVEC_CSA_AVX2(&fours_b, &twos, twos, twos_a, twos_b);
+    DE_BVEC_CSA_AVX2(&eights_a, &fours, fours, fours_a, fours_b);
+    DE_BVEC_CSA_AVX2(&twos_a, &ones, ones, DE_BVEC_LD(8), DE_BVEC_LD(9));
+    DE_BVEC_CSA_AVX2(&twos_b, &ones, ones, DE_BVEC_LD(10), DE_BVEC_LD(11));
+    DE_BVEC_CSA_AVX2(&fours_a, &twos, twos, twos_a, twos_b);
+    DE_BVEC_CSA_AVX2(&twos_a, &ones, ones, DE_BVEC_LD(12), DE_BVEC_LD(13));
+    DE_BVEC_CSA_AVX2(&twos_b, &ones, ones, DE_BVEC_LD(14), DE_BVEC_LD(15));
+    DE_BVEC_CSA_AVX2(&fours_b, &twos, twos, twos_a, twos_b);
+    DE_BVEC_CSA_AVX2(&eights_b, &fours, fours, fours_a, fours_b);
+    DE_BVEC_CSA_AVX2(&sixteens, &eights, eights, eights_a, eights_b);
+    total = _mm256_add_epi64(total, DE_BVEC_popcount_avx2(sixteens));
+  }
+#undef DE_BVEC_LD
+  total = _mm256_slli_epi64(total, 4);
+  total = _mm256_add_epi64(
+      total, _mm256_slli_epi64(DE_BVEC_popcount_avx2(eights), 3));
+  total = _mm256_add_epi64(
+      total, _mm256_slli_epi64(DE_BVEC_popcount_avx2(fours), 2));
+  total = _mm256_add_epi64(
+      total, _mm256_slli_epi64(DE_BVEC_popcount_avx2(twos), 1));
+  total = _mm256_add_epi64(total, DE_BVEC_popcount_avx2(ones));
+  for (; i < vectors; ++i)
+    total = _mm256_add_epi64(total,
+                             DE_BVEC_popcount_avx2(_mm256_loadu_si256(d + i)));
+  usize out = (usize)_mm256_extract_epi64(total, 0) +
+              (usize)_mm256_extract_epi64(total, 1) +
+              (usize)_mm256_extract_epi64(total, 2) +
+              (usize)_mm256_extract_epi64(total, 3);
+  return out + DE_BVEC_count_scalar(_src + vectors * 4, _n - vectors * 4);
+}
+
+/* early exit after every 16 blocks */
+__attribute__((target("avx2"))) DE_CONTAINER_BITMASK_INTERNAL bool
+DE_BVEC_any_avx2(const mblk_t *_src, usize _n) {
+  usize i = 0;
+  for (; i + 16 <= _n; i += 16) {
+    const __m256i *d = (const __m256i *)(_src + i);
+    const __m256i v = _mm256_or_si256(
+        _mm256_or_si256(_mm256_loadu_si256(d), _mm256_loadu_si256(d + 1)),
+        _mm256_or_si256(_mm256_loadu_si256(d + 2), _mm256_loadu_si256(d + 3)));
+    if (!_mm256_testz_si256(v, v))
+      return true;
+  }
+  return DE_BVEC_any_scalar(_src + i, _n - i);
+}
+
+__attribute__((target("avx2"))) DE_CONTAINER_BITMASK_INTERNAL bool
+DE_BVEC_full_avx2(const mblk_t *_src, usize _n) {
+  const __m256i ones = _mm256_set1_epi64x(-1);
+  usize i = 0;
+  for (; i + 16 <= _n; i += 16) {
+    const __m256i *d = (const __m256i *)(_src + i);
+    const __m256i v = _mm256_and_si256(
+        _mm256_and_si256(_mm256_loadu_si256(d), _mm256_loadu_si256(d + 1)),
+        _mm256_and_si256(_mm256_loadu_si256(d + 2), _mm256_loadu_si256(d + 3)));
+    if (!_mm256_testc_si256(v, ones))
+      return false;
+  }
+  return DE_BVEC_full_scalar(_src + i, _n - i);
+}
+
+/* positions of the 1 bits of a byte packed into the low bytes of a u64,
+   built at compile time: bit i lands in byte popcount(m & ((1 << i) - 1)) */
+#define DE_BVEC_LUT_POP(_m)                                                    \
+  (((_m) & 1) + (((_m) >> 1) & 1) + (((_m) >> 2) & 1) + (((_m) >> 3) & 1) +    \
+   (((_m) >> 4) & 1) + (((_m) >> 5) & 1) + (((_m) >> 6) & 1) +                 \
+   (((_m) >> 7) & 1))
+#define DE_BVEC_LUT_BIT(_m, _i)                                                \
+  ((((_m) >> (_i)) & 1)                                                        \
+       ? ((u64)(_i) << (8 * DE_BVEC_LUT_POP((_m) & ((1u << (_i)) - 1))))       \
+       : 0)
+#define DE_BVEC_LUT_ENTRY(_m)                                                  \
+  (DE_BVEC_LUT_BIT(_m, 0) | DE_BVEC_LUT_BIT(_m, 1) | DE_BVEC_LUT_BIT(_m, 2) |  \
+   DE_BVEC_LUT_BIT(_m, 3) | DE_BVEC_LUT_BIT(_m, 4) | DE_BVEC_LUT_BIT(_m, 5) |  \
+   DE_BVEC_LUT_BIT(_m, 6) | DE_BVEC_LUT_BIT(_m, 7))
+#define DE_BVEC_LUT_ROW(_h)                                                    \
+  DE_BVEC_LUT_ENTRY((_h) + 0), DE_BVEC_LUT_ENTRY((_h) + 1),                    \
+      DE_BVEC_LUT_ENTRY((_h) + 2), DE_BVEC_LUT_ENTRY((_h) + 3),                \
+      DE_BVEC_LUT_ENTRY((_h) + 4), DE_BVEC_LUT_ENTRY((_h) + 5),                \
+      DE_BVEC_LUT_ENTRY((_h) + 6), DE_BVEC_LUT_ENTRY((_h) + 7),                \
+      DE_BVEC_LUT_ENTRY((_h) + 8), DE_BVEC_LUT_ENTRY((_h) + 9),                \
+      DE_BVEC_LUT_ENTRY((_h) + 10), DE_BVEC_LUT_ENTRY((_h) + 11),              \
+      DE_BVEC_LUT_ENTRY((_h) + 12), DE_BVEC_LUT_ENTRY((_h) + 13),              \
+      DE_BVEC_LUT_ENTRY((_h) + 14), DE_BVEC_LUT_ENTRY((_h) + 15)
+
+static const u64 DE_BVEC_decode_lut[256] = {
+    DE_BVEC_LUT_ROW(0),   DE_BVEC_LUT_ROW(16),  DE_BVEC_LUT_ROW(32),
+    DE_BVEC_LUT_ROW(48),  DE_BVEC_LUT_ROW(64),  DE_BVEC_LUT_ROW(80),
+    DE_BVEC_LUT_ROW(96),  DE_BVEC_LUT_ROW(112), DE_BVEC_LUT_ROW(128),
+    DE_BVEC_LUT_ROW(144), DE_BVEC_LUT_ROW(160), DE_BVEC_LUT_ROW(176),
+    DE_BVEC_LUT_ROW(192), DE_BVEC_LUT_ROW(208), DE_BVEC_LUT_ROW(224),
+    DE_BVEC_LUT_ROW(240)};
+
+/* 8 entries are stored per byte, the cursor moves by its popcount */
+__attribute__((target("avx2,popcnt"))) DE_CONTAINER_BITMASK_INTERNAL usize
+DE_BVEC_decode_u32_avx2(const mblk_t *_src, usize _n, usize _base,
+                        u32 *_out) {
+  u32 *o = _out;
+  for (usize i = 0; i < _n; ++i, _base += DE_BVEC_MBLK_BITS) {
+    mblk_t w = _src[i];
+    if (!w)
+      continue;
+    __m256i idx = _mm256_set1_epi32((i32)(u32)_base);
+    for (; w; w >>= 8, idx = _mm256_add_epi32(idx, _mm256_set1_epi32(8))) {
+      const u32 byte = (u32)(w & 0xff);
+      const __m256i pos = _mm256_cvtepu8_epi32(
+          _mm_cvtsi64_si128((long long)DE_BVEC_decode_lut[byte]));
+      _mm256_storeu_si256((__m256i *)o, _mm256_add_epi32(idx, pos));
+      o += __builtin_popcount(byte);
+    }
+  }
+  return (usize)(o - _out);
+}
+
+__attribute__((target("avx2,popcnt"))) DE_CONTAINER_BITMASK_INTERNAL usize
+DE_BVEC_decode_u64_avx2(const mblk_t *_src, usize _n, usize _base,
+                        u64 *_out) {
+  u64 *o = _out;
+  for (usize i = 0; i < _n; ++i, _base += DE_BVEC_MBLK_BITS) {
+    mblk_t w = _src[i];
+    if (!w)
+      continue;
+    __m256i idx = _mm256_set1_epi64x((long long)_base);
+    for (; w; w >>= 8, idx = _mm256_add_epi64(idx, _mm256_set1_epi64x(8))) {
+      const u32 byte = (u32)(w & 0xff);
+      const __m128i packed =
+          _mm_cvtsi64_si128((long long)DE_BVEC_decode_lut[byte]);
+      _mm256_storeu_si256((__m256i *)o,
+                          _mm256_add_epi64(idx, _mm256_cvtepu8_epi64(packed)));
+      _mm256_storeu_si256(
+          (__m256i *)(o + 4),
+          _mm256_add_epi64(idx,
+                           _mm256_cvtepu8_epi64(_mm_srli_epi64(packed, 32))));
+      o += __builtin_popcount(byte);
+    }
+  }
+  return (usize)(o - _out);
+}
+
+DE_BVEC_DEFINE_SHIFT_KERNELS(DE_BVEC_shl_avx2, DE_BVEC_shr_avx2,
+                             __attribute__((target("avx2"))), __m256i, 4,
+                             _mm256_loadu_si256, _mm256_storeu_si256,
+                             _mm256_sll_epi64, _mm256_srl_epi64,
+                             _mm256_or_si256)
+
+static const DE_BVEC_kernels_t DE_BVEC_kernels_avx2 = {
+    DE_BVEC_and_avx2,        DE_BVEC_or_avx2,
+    DE_BVEC_xor_avx2,        DE_BVEC_not_avx2,
+    DE_BVEC_fill_avx2,       DE_BVEC_count_avx2,
+    DE_BVEC_any_avx2,        DE_BVEC_full_avx2,
+    DE_BVEC_decode_u32_avx2, DE_BVEC_decode_u64_avx2,
+    DE_BVEC_shl_avx2,        DE_BVEC_shr_avx2,
+    DE_BVEC_andnot_avx2};
+
+/* -- avx-512 -- */
+#ifndef DE_CONTAINER_BITMASK_NO_AVX512
+#define DE_BVEC_AVX512_TARGET __attribute__((target("avx512f,avx512bw")))
+
+DE_BVEC_DEFINE_BINARY_KERNEL(DE_BVEC_and_avx512, DE_BVEC_AVX512_TARGET,
+                             __m512i, 8, _mm512_loadu_si512,
+                             _mm512_storeu_si512, _mm512_and_si512,
+                             DE_BVEC_and_scalar)
+DE_BVEC_DEFINE_BINARY_KERNEL(DE_BVEC_or_avx512, DE_BVEC_AVX512_TARGET,
+                             __m512i, 8, _mm512_loadu_si512,
+                             _mm512_storeu_si512, _mm512_or_si512,
+                             DE_BVEC_or_scalar)
+DE_BVEC_DEFINE_BINARY_KERNEL(DE_BVEC_xor_avx512, DE_BVEC_AVX512_TARGET,
+                             __m512i, 8, _mm512_loadu_si512,
+                             _mm512_storeu_si512, _mm512_xor_si512,
+                             DE_BVEC_xor_scalar)
+#define DE_BVEC_ANDNOT_AVX512(_a, _b) _mm512_andnot_si512(_b, _a)
+DE_BVEC_DEFINE_BINARY_KERNEL(DE_BVEC_andnot_avx512, DE_BVEC_AVX512_TARGET,
+                             __m512i, 8, _mm512_loadu_si512,
+                             _mm512_storeu_si512, DE_BVEC_ANDNOT_AVX512,
+                             DE_BVEC_andnot_scalar)
+
+DE_BVEC_AVX512_TARGET DE_CONTAINER_BITMASK_INTERNAL u0
+DE_BVEC_not_avx512(mblk_t *_dst, usize _n) {
+  usize i = 0;
+  for (; i + 8 <= _n; i += 8) {
+    const __m512i a = _mm512_loadu_si512((const __m512i *)(_dst + i));
+    _mm512_storeu_si512((__m512i *)(_dst + i),
+                        _mm512_ternarylogic_epi64(a, a, a, 0x55));
+  }
+  /* masked store for the last partial vector */
+  if (i < _n) {
+    const __mmask8 m = (__mmask8)((1u << (_n - i)) - 1);
+    const __m512i a = _mm512_maskz_loadu_epi64(m, _dst + i);
+    _mm512_mask_storeu_epi64(_dst + i, m,
+                             _mm512_ternarylogic_epi64(a, a, a, 0x55));
+  }
+}
+
+DE_BVEC_AVX512_TARGET DE_CONTAINER_BITMASK_INTERNAL u0
+DE_BVEC_fill_avx512(mblk_t *_dst, mblk_t _value, usize _n) {
+  const __m512i v = _mm512_set1_epi64((long long)_value);
+  usize i = 0;
+  for (; i + 8 <= _n; i += 8)
+    _mm512_storeu_si512((__m512i *)(_dst + i), v);
+  if (i < _n)
+    _mm512_mask_storeu_epi64(_dst + i, (__mmask8)((1u << (_n - i)) - 1), v);
+}
+
+DE_BVEC_AVX512_TARGET static inline __m512i
+DE_BVEC_popcount_avx512(const __m512i _v) {
+  const __m512i lookup = _mm512_broadcast_i32x4(
+      _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4));
+  const __m512i low = _mm512_set1_epi8(0x0f);
+  const __m512i lo = _mm512_and_si512(_v, low);
+  const __m512i hi = _mm512_and_si512(_mm512_srli_epi16(_v, 4), low);
+  const __m512i bytes = _mm512_add_epi8(_mm512_shuffle_epi8(lookup, lo),
+                                        _mm512_shuffle_epi8(lookup, hi));
+  return _mm512_sad_epu8(bytes, _mm512_setzero_si512());
+}
+
+/* carry save adder with two ternary logic ops (majority and parity) */
+#define DE_BVEC_CSA_AVX512(_h, _l, _a, _b, _c)                                 \
+  do {                                                                         \
+    const __m512i a_ = (_a), b_ = (_b), c_ = (_c);                             \
+    *(_h) = _mm512_ternarylogic_epi64(a_, b_, c_, 0xe8);                       \
+    *(_l) = _mm512_ternarylogic_epi64(a_, b_, c_, 0x96);                       \
+  } while (0)
+
+DE_BVEC_AVX512_TARGET DE_CONTAINER_BITMASK_INTERNAL usize
+DE_BVEC_count_avx512(const mblk_t *_src, usize _n) {
+  const __m512i *d = (const __m512i *)_src;
+  const usize vectors = _n / 8;
+  __m512i total = _mm512_setzero_si512();
+  __m512i ones = _mm512_setzero_si512(), twos = ones, fours = ones,
+          eights = ones, sixteens;
+  __m512i twos_a, twos_b, fours_a, fours_b, eights_a, eights_b;
+  usize i = 0;
+#define DE_BVEC_LD(_k) _mm512_loadu_si512(d + i + (_k))
+  for (; i + 16 <= vectors; i += 16) {
+    DE_BVEC_CSA_AVX512(&twos_a, &ones, ones, DE_BVEC_LD(0), DE_BVEC_LD(1));
+    DE_BVEC_CSA_AVX512(&twos_b, &ones, ones, DE_BVEC_LD(2), DE_BVEC_LD(3));
+    DE_BVEC_CSA_AVX512(&fours_a, &twos, twos, twos_a, twos_b);
+    DE_BVEC_CSA_AVX512(&twos_a, &ones, ones, DE_BVEC_LD(4), DE_BVEC_LD(5));
+    DE_BVEC_CSA_AVX512(&twos_b, &ones, ones, DE_BVEC_LD(6), DE_BVEC_LD(7));
+    DE_BVEC_CSA_AVX512(&fours_b, &twos, twos, twos_a, twos_b);
+    DE_BVEC_CSA_AVX512(&eights_a, &fours, fours, fours_a, fours_b);
+    DE_BVEC_CSA_AVX512(&twos_a, &ones, ones, DE_BVEC_LD(8), DE_BVEC_LD(9));
+    DE_BVEC_CSA_AVX512(&twos_b, &ones, ones, DE_BVEC_LD(10), DE_BVEC_LD(11));
+    DE_BVEC_CSA_AVX512(&fours_a, &twos, twos, twos_a, twos_b);
+    DE_BVEC_CSA_AVX512(&twos_a, &ones, ones, DE_BVEC_LD(12), DE_BVEC_LD(13));
+    DE_BVEC_CSA_AVX512(&twos_b, &ones, ones, DE_BVEC_LD(14), DE_BVEC_LD(15));
+    DE_BVEC_CSA_AVX512(&fours_b, &twos, twos, twos_a, twos_b);
+    DE_BVEC_CSA_AVX512(&eights_b, &fours, fours, fours_a, fours_b);
+    DE_BVEC_CSA_AVX512(&sixteens, &eights, eights, eights_a, eights_b);
+    total = _mm512_add_epi64(total, DE_BVEC_popcount_avx512(sixteens));
+  }
+#undef DE_BVEC_LD
+  total = _mm512_slli_epi64(total, 4);
+  total = _mm512_add_epi64(
+      total, _mm512_slli_epi64(DE_BVEC_popcount_avx512(eights), 3));
+  total = _mm512_add_epi64(
+      total, _mm512_slli_epi64(DE_BVEC_popcount_avx512(fours), 2));
+  total = _mm512_add_epi64(
+      total, _mm512_slli_epi64(DE_BVEC_popcount_avx512(twos), 1));
+  total = _mm512_add_epi64(total, DE_BVEC_popcount_avx512(ones));
+  for (; i < vectors; ++i)
+    total = _mm512_add_epi64(
+        total, DE_BVEC_popcount_avx512(_mm512_loadu_si512(d + i)));
+  return (usize)_mm512_reduce_add_epi64(total) +
+         DE_BVEC_count_scalar(_src + vectors * 8, _n - vectors * 8);
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq"))) DE_CONTAINER_BITMASK_INTERNAL
+    usize
+    DE_BVEC_count_avx512_vpopcntdq(const mblk_t *_src, usize _n) {
+  __m512i acc0 = _mm512_setzero_si512(), acc1 = acc0;
+  usize i = 0;
+  for (; i + 16 <= _n; i += 16) {
+    acc0 = _mm512_add_epi64(
+        acc0, _mm512_popcnt_epi64(_mm512_loadu_si512(_src + i)));
+    acc1 = _mm512_add_epi64(
+        acc1, _mm512_popcnt_epi64(_mm512_loadu_si512(_src + i + 8)));
+  }
+  if (i + 8 <= _n) {
+    acc0 = _mm512_add_epi64(
+        acc0, _mm512_popcnt_epi64(_mm512_loadu_si512(_src + i)));
+    i += 8;
+  }
+  if (i < _n)
+    acc1 = _mm512_add_epi64(
+        acc1, _mm512_popcnt_epi64(_mm512_maskz_loadu_epi64(
+                  (__mmask8)((1u << (_n - i)) - 1), _src + i)));
+  return (usize)_mm512_reduce_add_epi64(_mm512_add_epi64(acc0, acc1));
+}
+
+DE_BVEC_AVX512_TARGET DE_CONTAINER_BITMASK_INTERNAL bool
+DE_BVEC_any_avx512(const mblk_t *_src, usize _n) {
+  usize i = 0;
+  for (; i + 32 <= _n; i += 32) {
+    const __m512i *d = (const __m512i *)(_src + i);
+    const __m512i v = _mm512_ternarylogic_epi64(
+        _mm512_loadu_si512(d), _mm512_loadu_si512(d + 1),
+        _mm512_or_si512(_mm512_loadu_si512(d + 2), _mm512_loadu_si512(d + 3)),
+        0xfe);
+    if (_mm512_test_epi64_mask(v, v))
+      return true;
+  }
+  return DE_BVEC_any_scalar(_src + i, _n - i);
+}
+
+DE_BVEC_AVX512_TARGET DE_CONTAINER_BITMASK_INTERNAL bool
+DE_BVEC_full_avx512(const mblk_t *_src, usize _n) {
+  usize i = 0;
+  for (; i + 32 <= _n; i += 32) {
+    const __m512i *d = (const __m512i *)(_src + i);
+    const __m512i v = _mm512_ternarylogic_epi64(
+        _mm512_loadu_si512(d), _mm512_loadu_si512(d + 1),
+        _mm512_and_si512(_mm512_loadu_si512(d + 2), _mm512_loadu_si512(d + 3)),
+        0x80);
+    if (_mm512_cmpneq_epi64_mask(v, _mm512_set1_epi64(-1)))
+      return false;
+  }
+  return DE_BVEC_full_scalar(_src + i, _n - i);
+}
+
+/* vpcompress of an index vector by 16 (u32) or 8 (u64) bits of the block,
+   full vector stores instead of compress-to-memory (microcoded on some cpus) */
+__attribute__((target("avx512f,popcnt"))) DE_CONTAINER_BITMASK_INTERNAL usize
+DE_BVEC_decode_u32_avx512(const mblk_t *_src, usize _n, usize _base,
+                          u32 *_out) {
+  const __m512i step = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+                                         12, 13, 14, 15);
+  u32 *o = _out;
+  for (usize i = 0; i < _n; ++i, _base += DE_BVEC_MBLK_BITS) {
+    mblk_t w = _src[i];
+    if (!w)
+      continue;
+    __m512i idx = _mm512_add_epi32(_mm512_set1_epi32((i32)(u32)_base), step);
+    for (; w; w >>= 16, idx = _mm512_add_epi32(idx, _mm512_set1_epi32(16))) {
+      const __mmask16 m = (__mmask16)(w & 0xffff);
+      _mm512_storeu_si512(o, _mm512_maskz_compress_epi32(m, idx));
+      o += __builtin_popcount(m);
+    }
+  }
+  return (usize)(o - _out);
+}
+
+__attribute__((target("avx512f,popcnt"))) DE_CONTAINER_BITMASK_INTERNAL usize
+DE_BVEC_decode_u64_avx512(const mblk_t *_src, usize _n, usize _base,
+                          u64 *_out) {
+  const __m512i step = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+  u64 *o = _out;
+  for (usize i = 0; i < _n; ++i, _base += DE_BVEC_MBLK_BITS) {
+    mblk_t w = _src[i];
+    if (!w)
+      continue;
+    __m512i idx = _mm512_add_epi64(_mm512_set1_epi64((long long)_base), step);
+    for (; w; w >>= 8, idx = _mm512_add_epi64(idx, _mm512_set1_epi64(8))) {
+      const __mmask8 m = (__mmask8)(w & 0xff);
+      _mm512_storeu_si512(o, _mm512_maskz_compress_epi64(m, idx));
+      o += __builtin_popcount(m);
+    }
+  }
+  return (usize)(o - _out);
+}
+
+DE_BVEC_DEFINE_SHIFT_KERNELS(DE_BVEC_shl_avx512, DE_BVEC_shr_avx512,
+                             DE_BVEC_AVX512_TARGET, __m512i, 8,
+                             _mm512_loadu_si512, _mm512_storeu_si512,
+                             _mm512_sll_epi64, _mm512_srl_epi64,
+                             _mm512_or_si512)
+
+static const DE_BVEC_kernels_t DE_BVEC_kernels_avx512 = {
+    DE_BVEC_and_avx512,        DE_BVEC_or_avx512,
+    DE_BVEC_xor_avx512,        DE_BVEC_not_avx512,
+    DE_BVEC_fill_avx512,       DE_BVEC_count_avx512,
+    DE_BVEC_any_avx512,        DE_BVEC_full_avx512,
+    DE_BVEC_decode_u32_avx512, DE_BVEC_decode_u64_avx512,
+    DE_BVEC_shl_avx512,        DE_BVEC_shr_avx512,
+    DE_BVEC_andnot_avx512};
+
+static const DE_BVEC_kernels_t DE_BVEC_kernels_avx512_vpopcntdq = {
+    DE_BVEC_and_avx512,        DE_BVEC_or_avx512,
+    DE_BVEC_xor_avx512,        DE_BVEC_not_avx512,
+    DE_BVEC_fill_avx512,       DE_BVEC_count_avx512_vpopcntdq,
+    DE_BVEC_any_avx512,        DE_BVEC_full_avx512,
+    DE_BVEC_decode_u32_avx512, DE_BVEC_decode_u64_avx512,
+    DE_BVEC_shl_avx512,        DE_BVEC_shr_avx512,
+    DE_BVEC_andnot_avx512};
+#endif
+#endif
+
+static const u0 *DE_BVEC_kernels_selected = NULL;
+
+DE_CONTAINER_BITMASK_INTERNAL const u0 *DE_BVEC_kernels_pick(u0) {
+#ifdef DE_BVEC_HAVE_DISPATCH
+  const DE_BVEC_cpu_level cpu = DE_BVEC_cpu_detect();
+#ifndef DE_CONTAINER_BITMASK_NO_AVX512
+  if (cpu >= DE_BVEC_CPU_AVX512)
+    return __builtin_cpu_supports("avx512vpopcntdq")
+               ? &DE_BVEC_kernels_avx512_vpopcntdq
+               : &DE_BVEC_kernels_avx512;
+#endif
+  if (cpu >= DE_BVEC_CPU_AVX2)
+    return &DE_BVEC_kernels_avx2;
+#endif
+  return &DE_BVEC_kernels_scalar;
+}
+
+DE_CONTAINER_BITMASK_INTERNAL const DE_BVEC_kernels_t *DE_BVEC_kernels(u0) {
+  return (const DE_BVEC_kernels_t *)DE_BVEC_dispatch(&DE_BVEC_kernels_selected,
+                                                     DE_BVEC_kernels_pick);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL u0 DE_BVEC_memset(mblk_t *const _data,
+                                                const mblk_t _value,
+                                                const usize _size) {
+  DE_BVEC_kernels()->fill_blocks(_data, _value, _size);
+}
+
+// #define _memmov memcpy
+
+/* ---- Capacity ----
+  block_count is the capacity of data.blocks, the used blocks are the first
+  GET_BLOCKS_AMOUNT(bits_amount). every bit past bits_amount is kept 0 up to
+  the capacity, so a size change within it only moves the metadata and the
+  bulk operations run over the used blocks only
+*/
+
+/* blocks that hold the logical bits */
+DE_CONTAINER_BITMASK_INTERNAL const mblk_t *
+DE_BVEC_used_blocks(const de_bvec *const _msk, usize *const _count) {
+  *_count = DE_BVEC_GET_BLOCKS_AMOUNT(_msk->bits_amount);
+  return _msk->is_small ? &_msk->data.small : _msk->data.blocks;
+}
+
+DE_CONTAINER_BITMASK_INTERNAL mblk_t *DE_BVEC_blocks(de_bvec *const _msk) {
+  return _msk->is_small ? &_msk->data.small : _msk->data.blocks;
+}
+
+/* valid bits of the last used block */
+DE_CONTAINER_BITMASK_INTERNAL mblk_t DE_BVEC_tail_mask(const usize _bits) {
+  const usize rem = DE_BVEC_BITS_MOD_MBLK(_bits);
+  return rem ? DE_BVEC_MBLK_FILLED >> (DE_BVEC_MBLK_BITS - rem)
+             : DE_BVEC_MBLK_FILLED;
+}
+
+/* clears the bits past bits_amount in the last used block, after operations
+   that may have written there */
+DE_CONTAINER_BITMASK_INTERNAL u0 DE_BVEC_clear_tail(de_bvec *const _msk) {
+  usize count;
+  DE_BVEC_used_blocks(_msk, &count);
+  if (_msk->is_small)
+    _msk->data.small &= DE_BVEC_tail_mask(_msk->bits_amount);
+  else if (count)
+    _msk->data.blocks[count - 1] &= DE_BVEC_tail_mask(_msk->bits_amount);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL u0 DE_BVEC_set_size(de_bvec *const _msk,
+                                                  const usize _amount_bits) {
+  _msk->bits_amount = _amount_bits;
+  _msk->last_block_bits_count = DE_BVEC_BITS_MOD_MBLK(_amount_bits);
+}
+
+/* clears [_idx, bits_amount), the blocks past the used ones are 0 already */
+DE_CONTAINER_BITMASK_INTERNAL u0 DE_BVEC_clear_from(de_bvec *const _msk,
+                                                    const usize _idx) {
+  if (_idx >= _msk->bits_amount)
+    return;
+  usize count;
+  DE_BVEC_used_blocks(_msk, &count);
+  mblk_t *const blocks = DE_BVEC_blocks(_msk);
+  const usize first = DE_BVEC_GET_BLOCKS_INDEX(_idx);
+  const usize rem = _idx % DE_BVEC_MBLK_BITS;
+  blocks[first] &= rem ? DE_BVEC_MBLK_FILLED >> (DE_BVEC_MBLK_BITS - rem) : 0;
+  for (usize i = first + 1; i < count; ++i)
+    blocks[i] = 0;
+}
+
+/* moves to a heap array of exactly _blocks blocks (>= the used ones). the
+   grown part is the only memory that gets zeroed, realloc keeps the rest */
+DE_CONTAINER_BITMASK_INTERNAL u0 DE_BVEC_set_capacity(de_bvec *const _msk,
+                                                      const usize _blocks) {
+  if (_msk->is_small) {
+    mblk_t *const data = (mblk_t *)malloc(_blocks * sizeof(mblk_t));
+    data[0] = _msk->data.small;
+    memset(data + 1, 0, (_blocks - 1) * sizeof(mblk_t));
+    _msk->data.blocks = data;
+    _msk->is_small = false;
+  } else {
+    mblk_t *const data =
+        (mblk_t *)realloc(_msk->data.blocks, _blocks * sizeof(mblk_t));
+    if (_blocks > _msk->block_count)
+      memset(data + _msk->block_count, 0,
+             (_blocks - _msk->block_count) * sizeof(mblk_t));
+    _msk->data.blocks = data;
+  }
+  _msk->block_count = _blocks;
+}
+
+/* makes room for _amount_bits, _geometric at least doubles the capacity so
+   growing one bit at a time is amortized O(1) */
+DE_CONTAINER_BITMASK_INTERNAL u0 DE_BVEC_ensure(de_bvec *const _msk,
+                                                const usize _amount_bits,
+                                                const bool _geometric) {
+  const usize need = DE_BVEC_GET_BLOCKS_AMOUNT(_amount_bits);
+  if (_msk->is_small ? _amount_bits <= DE_BVEC_MBLK_BITS
+                     : need <= _msk->block_count)
+    return;
+  usize blocks = need;
+  if (_geometric) {
+    const usize grown = _msk->is_small ? 2 : _msk->block_count * 2;
+    if (grown > blocks)
+      blocks = grown;
+  }
+  DE_BVEC_set_capacity(_msk, blocks);
+}
+
+/* ---- Lifecycle ---- */
+DE_CONTAINER_BITMASK_INTERNAL de_bvec de_bvec_create(const usize _amount_bits) {
+  if (_amount_bits <= DE_BVEC_MBLK_BITS) {
+    return (de_bvec){.data.small = 0,
+                     .is_small = true,
+                     .bits_amount = _amount_bits,
+                     .block_count = 0,
+                     .last_block_bits_count =
+                         DE_BVEC_BITS_MOD_MBLK(_amount_bits)};
+  } else {
+    const usize blocks = DE_BVEC_GET_BLOCKS_AMOUNT(_amount_bits);
+    return (de_bvec){.data.blocks = (mblk_t *)DE_BVEC_calloc(blocks),
+                     .is_small = false,
+                     .bits_amount = _amount_bits,
+                     .block_count = blocks,
+                     .last_block_bits_count =
+                         DE_BVEC_BITS_MOD_MBLK(_amount_bits)};
+  }
+}
+DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_create_i(de_bvec *const _msk,
+                                                  const usize _amount_bits) {
+  *_msk = de_bvec_create(_amount_bits);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_free(de_bvec *const _msk) {
+  if (!_msk->is_small) {
+    free(_msk->data.blocks);
+  }
 }
 
 // DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_delete(de_bvec *const _msk) {
@@ -412,85 +1609,75 @@ DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_delete(de_bvec *const _msk) {
 
 DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_reserve(de_bvec *const _msk,
                                                  const usize _amount_bits) {
-  usize new_blocks = DE_BVEC_GET_BLOCKS_AMOUNT(_amount_bits);
-  if (new_blocks > _msk->block_count) {
-    mblk_t *new_data = DE_BVEC_calloc(new_blocks);
-    if (_msk->is_small) {
-      /* move small inline to heap */
-      new_data[0] = _msk->data.small;
-    } else {
-      DE_BVEC_memmov(new_data, _msk->data.blocks, _msk->block_count);
-      DE_BVEC_dealloc(_msk->data.blocks);
-    }
-    _msk->data.blocks = new_data;
-    _msk->block_count = new_blocks;
-    _msk->last_block_bits_count = DE_BVEC_BITS_MOD_MBLK(_amount_bits);
-    _msk->is_small = false;
-    _msk->bits_amount = _amount_bits;
-  } else if (_amount_bits <= DE_BVEC_MBLK_BITS && !_msk->is_small) {
-    /* shrink to small inline if possible */
-    mblk_t temp = _msk->data.blocks[0];
-    de_bvec_free(_msk);
-    de_bvec_create_i(_msk, _amount_bits);
-    _msk->data.small = temp;
-  } else {
-    /* update metadata only */
-    _msk->bits_amount = _amount_bits;
-    _msk->last_block_bits_count = DE_BVEC_BITS_MOD_MBLK(_amount_bits);
-  }
+  if (_amount_bits < _msk->bits_amount)
+    DE_BVEC_clear_from(_msk, _amount_bits);
+  else
+    DE_BVEC_ensure(_msk, _amount_bits, false);
+  DE_BVEC_set_size(_msk, _amount_bits);
 }
 
 DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_resize(de_bvec *const _msk,
                                                 const usize _amount_bits) {
-  if (_amount_bits > DE_BVEC_MBLK_BITS) {
-    if (_msk->is_small) {
-      mblk_t temp = _msk->data.small;
-      de_bvec_free(_msk);
-      // de_bvec_create_i(_msk, _amount_bits);
-      _msk->block_count = DE_BVEC_GET_BLOCKS_AMOUNT(_amount_bits);
-      _msk->data.blocks = DE_BVEC_calloc(_msk->block_count);
-      _msk->data.blocks[0] = temp;
-      _msk->is_small = false;
-      _msk->bits_amount = _amount_bits;
-      _msk->last_block_bits_count = DE_BVEC_BITS_MOD_MBLK(_amount_bits);
-    } else {
-      usize blocks = DE_BVEC_GET_BLOCKS_AMOUNT(_amount_bits);
-      mblk_t *new_data = DE_BVEC_calloc(blocks);
-      DE_BVEC_memmov(new_data, _msk->data.blocks,
-                     blocks < _msk->block_count ? blocks : _msk->block_count);
-      de_bvec_free(_msk);
-      _msk->block_count = blocks;
-      _msk->last_block_bits_count = DE_BVEC_BITS_MOD_MBLK(_amount_bits);
-      _msk->bits_amount = _amount_bits;
-      _msk->is_small = false;
-      _msk->data.blocks = new_data;
-    }
-  } else {
-    mblk_t temp;
-    if (_msk->is_small) {
-      temp = _msk->data.small;
-    } else {
-      temp = _msk->data.blocks[0];
-    }
+  if (_amount_bits < _msk->bits_amount)
+    DE_BVEC_clear_from(_msk, _amount_bits);
+  else
+    DE_BVEC_ensure(_msk, _amount_bits, true);
+  DE_BVEC_set_size(_msk, _amount_bits);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_shrink_to_fit(de_bvec *const _msk) {
+  if (_msk->is_small)
+    return;
+  const usize used = DE_BVEC_GET_BLOCKS_AMOUNT(_msk->bits_amount);
+  if (_msk->bits_amount <= DE_BVEC_MBLK_BITS) {
+    const mblk_t temp = used ? _msk->data.blocks[0] : 0;
     de_bvec_free(_msk);
-    de_bvec_create_i(_msk, _amount_bits);
     _msk->data.small = temp;
+    _msk->block_count = 0;
+    _msk->is_small = true;
+  } else if (used < _msk->block_count) {
+    DE_BVEC_set_capacity(_msk, used);
   }
 }
 
+DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_push_back(de_bvec *const _msk,
+                                                   const bool _value) {
+  const usize idx = _msk->bits_amount;
+  DE_BVEC_ensure(_msk, idx + 1, true);
+  DE_BVEC_set_size(_msk, idx + 1);
+  DE_BVEC_blocks(_msk)[DE_BVEC_GET_BLOCKS_INDEX(idx)] |=
+      (mblk_t)_value << (idx % DE_BVEC_MBLK_BITS);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_append_bits(de_bvec *const _msk,
+                                                     const mblk_t _bits,
+                                                     const usize _amount) {
+#ifndef DE_CONTAINER_NO_SAFETY_CHECKS
+  assert(_amount <= DE_BVEC_MBLK_BITS);
+#endif
+  if (!_amount)
+    return;
+  const usize idx = _msk->bits_amount;
+  DE_BVEC_ensure(_msk, idx + _amount, true);
+  DE_BVEC_set_size(_msk, idx + _amount);
+  const mblk_t bits = _bits & DE_BVEC_tail_mask(_amount);
+  const usize off = idx % DE_BVEC_MBLK_BITS;
+  mblk_t *const block = DE_BVEC_blocks(_msk) + DE_BVEC_GET_BLOCKS_INDEX(idx);
+  block[0] |= bits << off;
+  if (off + _amount > DE_BVEC_MBLK_BITS)
+    block[1] |= bits >> (DE_BVEC_MBLK_BITS - off);
+}
+
+/* the copy gets exactly the used blocks */
 DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_copy(de_bvec *const _dst,
                                               const de_bvec *const _src) {
+  if (_dst == _src)
+    return;
+  usize count;
+  const mblk_t *const blocks = DE_BVEC_used_blocks(_src, &count);
   de_bvec_free(_dst);
-  _dst->bits_amount = _src->bits_amount;
-  _dst->block_count = _src->block_count;
-  _dst->is_small = _src->is_small;
-  _dst->last_block_bits_count = _src->last_block_bits_count;
-  if (_src->is_small) {
-    _dst->data.small = _src->data.small;
-  } else {
-    _dst->data.blocks = DE_BVEC_calloc(_src->block_count);
-    DE_BVEC_memcpy(_dst->data.blocks, _src->data.blocks, _src->block_count);
-  }
+  de_bvec_create_i(_dst, _src->bits_amount);
+  DE_BVEC_memcpy(DE_BVEC_blocks(_dst), blocks, count);
 }
 
 DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_move(de_bvec *const _dst,
@@ -546,61 +1733,59 @@ DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_set(de_bvec *const _msk,
   }
 }
 
+/* bits [_lo, _hi] of one block, _lo <= _hi < 64 */
+DE_CONTAINER_BITMASK_INTERNAL mblk_t DE_BVEC_range_mask(const usize _lo,
+                                                        const usize _hi) {
+  return (DE_BVEC_MBLK_FILLED >> (DE_BVEC_MBLK_BITS - 1 - _hi)) &
+         (DE_BVEC_MBLK_FILLED << _lo);
+}
+
 DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_set_range(de_bvec *const _msk,
                                                    const usize _start_idx,
                                                    const usize _end_idx,
                                                    const bool _value) {
-#ifndef DE_CONTAINER_NO_SAFETY_CHECKS1
+#ifndef DE_CONTAINER_NO_SAFETY_CHECKS
   assert(_start_idx < _msk->bits_amount);
   assert(_end_idx < _msk->bits_amount);
   assert(_start_idx <= _end_idx);
 #endif
   if (_msk->is_small) {
+    const mblk_t range = DE_BVEC_range_mask(_start_idx, _end_idx);
     if (_value) {
-      _msk->data.small |=
-          ((DE_BVEC_ONE << (_end_idx - _start_idx + 1)) - DE_BVEC_ONE)
-          << _start_idx;
+      _msk->data.small |= range;
     } else {
-      _msk->data.small &=
-          ~(((DE_BVEC_ONE << (_end_idx - _start_idx + 1)) - DE_BVEC_ONE)
-            << _start_idx);
+      _msk->data.small &= ~range;
     }
   } else {
     // from this index till end of block
-    const usize first_block_start_idx = DE_BVEC_BITS_MOD_MBLK(_start_idx);
-    // from start of block till this index
+    const usize first_block_start_idx = _start_idx % DE_BVEC_MBLK_BITS;
+    // from start of block till this index (inclusive)
     const usize last_block_end_idx = _end_idx % DE_BVEC_MBLK_BITS;
     const usize block_start = DE_BVEC_GET_BLOCKS_INDEX(_start_idx);
     const usize block_amount = DE_BVEC_GET_BLOCKS_INDEX(_end_idx) - block_start;
+    mblk_t *const blocks = _msk->data.blocks;
 
-    if (_value) {
-      if (block_amount) {
-        _msk->data.blocks[block_start] |= DE_BVEC_MBLK_FILLED
-                                          << first_block_start_idx;
-        DE_BVEC_memset(_msk->data.blocks + block_start + 1, DE_BVEC_MBLK_FILLED,
+    if (block_amount) {
+      const mblk_t head =
+          DE_BVEC_range_mask(first_block_start_idx, DE_BVEC_MBLK_BITS - 1);
+      const mblk_t tail = DE_BVEC_range_mask(0, last_block_end_idx);
+      if (_value) {
+        blocks[block_start] |= head;
+        DE_BVEC_memset(blocks + block_start + 1, DE_BVEC_MBLK_FILLED,
                        block_amount - 1);
-        _msk->data.blocks[block_start + block_amount] |=
-            DE_BVEC_MBLK_FILLED >> (DE_BVEC_MBLK_BITS - last_block_end_idx);
-
+        blocks[block_start + block_amount] |= tail;
       } else {
-        _msk->data.blocks[block_start] |=
-            ((DE_BVEC_ONE << (_end_idx - _start_idx + DE_BVEC_ONE)) -
-             DE_BVEC_ONE)
-            << _start_idx;
+        blocks[block_start] &= ~head;
+        DE_BVEC_memset(blocks + block_start + 1, 0, block_amount - 1);
+        blocks[block_start + block_amount] &= ~tail;
       }
     } else {
-      if (block_amount) {
-        _msk->data.blocks[block_start] &=
-            ~(DE_BVEC_MBLK_FILLED << first_block_start_idx);
-        DE_BVEC_memset(_msk->data.blocks + block_start + 1, 0,
-                       block_amount - 1);
-        _msk->data.blocks[block_start + block_amount] &=
-            ~(DE_BVEC_MBLK_FILLED >> (DE_BVEC_MBLK_BITS - last_block_end_idx));
+      const mblk_t range =
+          DE_BVEC_range_mask(first_block_start_idx, last_block_end_idx);
+      if (_value) {
+        blocks[block_start] |= range;
       } else {
-        _msk->data.blocks[block_start] &=
-            ~(((DE_BVEC_ONE << (_end_idx - _start_idx + DE_BVEC_ONE)) -
-               DE_BVEC_ONE)
-              << _start_idx);
+        blocks[block_start] &= ~range;
       }
     }
   }
@@ -629,32 +1814,29 @@ DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_flip_range(de_bvec *const _msk,
   assert(_start_idx <= _end_idx);
 #endif
   if (_msk->is_small) {
-    _msk->data.small ^=
-        ((DE_BVEC_ONE << (_end_idx - _start_idx + 1)) - DE_BVEC_ONE)
-        << _start_idx;
+    _msk->data.small ^= DE_BVEC_range_mask(_start_idx, _end_idx);
   } else {
     // from this index till end of block
-    const usize first_block_start_idx = DE_BVEC_BITS_MOD_MBLK(_start_idx);
-    // from start of block till this index
+    const usize first_block_start_idx = _start_idx % DE_BVEC_MBLK_BITS;
+    // from start of block till this index (inclusive)
     const usize last_block_end_idx = _end_idx % DE_BVEC_MBLK_BITS;
     const usize block_start = DE_BVEC_GET_BLOCKS_INDEX(_start_idx);
     const usize block_amount = DE_BVEC_GET_BLOCKS_INDEX(_end_idx) - block_start;
 
     if (block_amount) {
-      _msk->data.blocks[block_start] ^= DE_BVEC_MBLK_FILLED
-                                        << first_block_start_idx;
+      _msk->data.blocks[block_start] ^=
+          DE_BVEC_range_mask(first_block_start_idx, DE_BVEC_MBLK_BITS - 1);
 
-      for (usize i = block_start + 1; i < (block_amount + block_start); ++i) {
-        _msk->data.blocks[i] ^= DE_BVEC_MBLK_FILLED;
-      }
+      if (block_amount > 1)
+        DE_BVEC_kernels()->not_blocks(_msk->data.blocks + block_start + 1,
+                                      block_amount - 1);
 
       _msk->data.blocks[block_start + block_amount] ^=
-          DE_BVEC_MBLK_FILLED >> (DE_BVEC_MBLK_BITS - last_block_end_idx);
+          DE_BVEC_range_mask(0, last_block_end_idx);
 
     } else {
       _msk->data.blocks[block_start] ^=
-          ((DE_BVEC_ONE << (_end_idx - _start_idx + DE_BVEC_ONE)) - DE_BVEC_ONE)
-          << _start_idx;
+          DE_BVEC_range_mask(first_block_start_idx, last_block_end_idx);
     }
   }
 }
@@ -664,7 +1846,8 @@ DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_clear(de_bvec *const _msk) {
   if (_msk->is_small) {
     _msk->data.small = 0;
   } else {
-    DE_BVEC_memset(_msk->data.blocks, 0, _msk->block_count);
+    DE_BVEC_memset(_msk->data.blocks, 0,
+                   DE_BVEC_GET_BLOCKS_AMOUNT(_msk->bits_amount));
   }
 }
 
@@ -682,9 +1865,9 @@ DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_fill(de_bvec *const _msk) {
     _msk->data.small =
         DE_BVEC_MBLK_FILLED >> (DE_BVEC_MBLK_BITS - _msk->bits_amount);
   } else {
-    DE_BVEC_memset(_msk->data.blocks, DE_BVEC_MBLK_FILLED,
-                   _msk->block_count - 1);
-    _msk->data.blocks[_msk->block_count - 1] =
+    const usize last = DE_BVEC_GET_BLOCKS_AMOUNT(_msk->bits_amount) - 1;
+    DE_BVEC_memset(_msk->data.blocks, DE_BVEC_MBLK_FILLED, last);
+    _msk->data.blocks[last] =
         DE_BVEC_MBLK_FILLED >>
         (DE_BVEC_MBLK_BITS - _msk->last_block_bits_count);
   }
@@ -695,91 +1878,695 @@ DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_fill_range(de_bvec *const _msk,
   de_bvec_set_range(_msk, _start_idx, _end_idx, true);
 }
 
+/* the binary operations run over the used blocks both masks share, the bits
+   of _src past the size of _dst are dropped */
 DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_and_msk(de_bvec *const _dst,
                                                  const de_bvec *const _src) {
-  if (_dst->is_small) {
-    if (_src->is_small) {
-      _dst->data.small &= _src->data.small;
-    } else {
-      _dst->data.small &= _src->data.blocks[0];
-    }
-  } else {
-
-    if (_src->is_small) {
-      _dst->data.blocks[0] &= _src->data.small;
-      DE_BVEC_memset(_dst->data.blocks + 1, 0, _dst->block_count - 1);
-    } else {
-      usize bl_amount =
-          (_dst->block_count < _src->block_count ? _dst->block_count
-                                                 : _src->block_count);
-      for (usize i = 0; i < bl_amount; ++i) {
-        _dst->data.blocks[i] &= _src->data.blocks[i];
-      }
-      for (usize i = bl_amount; i < _dst->block_count; ++i)
-        _dst->data.blocks[i] &= (mblk_t)0;
-    }
-  }
+  usize dst_count, src_count;
+  DE_BVEC_used_blocks(_dst, &dst_count);
+  const mblk_t *const src = DE_BVEC_used_blocks(_src, &src_count);
+  const usize bl_amount = dst_count < src_count ? dst_count : src_count;
+  const DE_BVEC_kernels_t *k = DE_BVEC_kernels();
+  k->and_blocks(DE_BVEC_blocks(_dst), src, bl_amount);
+  k->fill_blocks(DE_BVEC_blocks(_dst) + bl_amount, 0, dst_count - bl_amount);
 }
 
 DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_or_msk(de_bvec *const _dst,
                                                 const de_bvec *const _src) {
+  usize dst_count, src_count;
+  DE_BVEC_used_blocks(_dst, &dst_count);
+  const mblk_t *const src = DE_BVEC_used_blocks(_src, &src_count);
+  DE_BVEC_kernels()->or_blocks(DE_BVEC_blocks(_dst), src,
+                               dst_count < src_count ? dst_count : src_count);
+  DE_BVEC_clear_tail(_dst);
+}
 
-  if (_dst->is_small) {
-    if (_src->is_small) {
-      _dst->data.small |= _src->data.small;
-    } else {
-      _dst->data.small |= _src->data.blocks[0];
-    }
+DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_xor_msk(de_bvec *const _dst,
+                                                 const de_bvec *const _src) {
+  usize dst_count, src_count;
+  DE_BVEC_used_blocks(_dst, &dst_count);
+  const mblk_t *const src = DE_BVEC_used_blocks(_src, &src_count);
+  DE_BVEC_kernels()->xor_blocks(DE_BVEC_blocks(_dst), src,
+                                dst_count < src_count ? dst_count : src_count);
+  DE_BVEC_clear_tail(_dst);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_not(de_bvec *const _dst) {
+  usize count;
+  DE_BVEC_used_blocks(_dst, &count);
+  DE_BVEC_kernels()->not_blocks(DE_BVEC_blocks(_dst), count);
+  DE_BVEC_clear_tail(_dst);
+}
+
+/* ---- Shifts / rotates ---- */
+
+/* both work in place (_dst == _src) on _n = blocks of _bits, the stale bits
+   of the last source block never make it into _dst */
+DE_CONTAINER_BITMASK_INTERNAL u0 DE_BVEC_shl_into(mblk_t *const _dst,
+                                                  const mblk_t *const _src,
+                                                  const usize _n,
+                                                  const usize _bits,
+                                                  const usize _amount) {
+  if (!_n)
+    return;
+  if (_amount >= _bits) {
+    DE_BVEC_memset(_dst, 0, _n);
+    return;
+  }
+  const usize w = DE_BVEC_GET_BLOCKS_INDEX(_amount);
+  const u32 r = (u32)(_amount % DE_BVEC_MBLK_BITS);
+  if (r)
+    DE_BVEC_kernels()->shl_blocks(_dst + w, _src, _n - w, r);
+  else
+    DE_BVEC_memmov(_dst + w, _src, _n - w);
+  for (usize i = 0; i < w; ++i)
+    _dst[i] = 0;
+  _dst[_n - 1] &= DE_BVEC_tail_mask(_bits);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL u0 DE_BVEC_shr_into(mblk_t *const _dst,
+                                                  const mblk_t *const _src,
+                                                  const usize _n,
+                                                  const usize _bits,
+                                                  const usize _amount) {
+  if (!_n)
+    return;
+  if (_amount >= _bits) {
+    DE_BVEC_memset(_dst, 0, _n);
+    return;
+  }
+  const usize w = DE_BVEC_GET_BLOCKS_INDEX(_amount);
+  const u32 r = (u32)(_amount % DE_BVEC_MBLK_BITS);
+  const mblk_t top = _src[_n - 1] & DE_BVEC_tail_mask(_bits);
+  if (r) {
+    DE_BVEC_kernels()->shr_blocks(_dst, _src + w, _n - w, r, top);
   } else {
+    DE_BVEC_memmov(_dst, _src + w, _n - w - 1);
+    _dst[_n - w - 1] = top;
+  }
+  for (usize i = _n - w; i < _n; ++i)
+    _dst[i] = 0;
+}
 
-    if (_src->is_small) {
-      _dst->data.blocks[0] |= _src->data.small;
-    } else {
-      usize bl_amount =
-          (_dst->block_count < _src->block_count ? _dst->block_count
-                                                 : _src->block_count);
-      for (usize i = 0; i < bl_amount; ++i) {
-        _dst->data.blocks[i] |= _src->data.blocks[i];
+/* shl by _amount or'ed with shr by the rest, the shr half goes through a
+   scratch copy so _dst may alias _src */
+DE_CONTAINER_BITMASK_INTERNAL u0 DE_BVEC_rotl_into(mblk_t *const _dst,
+                                                   const mblk_t *const _src,
+                                                   const usize _n,
+                                                   const usize _bits,
+                                                   const usize _amount) {
+  if (!_n)
+    return;
+  const usize amount = _amount % _bits;
+  if (!amount) {
+    if (_dst != _src)
+      DE_BVEC_memcpy(_dst, _src, _n);
+    _dst[_n - 1] &= DE_BVEC_tail_mask(_bits);
+    return;
+  }
+  mblk_t small;
+  mblk_t *const tmp = _n == 1 ? &small : DE_BVEC_calloc(_n);
+  DE_BVEC_shr_into(tmp, _src, _n, _bits, _bits - amount);
+  DE_BVEC_shl_into(_dst, _src, _n, _bits, amount);
+  DE_BVEC_kernels()->or_blocks(_dst, tmp, _n);
+  if (tmp != &small)
+    DE_BVEC_dealloc(tmp);
+}
+
+/* sizes _dst like _src, keeps the blocks when the size already matches */
+DE_CONTAINER_BITMASK_INTERNAL u0 DE_BVEC_shape_like(de_bvec *const _dst,
+                                                    const de_bvec *const _src) {
+  if (_dst->bits_amount != _src->bits_amount) {
+    de_bvec_free(_dst);
+    de_bvec_create_i(_dst, _src->bits_amount);
+  }
+}
+
+DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_shl(de_bvec *const _msk,
+                                             const usize _amount) {
+  mblk_t *const blocks = DE_BVEC_blocks(_msk);
+  DE_BVEC_shl_into(blocks, blocks,
+                   DE_BVEC_GET_BLOCKS_AMOUNT(_msk->bits_amount),
+                   _msk->bits_amount, _amount);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_shr(de_bvec *const _msk,
+                                             const usize _amount) {
+  mblk_t *const blocks = DE_BVEC_blocks(_msk);
+  DE_BVEC_shr_into(blocks, blocks,
+                   DE_BVEC_GET_BLOCKS_AMOUNT(_msk->bits_amount),
+                   _msk->bits_amount, _amount);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_rotl(de_bvec *const _msk,
+                                              const usize _amount) {
+  mblk_t *const blocks = DE_BVEC_blocks(_msk);
+  DE_BVEC_rotl_into(blocks, blocks,
+                    DE_BVEC_GET_BLOCKS_AMOUNT(_msk->bits_amount),
+                    _msk->bits_amount, _amount);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_rotr(de_bvec *const _msk,
+                                              const usize _amount) {
+  if (_msk->bits_amount)
+    de_bvec_rotl(_msk, _msk->bits_amount - _amount % _msk->bits_amount);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_shl_to(de_bvec *const _dst,
+                                                const de_bvec *const _src,
+                                                const usize _amount) {
+  if (_dst == _src) {
+    de_bvec_shl(_dst, _amount);
+    return;
+  }
+  DE_BVEC_shape_like(_dst, _src);
+  usize count;
+  const mblk_t *const src = DE_BVEC_used_blocks(_src, &count);
+  DE_BVEC_shl_into(DE_BVEC_blocks(_dst), src, count, _src->bits_amount,
+                   _amount);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_shr_to(de_bvec *const _dst,
+                                                const de_bvec *const _src,
+                                                const usize _amount) {
+  if (_dst == _src) {
+    de_bvec_shr(_dst, _amount);
+    return;
+  }
+  DE_BVEC_shape_like(_dst, _src);
+  usize count;
+  const mblk_t *const src = DE_BVEC_used_blocks(_src, &count);
+  DE_BVEC_shr_into(DE_BVEC_blocks(_dst), src, count, _src->bits_amount,
+                   _amount);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_rotl_to(de_bvec *const _dst,
+                                                 const de_bvec *const _src,
+                                                 const usize _amount) {
+  if (_dst == _src) {
+    de_bvec_rotl(_dst, _amount);
+    return;
+  }
+  DE_BVEC_shape_like(_dst, _src);
+  usize count;
+  const mblk_t *const src = DE_BVEC_used_blocks(_src, &count);
+  DE_BVEC_rotl_into(DE_BVEC_blocks(_dst), src, count, _src->bits_amount,
+                    _amount);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_rotr_to(de_bvec *const _dst,
+                                                 const de_bvec *const _src,
+                                                 const usize _amount) {
+  if (_src->bits_amount)
+    de_bvec_rotl_to(_dst, _src,
+                    _src->bits_amount - _amount % _src->bits_amount);
+  else
+    DE_BVEC_shape_like(_dst, _src);
+}
+
+/* ---- Fused / multi-operand ---- */
+
+/* blocks per evaluation chunk, 1 KiB per stack slot so a whole program
+   stays in l1 */
+#define DE_BVEC_CHUNK_BLOCKS 128
+
+DE_CONTAINER_BITMASK_INTERNAL usize DE_BVEC_eval(de_bvec *const _dst,
+                                                 const de_bvec_expr *const _expr,
+                                                 const usize _steps,
+                                                 const bool _count) {
+#ifndef DE_CONTAINER_NO_SAFETY_CHECKS
+  assert(_steps && _expr[0].op == DE_BVEC_EXPR_PUSH && _expr[0].operand);
+  usize depth = 0;
+  for (usize s = 0; s < _steps; ++s) {
+    if (_expr[s].op == DE_BVEC_EXPR_PUSH) {
+      assert(_expr[s].operand);
+      ++depth;
+    } else if (_expr[s].op != DE_BVEC_EXPR_NOT && !_expr[s].operand) {
+      assert(depth >= 2);
+      --depth;
+    }
+    assert(depth && depth <= DE_CONTAINER_BITMASK_EXPR_MAX_DEPTH);
+    assert(!_expr[s].operand ||
+           _expr[s].operand->bits_amount == _expr[0].operand->bits_amount);
+  }
+  assert(depth == 1);
+#endif
+  const usize bits = _expr[0].operand->bits_amount;
+  const usize n = DE_BVEC_GET_BLOCKS_AMOUNT(bits);
+  if (_dst && _dst->bits_amount != bits) {
+    de_bvec_free(_dst);
+    de_bvec_create_i(_dst, bits);
+  }
+  mblk_t *const out = _dst ? DE_BVEC_blocks(_dst) : NULL;
+  const DE_BVEC_kernels_t *const k = DE_BVEC_kernels();
+  mblk_t stack[DE_CONTAINER_BITMASK_EXPR_MAX_DEPTH][DE_BVEC_CHUNK_BLOCKS];
+  usize ones = 0;
+  for (usize base = 0; base < n; base += DE_BVEC_CHUNK_BLOCKS) {
+    const usize len =
+        n - base < DE_BVEC_CHUNK_BLOCKS ? n - base : DE_BVEC_CHUNK_BLOCKS;
+    usize sp = 0;
+    for (usize s = 0; s < _steps; ++s) {
+      const de_bvec_expr_op op = _expr[s].op;
+      usize count;
+      const mblk_t *rhs =
+          _expr[s].operand ? DE_BVEC_used_blocks(_expr[s].operand, &count) + base
+                           : NULL;
+      if (op == DE_BVEC_EXPR_PUSH) {
+        DE_BVEC_memcpy(stack[sp++], rhs, len);
+        continue;
+      }
+      if (op == DE_BVEC_EXPR_NOT) {
+        k->not_blocks(stack[sp - 1], len);
+        continue;
+      }
+      if (!rhs)
+        rhs = stack[--sp];
+      mblk_t *const lhs = stack[sp - 1];
+      switch (op) {
+      case DE_BVEC_EXPR_AND:
+        k->and_blocks(lhs, rhs, len);
+        break;
+      case DE_BVEC_EXPR_OR:
+        k->or_blocks(lhs, rhs, len);
+        break;
+      case DE_BVEC_EXPR_XOR:
+        k->xor_blocks(lhs, rhs, len);
+        break;
+      default:
+        k->andnot_blocks(lhs, rhs, len);
+        break;
       }
     }
+    /* stale tail bits and inverted ones past bits_amount */
+    if (base + len == n)
+      stack[0][len - 1] &= DE_BVEC_tail_mask(bits);
+    if (_count)
+      ones += k->count_blocks(stack[0], len);
+    if (out)
+      DE_BVEC_memcpy(out + base, stack[0], len);
   }
+  return ones;
 }
 
-DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_xor_msk(de_bvec *const _dst,
-                                                 const de_bvec *const _src) {
-  if (_dst->is_small) {
-    if (_src->is_small) {
-      _dst->data.small ^= _src->data.small;
-    } else {
-      _dst->data.small ^= _src->data.blocks[0];
+DE_CONTAINER_BITMASK_INTERNAL usize de_bvec_eval(de_bvec *const _dst,
+                                                 const de_bvec_expr *const _expr,
+                                                 const usize _steps) {
+  return DE_BVEC_eval(_dst, _expr, _steps, true);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_and_into(de_bvec *const _dst,
+                                                  const de_bvec *const _a,
+                                                  const de_bvec *const _b) {
+  const de_bvec_expr expr[] = {{DE_BVEC_EXPR_PUSH, _a}, {DE_BVEC_EXPR_AND, _b}};
+  DE_BVEC_eval(_dst, expr, 2, false);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_or_into(de_bvec *const _dst,
+                                                 const de_bvec *const _a,
+                                                 const de_bvec *const _b) {
+  const de_bvec_expr expr[] = {{DE_BVEC_EXPR_PUSH, _a}, {DE_BVEC_EXPR_OR, _b}};
+  DE_BVEC_eval(_dst, expr, 2, false);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_xor_into(de_bvec *const _dst,
+                                                  const de_bvec *const _a,
+                                                  const de_bvec *const _b) {
+  const de_bvec_expr expr[] = {{DE_BVEC_EXPR_PUSH, _a}, {DE_BVEC_EXPR_XOR, _b}};
+  DE_BVEC_eval(_dst, expr, 2, false);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_andnot_into(de_bvec *const _dst,
+                                                     const de_bvec *const _a,
+                                                     const de_bvec *const _b) {
+  const de_bvec_expr expr[] = {{DE_BVEC_EXPR_PUSH, _a},
+                               {DE_BVEC_EXPR_ANDNOT, _b}};
+  DE_BVEC_eval(_dst, expr, 2, false);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL usize de_bvec_and_count(const de_bvec *const _a,
+                                                      const de_bvec *const _b) {
+  const de_bvec_expr expr[] = {{DE_BVEC_EXPR_PUSH, _a}, {DE_BVEC_EXPR_AND, _b}};
+  return DE_BVEC_eval(NULL, expr, 2, true);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL usize
+de_bvec_andnot_count(const de_bvec *const _a, const de_bvec *const _b) {
+  const de_bvec_expr expr[] = {{DE_BVEC_EXPR_PUSH, _a},
+                               {DE_BVEC_EXPR_ANDNOT, _b}};
+  return DE_BVEC_eval(NULL, expr, 2, true);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL bool de_bvec_intersects(const de_bvec *const _a,
+                                                      const de_bvec *const _b) {
+#ifndef DE_CONTAINER_NO_SAFETY_CHECKS
+  assert(_a->bits_amount == _b->bits_amount);
+#endif
+  usize n;
+  const mblk_t *const a = DE_BVEC_used_blocks(_a, &n);
+  const mblk_t *const b = DE_BVEC_used_blocks(_b, &n);
+  const DE_BVEC_kernels_t *const k = DE_BVEC_kernels();
+  mblk_t chunk[DE_BVEC_CHUNK_BLOCKS];
+  for (usize base = 0; base < n; base += DE_BVEC_CHUNK_BLOCKS) {
+    const usize len =
+        n - base < DE_BVEC_CHUNK_BLOCKS ? n - base : DE_BVEC_CHUNK_BLOCKS;
+    DE_BVEC_memcpy(chunk, a + base, len);
+    k->and_blocks(chunk, b + base, len);
+    if (base + len == n)
+      chunk[len - 1] &= DE_BVEC_tail_mask(_a->bits_amount);
+    if (k->any_blocks(chunk, len))
+      return true;
+  }
+  return false;
+}
+
+/* ---- Atomic access ---- */
+DE_CONTAINER_BITMASK_INTERNAL mblk_t *DE_BVEC_block_of(de_bvec *const _msk,
+                                                       const usize _idx) {
+#ifndef DE_CONTAINER_NO_SAFETY_CHECKS
+  assert(_idx < _msk->bits_amount);
+#endif
+  return _msk->is_small ? &_msk->data.small
+                        : _msk->data.blocks + DE_BVEC_GET_BLOCKS_INDEX(_idx);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_atomic_set(de_bvec *const _msk,
+                                                    const usize _idx,
+                                                    const i32 _order) {
+  __atomic_fetch_or(DE_BVEC_block_of(_msk, _idx),
+                    DE_BVEC_ONE << (_idx % DE_BVEC_MBLK_BITS), _order);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL bool
+de_bvec_atomic_test_and_set(de_bvec *const _msk, const usize _idx,
+                            const i32 _order) {
+  const mblk_t bit = DE_BVEC_ONE << (_idx % DE_BVEC_MBLK_BITS);
+  return (__atomic_fetch_or(DE_BVEC_block_of(_msk, _idx), bit, _order) & bit) !=
+         0;
+}
+
+DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_atomic_clear(de_bvec *const _msk,
+                                                      const usize _idx,
+                                                      const i32 _order) {
+  __atomic_fetch_and(DE_BVEC_block_of(_msk, _idx),
+                     ~(DE_BVEC_ONE << (_idx % DE_BVEC_MBLK_BITS)), _order);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL bool de_bvec_atomic_get(const de_bvec *const _msk,
+                                                      const usize _idx,
+                                                      const i32 _order) {
+  const mblk_t block =
+      __atomic_load_n(DE_BVEC_block_of((de_bvec *)_msk, _idx), _order);
+  return DE_BVEC_ONE & (block >> (_idx % DE_BVEC_MBLK_BITS));
+}
+
+DE_CONTAINER_BITMASK_INTERNAL mblk_t
+de_bvec_atomic_fetch_or_block(de_bvec *const _msk, const usize _block_idx,
+                              const mblk_t _bits, const i32 _order) {
+  return __atomic_fetch_or(
+      DE_BVEC_block_of(_msk, _block_idx * DE_BVEC_MBLK_BITS), _bits, _order);
+}
+
+/* ---- Parallel bulk operations ----
+  split through the parallel blocks of de_vector.h in units of 8 blocks, so
+  the part borders are 64 byte aligned and no cache line is shared
+*/
+#define DE_BVEC_PARALLEL_LINE 8
+
+typedef struct {
+  mblk_t *blocks;
+  usize n;          /* blocks in total */
+  mblk_t value;     /* fill value */
+  usize *partials;  /* one count per part */
+} DE_BVEC_parallel_ctx;
+
+/* blocks of the lines [_begin, _end) */
+DE_CONTAINER_BITMASK_INTERNAL usize DE_BVEC_parallel_span(
+    const DE_BVEC_parallel_ctx *const _ctx, const usize _begin,
+    const usize _end, mblk_t **_blocks) {
+  const usize first = _begin * DE_BVEC_PARALLEL_LINE;
+  const usize last = _end * DE_BVEC_PARALLEL_LINE;
+  *_blocks = _ctx->blocks + first;
+  return (last < _ctx->n ? last : _ctx->n) - first;
+}
+
+/* amount of parts for _n blocks */
+DE_CONTAINER_BITMASK_INTERNAL usize
+DE_BVEC_parallel_parts(const usize _n, const usize _threads) {
+  const usize lines = (_n + DE_BVEC_PARALLEL_LINE - 1) / DE_BVEC_PARALLEL_LINE;
+  const usize min_lines =
+      DE_CONTAINER_BITMASK_PARALLEL_MIN_BLOCKS / DE_BVEC_PARALLEL_LINE;
+  return DE_C_VEC_block_count(lines, min_lines ? min_lines : 1, _threads);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL u0 DE_BVEC_fill_range(const usize _part,
+                                                    const usize _begin,
+                                                    const usize _end,
+                                                    u0 *_ctx) {
+  (u0) _part;
+  const DE_BVEC_parallel_ctx *ctx = (const DE_BVEC_parallel_ctx *)_ctx;
+  mblk_t *blocks;
+  const usize n = DE_BVEC_parallel_span(ctx, _begin, _end, &blocks);
+  DE_BVEC_kernels()->fill_blocks(blocks, ctx->value, n);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL u0 DE_BVEC_count_range(const usize _part,
+                                                     const usize _begin,
+                                                     const usize _end,
+                                                     u0 *_ctx) {
+  const DE_BVEC_parallel_ctx *ctx = (const DE_BVEC_parallel_ctx *)_ctx;
+  mblk_t *blocks;
+  const usize n = DE_BVEC_parallel_span(ctx, _begin, _end, &blocks);
+  ctx->partials[_part] = DE_BVEC_kernels()->count_blocks(blocks, n);
+}
+
+/* fills the first _n blocks with _value */
+DE_CONTAINER_BITMASK_INTERNAL u0 DE_BVEC_parallel_fill_blocks(
+    de_bvec *const _msk, const usize _n, const mblk_t _value,
+    const usize _threads) {
+  DE_BVEC_parallel_ctx ctx = {_msk->data.blocks, _n, _value, NULL};
+  const usize lines = (_n + DE_BVEC_PARALLEL_LINE - 1) / DE_BVEC_PARALLEL_LINE;
+  DE_C_VEC_parallel_blocks(lines, DE_BVEC_parallel_parts(_n, _threads),
+                           DE_BVEC_fill_range, &ctx);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_parallel_fill(de_bvec *const _msk,
+                                                       const usize _threads) {
+  if (_msk->is_small || _msk->bits_amount == 0) {
+    de_bvec_fill(_msk);
+    return;
+  }
+  const usize n = DE_BVEC_GET_BLOCKS_AMOUNT(_msk->bits_amount) - 1;
+  DE_BVEC_parallel_fill_blocks(_msk, n, DE_BVEC_MBLK_FILLED, _threads);
+  _msk->data.blocks[n] =
+      DE_BVEC_MBLK_FILLED >> (DE_BVEC_MBLK_BITS - _msk->last_block_bits_count);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_parallel_clear(de_bvec *const _msk,
+                                                        const usize _threads) {
+  if (_msk->is_small) {
+    de_bvec_clear(_msk);
+    return;
+  }
+  DE_BVEC_parallel_fill_blocks(
+      _msk, DE_BVEC_GET_BLOCKS_AMOUNT(_msk->bits_amount), 0, _threads);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL usize
+de_bvec_parallel_count(const de_bvec *const _msk, const usize _threads) {
+  if (_msk->is_small)
+    return de_bvec_count(_msk);
+  const usize n = DE_BVEC_GET_BLOCKS_AMOUNT(_msk->bits_amount);
+  const usize parts = DE_BVEC_parallel_parts(n, _threads);
+  usize *partials = (usize *)calloc(parts, sizeof(usize));
+  DE_BVEC_parallel_ctx ctx = {_msk->data.blocks, n, 0, partials};
+  const usize lines = (n + DE_BVEC_PARALLEL_LINE - 1) / DE_BVEC_PARALLEL_LINE;
+  DE_C_VEC_parallel_blocks(lines, parts, DE_BVEC_count_range, &ctx);
+  usize out = 0;
+  for (usize p = 0; p < parts; ++p)
+    out += partials[p];
+  free(partials);
+  return out;
+}
+
+/* ---- Search / iteration ---- */
+
+DE_CONTAINER_BITMASK_INTERNAL usize
+de_bvec_find_next_set(const de_bvec *const _msk, const usize _from_idx) {
+  const usize bits = _msk->bits_amount;
+  if (_from_idx >= bits)
+    return bits;
+  usize count;
+  const mblk_t *blocks = DE_BVEC_used_blocks(_msk, &count);
+  usize b = DE_BVEC_GET_BLOCKS_INDEX(_from_idx);
+  mblk_t w = blocks[b] & (DE_BVEC_MBLK_FILLED << (_from_idx % DE_BVEC_MBLK_BITS));
+  while (!w) {
+    if (++b == count)
+      return bits;
+    w = blocks[b];
+  }
+  const usize idx = b * DE_BVEC_MBLK_BITS + (usize)__builtin_ctzll(w);
+  return idx < bits ? idx : bits;
+}
+
+DE_CONTAINER_BITMASK_INTERNAL usize
+de_bvec_find_next_clear(const de_bvec *const _msk, const usize _from_idx) {
+  const usize bits = _msk->bits_amount;
+  if (_from_idx >= bits)
+    return bits;
+  usize count;
+  const mblk_t *blocks = DE_BVEC_used_blocks(_msk, &count);
+  usize b = DE_BVEC_GET_BLOCKS_INDEX(_from_idx);
+  mblk_t w =
+      ~blocks[b] & (DE_BVEC_MBLK_FILLED << (_from_idx % DE_BVEC_MBLK_BITS));
+  while (!w) {
+    if (++b == count)
+      return bits;
+    w = ~blocks[b];
+  }
+  /* the bits past bits_amount read as whatever is stored, clamp them */
+  const usize idx = b * DE_BVEC_MBLK_BITS + (usize)__builtin_ctzll(w);
+  return idx < bits ? idx : bits;
+}
+
+DE_CONTAINER_BITMASK_INTERNAL usize
+de_bvec_find_prev_set(const de_bvec *const _msk, usize _from_idx) {
+  const usize bits = _msk->bits_amount;
+  if (bits == 0)
+    return bits;
+  if (_from_idx >= bits)
+    _from_idx = bits - 1;
+  usize count;
+  const mblk_t *blocks = DE_BVEC_used_blocks(_msk, &count);
+  usize b = DE_BVEC_GET_BLOCKS_INDEX(_from_idx);
+  mblk_t w = blocks[b] & (DE_BVEC_MBLK_FILLED >>
+                          (DE_BVEC_MBLK_BITS - 1 - _from_idx % DE_BVEC_MBLK_BITS));
+  while (!w) {
+    if (b == 0)
+      return bits;
+    w = blocks[--b];
+  }
+  return b * DE_BVEC_MBLK_BITS + (DE_BVEC_MBLK_BITS - 1) -
+         (usize)__builtin_clzll(w);
+}
+
+DE_CONTAINER_BITMASK_INTERNAL usize
+de_bvec_find_first_clear(const de_bvec *const _msk) {
+  return de_bvec_find_next_clear(_msk, 0);
+}
+
+/* starts of all runs of _amount 1 bits that lie inside _z, 0 < _amount <= 64.
+   doubles the checked length per step: log2(_amount) shift-ands */
+DE_CONTAINER_BITMASK_INTERNAL mblk_t DE_BVEC_run_starts(mblk_t _z,
+                                                        const usize _amount) {
+  for (usize len = 1; len < _amount && _z;) {
+    const usize step = len < _amount - len ? len : _amount - len;
+    _z &= _z >> step;
+    len += step;
+  }
+  return _z;
+}
+
+DE_CONTAINER_BITMASK_INTERNAL usize de_bvec_find_clear_run(
+    const de_bvec *const _msk, const usize _amount, const usize _from_idx) {
+  const usize bits = _msk->bits_amount;
+  if (_amount == 0)
+    return _from_idx < bits ? _from_idx : bits;
+  if (_from_idx >= bits || _amount > bits - _from_idx)
+    return bits;
+  usize count;
+  const mblk_t *blocks = DE_BVEC_used_blocks(_msk, &count);
+  /* run: 0 bits directly below the current block */
+  usize run = 0;
+  for (usize b = DE_BVEC_GET_BLOCKS_INDEX(_from_idx); b < count; ++b) {
+    /* z: 1 for every free bit, bits before _from_idx and past the end are taken */
+    mblk_t z = ~blocks[b];
+    if (b == DE_BVEC_GET_BLOCKS_INDEX(_from_idx))
+      z &= DE_BVEC_MBLK_FILLED << (_from_idx % DE_BVEC_MBLK_BITS);
+    if (b + 1 == count && bits % DE_BVEC_MBLK_BITS)
+      z &= DE_BVEC_MBLK_FILLED >> (DE_BVEC_MBLK_BITS - bits % DE_BVEC_MBLK_BITS);
+    const usize base = b * DE_BVEC_MBLK_BITS;
+    if (z == 0) {
+      /* full block */
+      run = 0;
+      continue;
     }
-  } else {
-    if (_src->is_small) {
-      _dst->data.blocks[0] ^= _src->data.small;
-    } else {
-      usize bl_amount =
-          (_dst->block_count < _src->block_count ? _dst->block_count
-                                                 : _src->block_count);
-      for (usize i = 0; i < bl_amount; ++i) {
-        _dst->data.blocks[i] ^= _src->data.blocks[i];
-      }
+    if (z == DE_BVEC_MBLK_FILLED) {
+      if (run + DE_BVEC_MBLK_BITS >= _amount)
+        return base - run;
+      run += DE_BVEC_MBLK_BITS;
+      continue;
+    }
+    /* the run coming from below continues into the low free bits */
+    const usize low = (usize)__builtin_ctzll(~z);
+    if (run + low >= _amount)
+      return base - run;
+    if (_amount <= DE_BVEC_MBLK_BITS) {
+      const mblk_t starts = DE_BVEC_run_starts(z, _amount);
+      if (starts)
+        return base + (usize)__builtin_ctzll(starts);
     }
+    /* only the free bits at the top can carry on into the next block */
+    run = (usize)__builtin_clzll(~z);
   }
+  return bits;
 }
 
-DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_not(de_bvec *const _dst) {
-  if (_dst->is_small) {
-    _dst->data.small ^= DE_BVEC_MBLK_FILLED;
+DE_CONTAINER_BITMASK_INTERNAL usize de_bvec_claim_run(de_bvec *const _msk,
+                                                      const usize _amount,
+                                                      usize *const _cursor) {
+  const usize bits = _msk->bits_amount;
+  const usize from = _cursor && *_cursor < bits ? *_cursor : 0;
+  usize start = de_bvec_find_clear_run(_msk, _amount, from);
+  if (start == bits && from)
+    start = de_bvec_find_clear_run(_msk, _amount, 0);
+  if (start == bits || _amount == 0)
+    return start;
+  de_bvec_set_range(_msk, start, start + _amount - 1, true);
+  if (_cursor)
+    *_cursor = start + _amount < bits ? start + _amount : 0;
+  return start;
+}
+
+#if defined(DE_CONTAINER_VECTOR_IMPLEMENTATION) ||                             \
+    defined(DE_CONTAINER_VECTOR_IMPLEMENTATION_DEVELOPMENT)
+DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_to_indices(const de_bvec *const _msk,
+                                                    de_vec *const _out) {
+#ifndef DE_CONTAINER_NO_SAFETY_CHECKS
+  assert((_out->item_size == sizeof(u32) || _out->item_size == sizeof(u64)) &&
+         "indices have to be u32 or u64");
+  assert((_out->item_size == sizeof(u64) ||
+          _msk->bits_amount <= (usize)UINT32_MAX + 1) &&
+         "u32 indices can not address the mask");
+#endif
+  usize count;
+  const mblk_t *blocks = DE_BVEC_used_blocks(_msk, &count);
+  de_vec_clear(_out);
+  if (count == 0)
+    return;
+  const DE_BVEC_kernels_t *k = DE_BVEC_kernels();
+  /* exact size up front (stale tail bits only over-reserve), plus the slack
+     the decode kernels store past the end */
+  de_vec_make_unique(_out);
+  de_vec_reserve(_out, k->count_blocks(blocks, count) + 16);
+  const usize full = count - 1;
+  const mblk_t last =
+      blocks[full] &
+      (DE_BVEC_MBLK_FILLED >>
+       (DE_BVEC_MBLK_BITS - DE_BVEC_BITS_MOD_MBLK(_msk->bits_amount)));
+  const usize last_base = full * DE_BVEC_MBLK_BITS;
+  usize used;
+  if (_out->item_size == sizeof(u32)) {
+    u32 *const o = (u32 *)_out->data;
+    used = k->decode_u32(blocks, full, 0, o);
+    used += DE_BVEC_decode_u32_scalar(&last, 1, last_base, o + used);
   } else {
-    usize bl_amount = _dst->block_count - 1;
-    for (usize i = 0; i < bl_amount; ++i) {
-      _dst->data.blocks[i] ^= DE_BVEC_MBLK_FILLED;
-    }
-    _dst->data.blocks[bl_amount] ^=
-        DE_BVEC_MBLK_FILLED >>
-        (DE_BVEC_MBLK_BITS - _dst->last_block_bits_count);
+    u64 *const o = (u64 *)_out->data;
+    used = k->decode_u64(blocks, full, 0, o);
+    used += DE_BVEC_decode_u64_scalar(&last, 1, last_base, o + used);
   }
+  _out->used = used;
 }
+#endif
 
 /* ---- Info / Introspection ---- */
 DE_CONTAINER_BITMASK_INTERNAL usize
@@ -787,6 +2574,12 @@ de_bvec_info_size(const de_bvec *const _msk) {
   return _msk->bits_amount;
 }
 
+DE_CONTAINER_BITMASK_INTERNAL usize
+de_bvec_info_capacity(const de_bvec *const _msk) {
+  return _msk->is_small ? DE_BVEC_MBLK_BITS
+                        : _msk->block_count * DE_BVEC_MBLK_BITS;
+}
+
 DE_CONTAINER_BITMASK_INTERNAL bool
 de_bvec_info_valid(const de_bvec *const _msk) {
   return _msk && (_msk->is_small ? true : (_msk->data.blocks != NULL));
@@ -796,23 +2589,20 @@ DE_CONTAINER_BITMASK_INTERNAL bool de_bvec_any(const de_bvec *const _msk) {
   if (_msk->is_small) {
     return _msk->data.small != 0;
   } else {
-    for (usize i = 0; i < _msk->block_count; ++i) {
-      if (_msk->data.blocks[i])
-        return true;
-    }
-    return false;
+    return DE_BVEC_kernels()->any_blocks(
+        _msk->data.blocks, DE_BVEC_GET_BLOCKS_AMOUNT(_msk->bits_amount));
   }
 }
 
 DE_CONTAINER_BITMASK_INTERNAL bool de_bvec_all(const de_bvec *const _msk) {
   if (_msk->is_small) {
     return (~_msk->data.small << (DE_BVEC_MBLK_BITS - _msk->bits_amount)) == 0;
+  } else if (_msk->bits_amount == 0) {
+    return true;
   } else {
-    const usize bcount = _msk->block_count - 1;
-    for (usize i = 0; i < bcount; ++i) {
-      if (~_msk->data.blocks[i] != 0)
-        return false;
-    }
+    const usize bcount = DE_BVEC_GET_BLOCKS_AMOUNT(_msk->bits_amount) - 1;
+    if (!DE_BVEC_kernels()->full_blocks(_msk->data.blocks, bcount))
+      return false;
     // return _msk->data.blocks[bcount]
 
     return (~_msk->data.blocks[bcount]
@@ -824,12 +2614,8 @@ DE_CONTAINER_BITMASK_INTERNAL bool de_bvec_none(const de_bvec *const _msk) {
   if (_msk->is_small) {
     return _msk->data.small == 0;
   } else {
-    const usize bcount = _msk->block_count;
-    for (usize i = 0; i < bcount; ++i) {
-      if (_msk->data.blocks[i] != 0)
-        return false;
-    }
-    return true;
+    return !DE_BVEC_kernels()->any_blocks(
+        _msk->data.blocks, DE_BVEC_GET_BLOCKS_AMOUNT(_msk->bits_amount));
   }
 }
 
@@ -837,11 +2623,8 @@ DE_CONTAINER_BITMASK_INTERNAL usize de_bvec_count(const de_bvec *const _msk) {
   if (_msk->is_small) {
     return __builtin_popcountll(_msk->data.small);
   } else {
-    usize out = 0;
-    for (usize i = 0; i < _msk->block_count; ++i) {
-      out += __builtin_popcountll(_msk->data.blocks[i]);
-    }
-    return out;
+    return DE_BVEC_kernels()->count_blocks(
+        _msk->data.blocks, DE_BVEC_GET_BLOCKS_AMOUNT(_msk->bits_amount));
   }
 }
 #include <stdio.h>
@@ -866,7 +2649,7 @@ DE_CONTAINER_BITMASK_INTERNAL u0 de_bvec_prints(const de_bvec *const _msk,
   if (_msk->is_small) {
     de_bvec_print_chunk(_msk->data.small, byte_delimiter, chuck_delimiter);
   } else {
-    for (usize i = _msk->block_count; i-- > 0;) {
+    for (usize i = DE_BVEC_GET_BLOCKS_AMOUNT(_msk->bits_amount); i-- > 0;) {
       de_bvec_print_chunk(_msk->data.blocks[i], byte_delimiter,
                           chuck_delimiter);
     }
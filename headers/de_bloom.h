@@ -0,0 +1,616 @@
+#ifndef DE_CONTAINER_BLOOM_HEADER
+#define DE_CONTAINER_BLOOM_HEADER
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+to get function definitions #define DE_CONTAINER_BLOOM_IMPLEMENTATION before
+any #include. the bits live in a de_bvec and clear / union / fill go through
+its functions, so DE_CONTAINER_BITMASK_IMPLEMENTATION has to be defined in one
+translation unit as well
+
+blocked bloom filter: a key only touches one block, so a lookup costs a single
+cache miss instead of k scattered ones, at the price of a somewhat higher false
+positive rate for the same size (the sizing helper accounts for that):
+  DE_BLOOM_BLOCK_64   register blocked, all k probes in one u64
+  DE_BLOOM_BLOCK_512  cache line blocked, 16 lanes of 32 bits, probe i sets
+                      one bit of lane i, tested with one vector compare on
+                      avx2 / avx-512
+the storage is 64 byte aligned, so a 512 bit block is exactly one cache line.
+
+keys are passed as 64 bit hashes (de_hashmap_hash_bytes for byte keys). they
+are mixed again, plain integer ids work as well. the block comes from the high
+bits (multiply shift), the probe positions from the low 32 bits times odd salts.
+
+the batch functions hash and prefetch a chunk of keys before touching any of
+their blocks, so the misses of a chunk overlap. filters of the same shape
+(blocks, k, block) can be merged with de_bloom_union
+*/
+
+/* clang-format off */
+/* possible options to set before 'first' include and IMPLEMENTATION */
+#ifndef DE_CONTAINER_BLOOM_OPTIONS
+#ifdef DE_CONTAINER_BLOOM_OPTIONS
+/* if defined removes assert checks */
+#define DE_OPTIONS_BLOOM_NO_SAFETY_ASSERTS
+/* never select the avx-512 probe kernels */
+#define DE_OPTIONS_BLOOM_NO_AVX512
+/* keys hashed and prefetched ahead by the batch functions, defaults to 16 */
+#define DE_OPTIONS_BLOOM_BATCH_CHUNK 16
+#endif
+#endif
+
+#ifdef DE_CONTAINER_BLOOM_IMPLEMENTATION
+#define DE_CONTAINER_BLOOM_API
+#else
+#define DE_CONTAINER_BLOOM_API extern
+#endif
+#define DE_CONTAINER_BLOOM_INTERNAL
+
+/* declarations */
+#include <common.h>
+#include <stdbool.h>
+#include <de_bitmask.h>
+
+/* value = u64 words per block */
+typedef enum {
+  DE_BLOOM_BLOCK_64  = 1,
+  DE_BLOOM_BLOCK_512 = 8
+} de_bloom_block;
+
+typedef struct {
+  usize          blocks;
+  u32            k;            /* probes per key, 1..16 */
+  de_bloom_block block;
+  f64            fpr;          /* expected false positive rate at the sized count */
+} de_bloom_params;
+
+typedef struct {
+  de_bvec        bits;         /* blocks * block words */
+  usize          blocks;
+  usize          count;        /* inserted keys, duplicates included */
+  u32            k;
+  de_bloom_block block;
+} de_bloom;
+
+/* smallest filter (and its k) that stays below _fpr with _count keys, 0 < _fpr < 1 */
+DE_CONTAINER_BLOOM_API de_bloom_params
+de_bloom_params_for(
+  const usize          _count,
+  const f64            _fpr,
+  const de_bloom_block _block
+);
+
+/* expected false positive rate of a filter shaped like _params holding _count keys */
+DE_CONTAINER_BLOOM_API f64
+de_bloom_params_fpr(
+  const de_bloom_params* const _params,
+  const usize                  _count
+);
+
+/* returns an empty filter of the given shape */
+DE_CONTAINER_BLOOM_API de_bloom
+de_bloom_create(
+  const de_bloom_params* const _params
+);
+
+/* de_bloom_create(de_bloom_params_for(_count, _fpr, _block)) */
+DE_CONTAINER_BLOOM_API de_bloom
+de_bloom_create_for(
+  const usize          _count,
+  const f64            _fpr,
+  const de_bloom_block _block
+);
+
+DE_CONTAINER_BLOOM_API u0
+de_bloom_delete(
+  de_bloom* const _bloom
+);
+
+/* removes all keys */
+DE_CONTAINER_BLOOM_API u0
+de_bloom_clear(
+  de_bloom* const _bloom
+);
+
+DE_CONTAINER_BLOOM_API u0
+de_bloom_insert(
+  de_bloom* const _bloom,
+  const u64       _hash
+);
+
+/* false: never inserted, true: inserted or a false positive */
+DE_CONTAINER_BLOOM_API bool
+de_bloom_contains(
+  const de_bloom* const _bloom,
+  const u64             _hash
+);
+
+DE_CONTAINER_BLOOM_API u0
+de_bloom_insert_batch(
+  de_bloom* const  _bloom,
+  const u64* const _hashes,
+  const usize      _count
+);
+
+/* writes one result per key into _out (may be NULL), returns the number of hits */
+DE_CONTAINER_BLOOM_API usize
+de_bloom_contains_batch(
+  const de_bloom* const _bloom,
+  const u64* const      _hashes,
+  const usize           _count,
+  bool* const           _out
+);
+
+/* _dst |= _src, both need the same blocks, k and block */
+DE_CONTAINER_BLOOM_API u0
+de_bloom_union(
+  de_bloom* const       _dst,
+  const de_bloom* const _src
+);
+
+/* expected false positive rate at the current count */
+DE_CONTAINER_BLOOM_API f64
+de_bloom_info_fpr(
+  const de_bloom* const _bloom
+);
+
+/* share of set bits, one pass over the filter */
+DE_CONTAINER_BLOOM_API f64
+de_bloom_info_fill(
+  const de_bloom* const _bloom
+);
+
+/* bytes held by the filter */
+DE_CONTAINER_BLOOM_API usize
+de_bloom_info_memory(
+  const de_bloom* const _bloom
+);
+
+/* clang-format on */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif
+
+// #define DE_CONTAINER_BLOOM_IMPLEMENTATION_DEVELOPMENT
+#if defined(DE_CONTAINER_BLOOM_IMPLEMENTATION) ||                              \
+    defined(DE_CONTAINER_BLOOM_IMPLEMENTATION_DEVELOPMENT)
+#ifndef DE_CONTAINER_BLOOM_IMPLEMENTATION_INTERNAL
+#define DE_CONTAINER_BLOOM_IMPLEMENTATION_INTERNAL
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* implementations */
+#include <assert.h>
+#include <common.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* macro defines */
+#define DE_C_BLOOM_ASSERT assert
+#ifndef DE_OPTIONS_BLOOM_BATCH_CHUNK
+#define DE_OPTIONS_BLOOM_BATCH_CHUNK 16
+#endif
+
+#define DE_C_BLOOM_MAX_K 16
+#define DE_C_BLOOM_LINE 64 /* storage alignment in bytes */
+
+/* odd multipliers, one per probe (the first 8 are the parquet split block
+   salts) */
+static const u32 DE_C_BLOOM_salts[DE_C_BLOOM_MAX_K] = {
+    0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+    0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u,
+    0x9e3779b1u, 0x85ebca6bu, 0xc2b2ae35u, 0x27d4eb2fu,
+    0x165667b1u, 0xd3a2646du, 0xfd7046c5u, 0xb55a4f09u};
+
+/* murmur3 finalizer */
+DE_CONTAINER_BLOOM_INTERNAL u64 DE_C_BLOOM_mix(u64 _h) {
+  _h ^= _h >> 33;
+  _h *= 0xff51afd7ed558ccdull;
+  _h ^= _h >> 33;
+  _h *= 0xc4ceb9fe1a85ec53ull;
+  _h ^= _h >> 33;
+  return _h;
+}
+
+/* first word of the block of mixed hash _h */
+DE_CONTAINER_BLOOM_INTERNAL mblk_t *DE_C_BLOOM_block(const de_bloom *_bloom,
+                                                     u64 _h) {
+  const usize b =
+      (usize)(((unsigned __int128)_h * (unsigned __int128)_bloom->blocks) >>
+              64);
+  return _bloom->bits.data.blocks + b * (usize)_bloom->block;
+}
+
+/* the k probe bits of a 64 bit block */
+DE_CONTAINER_BLOOM_INTERNAL mblk_t DE_C_BLOOM_mask64(u32 _h, u32 _k) {
+  mblk_t out = 0;
+  for (u32 i = 0; i < _k; ++i)
+    out |= (mblk_t)1 << ((_h * DE_C_BLOOM_salts[i]) >> 26);
+  return out;
+}
+
+/* ---- 512 bit probe kernels ---- */
+
+typedef struct {
+  u0 (*insert)(mblk_t *_block, u32 _h, u32 _k);
+  bool (*contains)(const mblk_t *_block, u32 _h, u32 _k);
+} DE_C_BLOOM_kernels_t;
+
+/* lane i is bits [32 * (i & 1), +32) of word i / 2 */
+DE_CONTAINER_BLOOM_INTERNAL u0 DE_C_BLOOM_insert_scalar(mblk_t *_block, u32 _h,
+                                                        u32 _k) {
+  for (u32 i = 0; i < _k; ++i)
+    _block[i >> 1] |= (mblk_t)1 << (((i & 1) << 5) |
+                                    ((_h * DE_C_BLOOM_salts[i]) >> 27));
+}
+DE_CONTAINER_BLOOM_INTERNAL bool
+DE_C_BLOOM_contains_scalar(const mblk_t *_block, u32 _h, u32 _k) {
+  for (u32 i = 0; i < _k; ++i)
+    if (!((_block[i >> 1] >> (((i & 1) << 5) |
+                              ((_h * DE_C_BLOOM_salts[i]) >> 27))) &
+          1))
+      return false;
+  return true;
+}
+
+static const DE_C_BLOOM_kernels_t DE_C_BLOOM_kernels_scalar = {
+    DE_C_BLOOM_insert_scalar, DE_C_BLOOM_contains_scalar};
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DE_C_BLOOM_HAVE_DISPATCH
+
+/* -- avx2, two halves of 8 lanes -- */
+
+/* the probe bits of lanes [_first, _first + 8), lanes >= _k stay 0 */
+__attribute__((target("avx2"))) static inline __m256i
+DE_C_BLOOM_mask_avx2(u32 _h, u32 _k, u32 _first) {
+  const __m256i lane = _mm256_add_epi32(_mm256_set1_epi32((i32)_first),
+                                        _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+  const __m256i live = _mm256_cmpgt_epi32(_mm256_set1_epi32((i32)_k), lane);
+  const __m256i salts =
+      _mm256_loadu_si256((const __m256i *)(DE_C_BLOOM_salts + _first));
+  const __m256i pos = _mm256_srli_epi32(
+      _mm256_mullo_epi32(_mm256_set1_epi32((i32)_h), salts), 27);
+  return _mm256_and_si256(
+      live, _mm256_sllv_epi32(_mm256_set1_epi32(1), pos));
+}
+
+__attribute__((target("avx2"))) DE_CONTAINER_BLOOM_INTERNAL u0
+DE_C_BLOOM_insert_avx2(mblk_t *_block, u32 _h, u32 _k) {
+  __m256i *const v = (__m256i *)_block;
+  _mm256_storeu_si256(v, _mm256_or_si256(_mm256_loadu_si256(v),
+                                        DE_C_BLOOM_mask_avx2(_h, _k, 0)));
+  if (_k > 8)
+    _mm256_storeu_si256(v + 1,
+                       _mm256_or_si256(_mm256_loadu_si256(v + 1),
+                                       DE_C_BLOOM_mask_avx2(_h, _k, 8)));
+}
+/* testc: (~block & mask) == 0 */
+__attribute__((target("avx2"))) DE_CONTAINER_BLOOM_INTERNAL bool
+DE_C_BLOOM_contains_avx2(const mblk_t *_block, u32 _h, u32 _k) {
+  const __m256i *const v = (const __m256i *)_block;
+  if (!_mm256_testc_si256(_mm256_loadu_si256(v),
+                          DE_C_BLOOM_mask_avx2(_h, _k, 0)))
+    return false;
+  return _k <= 8 || _mm256_testc_si256(_mm256_loadu_si256(v + 1),
+                                       DE_C_BLOOM_mask_avx2(_h, _k, 8));
+}
+
+static const DE_C_BLOOM_kernels_t DE_C_BLOOM_kernels_avx2 = {
+    DE_C_BLOOM_insert_avx2, DE_C_BLOOM_contains_avx2};
+
+/* -- avx-512, all 16 lanes at once -- */
+#ifndef DE_OPTIONS_BLOOM_NO_AVX512
+#define DE_C_BLOOM_AVX512_TARGET __attribute__((target("avx512f")))
+
+DE_C_BLOOM_AVX512_TARGET static inline __m512i DE_C_BLOOM_mask_avx512(u32 _h,
+                                                                      u32 _k) {
+  const __m512i salts = _mm512_loadu_si512((const u0 *)DE_C_BLOOM_salts);
+  const __m512i pos = _mm512_srli_epi32(
+      _mm512_mullo_epi32(_mm512_set1_epi32((i32)_h), salts), 27);
+  return _mm512_maskz_sllv_epi32((__mmask16)((1u << _k) - 1),
+                                 _mm512_set1_epi32(1), pos);
+}
+
+DE_C_BLOOM_AVX512_TARGET DE_CONTAINER_BLOOM_INTERNAL u0
+DE_C_BLOOM_insert_avx512(mblk_t *_block, u32 _h, u32 _k) {
+  _mm512_storeu_si512(_block, _mm512_or_si512(_mm512_loadu_si512(_block),
+                                             DE_C_BLOOM_mask_avx512(_h, _k)));
+}
+DE_C_BLOOM_AVX512_TARGET DE_CONTAINER_BLOOM_INTERNAL bool
+DE_C_BLOOM_contains_avx512(const mblk_t *_block, u32 _h, u32 _k) {
+  const __m512i mask = DE_C_BLOOM_mask_avx512(_h, _k);
+  return !_mm512_test_epi32_mask(
+      _mm512_andnot_si512(_mm512_loadu_si512(_block), mask), mask);
+}
+
+static const DE_C_BLOOM_kernels_t DE_C_BLOOM_kernels_avx512 = {
+    DE_C_BLOOM_insert_avx512, DE_C_BLOOM_contains_avx512};
+#endif
+#endif
+
+static const u0 *DE_C_BLOOM_kernels_selected = NULL;
+
+DE_CONTAINER_BLOOM_INTERNAL const u0 *DE_C_BLOOM_kernels_pick(u0) {
+#ifdef DE_C_BLOOM_HAVE_DISPATCH
+  const DE_BVEC_cpu_level cpu = DE_BVEC_cpu_detect();
+#ifndef DE_OPTIONS_BLOOM_NO_AVX512
+  if (cpu >= DE_BVEC_CPU_AVX512)
+    return &DE_C_BLOOM_kernels_avx512;
+#endif
+  if (cpu >= DE_BVEC_CPU_AVX2)
+    return &DE_C_BLOOM_kernels_avx2;
+#endif
+  return &DE_C_BLOOM_kernels_scalar;
+}
+
+DE_CONTAINER_BLOOM_INTERNAL const DE_C_BLOOM_kernels_t *DE_C_BLOOM_kernels(u0) {
+  return (const DE_C_BLOOM_kernels_t *)DE_BVEC_dispatch(
+      &DE_C_BLOOM_kernels_selected, DE_C_BLOOM_kernels_pick);
+}
+
+/* ---- Sizing ---- */
+
+/* _base^_exp by squaring, keeps the header free of libm */
+DE_CONTAINER_BLOOM_INTERNAL f64 DE_C_BLOOM_pow(f64 _base, usize _exp) {
+  f64 out = 1.0;
+  for (; _exp; _exp >>= 1, _base *= _base)
+    if (_exp & 1)
+      out *= _base;
+  return out;
+}
+
+/* sum over the keys per block (binomial, _count keys over _blocks) of the
+   false positive rate of a block holding that many keys */
+DE_CONTAINER_BLOOM_INTERNAL f64 DE_C_BLOOM_fpr(const de_bloom_block _block,
+                                               const usize _blocks,
+                                               const u32 _k,
+                                               const usize _count) {
+  if (!_count)
+    return 0.0;
+  const f64 p = 1.0 / (f64)_blocks;
+  /* beyond ~700 keys per block the filter is saturated, this also bounds the
+     loop below */
+  if ((f64)_count / (f64)_blocks > 700.0)
+    return 1.0;
+  /* per key a bit of the tested lane / word stays 0 with this probability */
+  const f64 keep = _block == DE_BLOOM_BLOCK_512
+                       ? 31.0 / 32.0
+                       : DE_C_BLOOM_pow(63.0 / 64.0, _k);
+  /* a single block holds every key, p = 1 has no binomial split */
+  if (_blocks == 1)
+    return DE_C_BLOOM_pow(1.0 - DE_C_BLOOM_pow(keep, _count), _k);
+  const f64 mean = (f64)_count * p;
+  /* the binomial weights run unnormalized from 1 at no keys and get divided
+     by their sum at the end, (1 - p)^count underflows long before the filter
+     is saturated. rescaled whenever they grow large */
+  f64 term = 1.0, mass = 0.0, out = 0.0, clear = 1.0;
+  for (usize i = 0; i <= _count; ++i) {
+    out += term * DE_C_BLOOM_pow(1.0 - clear, _k);
+    mass += term;
+    /* past the mean the remaining terms no longer matter */
+    if ((f64)i > mean && term < 1e-17 * mass)
+      break;
+    clear *= keep;
+    term *= (f64)(_count - i) / (f64)(i + 1) * p / (1.0 - p);
+    if (term > 1e200) {
+      term *= 1e-200;
+      mass *= 1e-200;
+      out *= 1e-200;
+    }
+  }
+  return out / mass;
+}
+
+DE_CONTAINER_BLOOM_INTERNAL f64
+de_bloom_params_fpr(const de_bloom_params *const _params, const usize _count) {
+  return DE_C_BLOOM_fpr(_params->block, _params->blocks, _params->k, _count);
+}
+
+/* true unless _got is a number <= _target */
+DE_CONTAINER_BLOOM_INTERNAL bool DE_C_BLOOM_above(const f64 _got,
+                                                  const f64 _target) {
+  return !(_got <= _target);
+}
+
+/* for every k the smallest block count (doubling, then bisection), the
+   cheapest k wins */
+DE_CONTAINER_BLOOM_INTERNAL de_bloom_params
+de_bloom_params_for(const usize _count, const f64 _fpr,
+                    const de_bloom_block _block) {
+#ifndef DE_OPTIONS_BLOOM_NO_SAFETY_ASSERTS
+  DE_C_BLOOM_ASSERT(_fpr > 0.0 && _fpr < 1.0 && "fpr out of range");
+#endif
+  de_bloom_params out = {1, 1, _block, 0.0};
+  usize best = 0;
+  for (u32 k = 1; k <= DE_C_BLOOM_MAX_K; ++k) {
+    usize hi = 1;
+    while (DE_C_BLOOM_above(DE_C_BLOOM_fpr(_block, hi, k, _count), _fpr))
+      hi *= 2;
+    usize lo = hi / 2 + 1;
+    while (lo < hi) {
+      const usize mid = lo + (hi - lo) / 2;
+      if (DE_C_BLOOM_above(DE_C_BLOOM_fpr(_block, mid, k, _count), _fpr))
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    if (!best || hi < best) {
+      best = hi;
+      out.blocks = hi;
+      out.k = k;
+    }
+  }
+  out.fpr = DE_C_BLOOM_fpr(_block, out.blocks, out.k, _count);
+  return out;
+}
+
+/* ---- Lifecycle ---- */
+
+DE_CONTAINER_BLOOM_INTERNAL de_bloom
+de_bloom_create(const de_bloom_params *const _params) {
+#ifndef DE_OPTIONS_BLOOM_NO_SAFETY_ASSERTS
+  DE_C_BLOOM_ASSERT(_params->blocks && _params->k &&
+                    _params->k <= DE_C_BLOOM_MAX_K && "invalid bloom shape");
+  DE_C_BLOOM_ASSERT((_params->block == DE_BLOOM_BLOCK_64 ||
+                     _params->block == DE_BLOOM_BLOCK_512) &&
+                    "invalid bloom block");
+#endif
+  de_bloom out = {0};
+  out.blocks = _params->blocks;
+  out.k = _params->k;
+  out.block = _params->block;
+  const usize words = _params->blocks * (usize)_params->block;
+  /* whole cache lines, the padding words stay 0 */
+  const usize bytes = (words * sizeof(mblk_t) + DE_C_BLOOM_LINE - 1) &
+                      ~(usize)(DE_C_BLOOM_LINE - 1);
+#ifdef _WIN32
+  /* no aligned_alloc that pairs with free, blocks may straddle lines */
+  mblk_t *data = (mblk_t *)calloc(bytes, 1);
+#else
+  mblk_t *data = (mblk_t *)aligned_alloc(DE_C_BLOOM_LINE, bytes);
+  if (data)
+    memset(data, 0, bytes);
+#endif
+  DE_C_BLOOM_ASSERT(data && "out of memory");
+  /* laid out directly, de_bvec_delete frees it */
+  out.bits.data.blocks = data;
+  out.bits.bits_amount = words * DE_BVEC_MBLK_BITS;
+  out.bits.block_count = bytes / sizeof(mblk_t);
+  out.bits.last_block_bits_count = DE_BVEC_MBLK_BITS;
+  out.bits.is_small = false;
+  return out;
+}
+
+DE_CONTAINER_BLOOM_INTERNAL de_bloom de_bloom_create_for(
+    const usize _count, const f64 _fpr, const de_bloom_block _block) {
+  const de_bloom_params params = de_bloom_params_for(_count, _fpr, _block);
+  return de_bloom_create(&params);
+}
+
+DE_CONTAINER_BLOOM_INTERNAL u0 de_bloom_delete(de_bloom *const _bloom) {
+  de_bvec_delete(&_bloom->bits);
+  *_bloom = (de_bloom){0};
+}
+
+DE_CONTAINER_BLOOM_INTERNAL u0 de_bloom_clear(de_bloom *const _bloom) {
+  de_bvec_clear(&_bloom->bits);
+  _bloom->count = 0;
+}
+
+/* ---- Insert / query ---- */
+
+DE_CONTAINER_BLOOM_INTERNAL u0 DE_C_BLOOM_insert_at(de_bloom *const _bloom,
+                                                    mblk_t *const _block,
+                                                    const u64 _h) {
+  if (_bloom->block == DE_BLOOM_BLOCK_64)
+    *_block |= DE_C_BLOOM_mask64((u32)_h, _bloom->k);
+  else
+    DE_C_BLOOM_kernels()->insert(_block, (u32)_h, _bloom->k);
+}
+
+DE_CONTAINER_BLOOM_INTERNAL bool
+DE_C_BLOOM_contains_at(const de_bloom *const _bloom,
+                       const mblk_t *const _block, const u64 _h) {
+  if (_bloom->block == DE_BLOOM_BLOCK_64) {
+    const mblk_t mask = DE_C_BLOOM_mask64((u32)_h, _bloom->k);
+    return (*_block & mask) == mask;
+  }
+  return DE_C_BLOOM_kernels()->contains(_block, (u32)_h, _bloom->k);
+}
+
+DE_CONTAINER_BLOOM_INTERNAL u0 de_bloom_insert(de_bloom *const _bloom,
+                                               const u64 _hash) {
+  const u64 h = DE_C_BLOOM_mix(_hash);
+  DE_C_BLOOM_insert_at(_bloom, DE_C_BLOOM_block(_bloom, h), h);
+  ++_bloom->count;
+}
+
+DE_CONTAINER_BLOOM_INTERNAL bool de_bloom_contains(const de_bloom *const _bloom,
+                                                   const u64 _hash) {
+  const u64 h = DE_C_BLOOM_mix(_hash);
+  return DE_C_BLOOM_contains_at(_bloom, DE_C_BLOOM_block(_bloom, h), h);
+}
+
+/* hashes a chunk and prefetches its blocks before the first one is used */
+#define DE_C_BLOOM_PREPARE_CHUNK(_bloom, _hashes, _base, _len, _h, _blk, _rw)  \
+  for (usize j = 0; j < (_len); ++j) {                                         \
+    (_h)[j] = DE_C_BLOOM_mix((_hashes)[(_base) + j]);                          \
+    (_blk)[j] = DE_C_BLOOM_block((_bloom), (_h)[j]);                           \
+    __builtin_prefetch((_blk)[j], (_rw), 3);                                   \
+  }
+
+DE_CONTAINER_BLOOM_INTERNAL u0 de_bloom_insert_batch(de_bloom *const _bloom,
+                                                     const u64 *const _hashes,
+                                                     const usize _count) {
+  u64 h[DE_OPTIONS_BLOOM_BATCH_CHUNK];
+  mblk_t *blk[DE_OPTIONS_BLOOM_BATCH_CHUNK];
+  for (usize base = 0; base < _count; base += DE_OPTIONS_BLOOM_BATCH_CHUNK) {
+    const usize len = _count - base < DE_OPTIONS_BLOOM_BATCH_CHUNK
+                          ? _count - base
+                          : DE_OPTIONS_BLOOM_BATCH_CHUNK;
+    DE_C_BLOOM_PREPARE_CHUNK(_bloom, _hashes, base, len, h, blk, 1)
+    for (usize j = 0; j < len; ++j)
+      DE_C_BLOOM_insert_at(_bloom, blk[j], h[j]);
+  }
+  _bloom->count += _count;
+}
+
+DE_CONTAINER_BLOOM_INTERNAL usize
+de_bloom_contains_batch(const de_bloom *const _bloom, const u64 *const _hashes,
+                        const usize _count, bool *const _out) {
+  u64 h[DE_OPTIONS_BLOOM_BATCH_CHUNK];
+  mblk_t *blk[DE_OPTIONS_BLOOM_BATCH_CHUNK];
+  usize hits = 0;
+  for (usize base = 0; base < _count; base += DE_OPTIONS_BLOOM_BATCH_CHUNK) {
+    const usize len = _count - base < DE_OPTIONS_BLOOM_BATCH_CHUNK
+                          ? _count - base
+                          : DE_OPTIONS_BLOOM_BATCH_CHUNK;
+    DE_C_BLOOM_PREPARE_CHUNK(_bloom, _hashes, base, len, h, blk, 0)
+    for (usize j = 0; j < len; ++j) {
+      const bool hit = DE_C_BLOOM_contains_at(_bloom, blk[j], h[j]);
+      if (_out)
+        _out[base + j] = hit;
+      hits += hit;
+    }
+  }
+  return hits;
+}
+
+DE_CONTAINER_BLOOM_INTERNAL u0 de_bloom_union(de_bloom *const _dst,
+                                              const de_bloom *const _src) {
+#ifndef DE_OPTIONS_BLOOM_NO_SAFETY_ASSERTS
+  DE_C_BLOOM_ASSERT(_dst->blocks == _src->blocks && _dst->k == _src->k &&
+                    _dst->block == _src->block && "bloom shapes differ");
+#endif
+  de_bvec_or_msk(&_dst->bits, &_src->bits);
+  _dst->count += _src->count;
+}
+
+/* ---- Info ---- */
+
+DE_CONTAINER_BLOOM_INTERNAL f64 de_bloom_info_fpr(const de_bloom *const _bloom) {
+  return DE_C_BLOOM_fpr(_bloom->block, _bloom->blocks, _bloom->k,
+                        _bloom->count);
+}
+
+DE_CONTAINER_BLOOM_INTERNAL f64
+de_bloom_info_fill(const de_bloom *const _bloom) {
+  return (f64)de_bvec_count(&_bloom->bits) / (f64)_bloom->bits.bits_amount;
+}
+
+DE_CONTAINER_BLOOM_INTERNAL usize
+de_bloom_info_memory(const de_bloom *const _bloom) {
+  return _bloom->bits.block_count * sizeof(mblk_t);
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif
+#endif
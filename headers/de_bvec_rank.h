@@ -0,0 +1,391 @@
+#ifndef DE_CONTAINER_BVEC_RANK_HEADER
+#define DE_CONTAINER_BVEC_RANK_HEADER
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+to get function definitions #define DE_CONTAINER_BVEC_RANK_IMPLEMENTATION before
+any #include. the implementation reads the de_bvec struct directly, no other
+IMPLEMENTATION define is needed
+
+rank / select index over a de_bvec:
+  rank1(i)   number of 1 bits in [0, i), O(1)
+  select1(k) position of the k-th 1 bit (k counts from 0), a sampled binary
+             search over the superblocks plus at most 3 + 8 steps
+
+layout: one u64 per 2048 bit superblock holding the 32 bit count of 1 bits
+before it (relative to its 2^32 bit region) in the low half and the 10 bit
+counts of its first three 512 bit blocks in the high half, so a rank touches
+one index word and at most 8 bitmask words of the same 512 bit block. the
+region counts (one u64 per 2^32 bits) and every 8192th 1 bit's superblock
+(u32, for select) come on top: about 3.2% of the bitmask size in total.
+
+the index keeps a pointer to the bitmask and rebuilds itself on the next query
+once the bitmask got resized or reallocated. changing bits does not show up in
+the struct, call de_bvec_rank_invalidate after writing to the bitmask. queries
+may rebuild, so a shared index needs an explicit de_bvec_rank_build before
+concurrent readers use it
+*/
+
+/* clang-format off */
+/* possible options to set before 'first' include and IMPLEMENTATION */
+#ifndef DE_CONTAINER_BVEC_RANK_OPTIONS
+#ifdef DE_CONTAINER_BVEC_RANK_OPTIONS
+/* if defined removes assert checks */
+#define DE_OPTIONS_BVEC_RANK_NO_SAFETY_ASSERTS
+/* replace the allocator */
+#define DE_OPTIONS_BVEC_RANK_REALLOC realloc
+#define DE_OPTIONS_BVEC_RANK_FREE free
+#endif
+#endif
+
+#ifdef DE_CONTAINER_BVEC_RANK_IMPLEMENTATION
+#define DE_CONTAINER_BVEC_RANK_API
+#else
+#define DE_CONTAINER_BVEC_RANK_API extern
+#endif
+#define DE_CONTAINER_BVEC_RANK_INTERNAL
+
+/* declarations */
+#include <common.h>
+#include <stdbool.h>
+#include <de_bitmask.h>
+
+typedef struct {
+  const de_bvec* source;
+  u64*           super;        /* per 2048 bits: 32 bit prefix count | 3 x 10 bit block counts */
+  u64*           region;       /* per 2^32 bits: absolute prefix count */
+  u32*           samples;      /* superblock of every 8192th 1 bit */
+  usize          super_count;
+  usize          region_count;
+  usize          sample_count;
+  usize          ones;         /* 1 bits in the whole source */
+  usize          built_bits;   /* source->bits_amount when built */
+  const mblk_t*  built_data;   /* source block pointer when built */
+  bool           dirty;
+} de_bvec_rank;
+
+/* binds an index to _msk, nothing is built until the first query */
+DE_CONTAINER_BVEC_RANK_API de_bvec_rank
+de_bvec_rank_create(
+  const de_bvec *const _msk
+);
+
+/* frees the index, the bitmask is not touched */
+DE_CONTAINER_BVEC_RANK_API u0
+de_bvec_rank_delete(
+  de_bvec_rank *const _rank
+);
+
+/* marks the index stale after bits of the source changed, the next query rebuilds */
+DE_CONTAINER_BVEC_RANK_API u0
+de_bvec_rank_invalidate(
+  de_bvec_rank *const _rank
+);
+
+/* rebuilds now if stale, one pass over the bitmask */
+DE_CONTAINER_BVEC_RANK_API u0
+de_bvec_rank_build(
+  de_bvec_rank *const _rank
+);
+
+/* number of 1 bits before _idx, _idx <= bits_amount */
+DE_CONTAINER_BVEC_RANK_API usize
+de_bvec_rank1(
+  de_bvec_rank *const _rank,
+  const usize         _idx
+);
+
+/* number of 0 bits before _idx, _idx <= bits_amount */
+DE_CONTAINER_BVEC_RANK_API usize
+de_bvec_rank0(
+  de_bvec_rank *const _rank,
+  const usize         _idx
+);
+
+/* position of the 1 bit with rank _k (0 based), bits_amount if there are not enough */
+DE_CONTAINER_BVEC_RANK_API usize
+de_bvec_select1(
+  de_bvec_rank *const _rank,
+  const usize         _k
+);
+
+/* total number of 1 bits */
+DE_CONTAINER_BVEC_RANK_API usize
+de_bvec_rank_info_count(
+  de_bvec_rank *const _rank
+);
+
+/* bytes held by the index */
+DE_CONTAINER_BVEC_RANK_API usize
+de_bvec_rank_info_memory(
+  const de_bvec_rank *const _rank
+);
+
+/* clang-format on */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif
+
+// #define DE_CONTAINER_BVEC_RANK_IMPLEMENTATION_DEVELOPMENT
+#if defined(DE_CONTAINER_BVEC_RANK_IMPLEMENTATION) ||                          \
+    defined(DE_CONTAINER_BVEC_RANK_IMPLEMENTATION_DEVELOPMENT)
+#ifndef DE_CONTAINER_BVEC_RANK_IMPLEMENTATION_INTERNAL
+#define DE_CONTAINER_BVEC_RANK_IMPLEMENTATION_INTERNAL
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* implementations */
+#include <assert.h>
+#include <common.h>
+#include <stdlib.h>
+
+/* macro defines */
+#define DE_C_BRANK_ASSERT assert
+#ifndef DE_OPTIONS_BVEC_RANK_REALLOC
+#define DE_OPTIONS_BVEC_RANK_REALLOC realloc
+#endif
+#ifndef DE_OPTIONS_BVEC_RANK_FREE
+#define DE_OPTIONS_BVEC_RANK_FREE free
+#endif
+
+#define DE_C_BRANK_SUPER_WORDS 32 /* 2048 bits */
+#define DE_C_BRANK_BLOCK_WORDS 8  /* 512 bits */
+#define DE_C_BRANK_REGION_SHIFT 21 /* superblocks per 2^32 bits */
+#define DE_C_BRANK_SAMPLE_SHIFT 13 /* one select sample per 8192 ones */
+
+/* 10 bit count of block _b (0..2) of a superblock entry */
+#define DE_C_BRANK_BLOCK(_entry, _b) (((_entry) >> (32 + 10 * (_b))) & 0x3ff)
+
+DE_CONTAINER_BVEC_RANK_INTERNAL u0 *DE_C_BRANK_grow(u0 *_ptr, usize _bytes) {
+  u0 *out = DE_OPTIONS_BVEC_RANK_REALLOC(_ptr, _bytes ? _bytes : 1);
+  DE_C_BRANK_ASSERT(out && "out of memory");
+  return out;
+}
+
+/* word _w of the source with the bits past bits_amount cleared */
+DE_CONTAINER_BVEC_RANK_INTERNAL mblk_t DE_C_BRANK_word(const mblk_t *_words,
+                                                       usize _w, usize _bits) {
+  const mblk_t w = _words[_w];
+  const usize end = _bits - _w * DE_BVEC_MBLK_BITS;
+  return end >= DE_BVEC_MBLK_BITS ? w : w & ((((mblk_t)1) << end) - 1);
+}
+
+DE_CONTAINER_BVEC_RANK_INTERNAL const mblk_t *
+DE_C_BRANK_words(const de_bvec *const _msk) {
+  return _msk->is_small ? &_msk->data.small : _msk->data.blocks;
+}
+
+/* position of the _k-th 1 bit of _w, _k < popcount(_w) */
+DE_CONTAINER_BVEC_RANK_INTERNAL usize DE_C_BRANK_select_word(mblk_t _w,
+                                                             usize _k) {
+#if defined(__BMI2__)
+  return (usize)__builtin_ctzll(_pdep_u64(((mblk_t)1) << _k, _w));
+#else
+  usize pos = 0;
+  for (usize c; _k >= (c = (usize)__builtin_popcountll(_w & 0xff));
+       _w >>= 8, pos += 8)
+    _k -= c;
+  for (; _k; --_k)
+    _w &= _w - 1;
+  return pos + (usize)__builtin_ctzll(_w);
+#endif
+}
+
+DE_CONTAINER_BVEC_RANK_INTERNAL de_bvec_rank
+de_bvec_rank_create(const de_bvec *const _msk) {
+  de_bvec_rank out = {0};
+  out.source = _msk;
+  out.dirty = true;
+  return out;
+}
+
+DE_CONTAINER_BVEC_RANK_INTERNAL u0 de_bvec_rank_delete(de_bvec_rank *const _rank) {
+  DE_OPTIONS_BVEC_RANK_FREE(_rank->super);
+  DE_OPTIONS_BVEC_RANK_FREE(_rank->region);
+  DE_OPTIONS_BVEC_RANK_FREE(_rank->samples);
+  *_rank = (de_bvec_rank){0};
+}
+
+DE_CONTAINER_BVEC_RANK_INTERNAL u0
+de_bvec_rank_invalidate(de_bvec_rank *const _rank) {
+  _rank->dirty = true;
+}
+
+DE_CONTAINER_BVEC_RANK_INTERNAL bool
+DE_C_BRANK_stale(const de_bvec_rank *const _rank) {
+  return _rank->dirty || _rank->built_bits != _rank->source->bits_amount ||
+         _rank->built_data != DE_C_BRANK_words(_rank->source);
+}
+
+DE_CONTAINER_BVEC_RANK_INTERNAL u0 DE_C_BRANK_rebuild(de_bvec_rank *const _rank) {
+  const de_bvec *const src = _rank->source;
+  const usize bits = src->bits_amount;
+  const mblk_t *const words = DE_C_BRANK_words(src);
+  const usize word_count = (bits + DE_BVEC_MBLK_BITS - 1) / DE_BVEC_MBLK_BITS;
+  const usize supers =
+      (word_count + DE_C_BRANK_SUPER_WORDS - 1) / DE_C_BRANK_SUPER_WORDS;
+  const usize regions = (supers >> DE_C_BRANK_REGION_SHIFT) + 1;
+#ifndef DE_OPTIONS_BVEC_RANK_NO_SAFETY_ASSERTS
+  DE_C_BRANK_ASSERT(supers <= (usize)UINT32_MAX &&
+                    "bitmask too large for u32 select samples");
+#endif
+
+  if (supers > _rank->super_count || !_rank->super)
+    _rank->super = (u64 *)DE_C_BRANK_grow(_rank->super, supers * sizeof(u64));
+  if (regions > _rank->region_count || !_rank->region)
+    _rank->region =
+        (u64 *)DE_C_BRANK_grow(_rank->region, regions * sizeof(u64));
+  _rank->super_count = supers;
+  _rank->region_count = regions;
+
+  /* counts */
+  usize total = 0;
+  for (usize s = 0; s < supers; ++s) {
+    if (!(s & ((((usize)1) << DE_C_BRANK_REGION_SHIFT) - 1)))
+      _rank->region[s >> DE_C_BRANK_REGION_SHIFT] = total;
+    const usize base = _rank->region[s >> DE_C_BRANK_REGION_SHIFT];
+    u64 entry = (u64)(total - base);
+    const usize w0 = s * DE_C_BRANK_SUPER_WORDS;
+    for (usize b = 0; b < 4; ++b) {
+      usize c = 0;
+      const usize from = w0 + b * DE_C_BRANK_BLOCK_WORDS;
+      const usize to = from + DE_C_BRANK_BLOCK_WORDS;
+      for (usize w = from; w < to && w < word_count; ++w)
+        c += (usize)__builtin_popcountll(DE_C_BRANK_word(words, w, bits));
+      if (b < 3)
+        entry |= (u64)c << (32 + 10 * b);
+      total += c;
+    }
+    _rank->super[s] = entry;
+  }
+  if (supers == 0)
+    _rank->region[0] = 0;
+
+  /* select samples: superblock holding the 1 bit of rank j << SAMPLE_SHIFT */
+  const usize samples = (total >> DE_C_BRANK_SAMPLE_SHIFT) + 1;
+  if (samples > _rank->sample_count || !_rank->samples)
+    _rank->samples =
+        (u32 *)DE_C_BRANK_grow(_rank->samples, samples * sizeof(u32));
+  _rank->sample_count = samples;
+  usize next = 0;
+  for (usize s = 0, j = 0; s < supers && j < samples; ++s) {
+    const usize end = s + 1 < supers
+                          ? _rank->region[(s + 1) >> DE_C_BRANK_REGION_SHIFT] +
+                                (u32)_rank->super[s + 1]
+                          : total;
+    for (; j < samples && next < end;
+         ++j, next += ((usize)1) << DE_C_BRANK_SAMPLE_SHIFT)
+      _rank->samples[j] = (u32)s;
+  }
+  if (total == 0)
+    _rank->samples[0] = 0;
+
+  _rank->ones = total;
+  _rank->built_bits = bits;
+  _rank->built_data = words;
+  _rank->dirty = false;
+}
+
+DE_CONTAINER_BVEC_RANK_INTERNAL u0 de_bvec_rank_build(de_bvec_rank *const _rank) {
+  if (DE_C_BRANK_stale(_rank))
+    DE_C_BRANK_rebuild(_rank);
+}
+
+/* absolute count of 1 bits before superblock _s */
+DE_CONTAINER_BVEC_RANK_INTERNAL usize
+DE_C_BRANK_super_prefix(const de_bvec_rank *const _rank, usize _s) {
+  return _rank->region[_s >> DE_C_BRANK_REGION_SHIFT] + (u32)_rank->super[_s];
+}
+
+DE_CONTAINER_BVEC_RANK_INTERNAL usize de_bvec_rank1(de_bvec_rank *const _rank,
+                                                    const usize _idx) {
+  de_bvec_rank_build(_rank);
+  const usize bits = _rank->built_bits;
+#ifndef DE_OPTIONS_BVEC_RANK_NO_SAFETY_ASSERTS
+  DE_C_BRANK_ASSERT(_idx <= bits && "rank index out of range");
+#endif
+  if (_idx >= bits)
+    return _rank->ones;
+  const mblk_t *const words = _rank->built_data;
+  const usize s = _idx / (DE_C_BRANK_SUPER_WORDS * DE_BVEC_MBLK_BITS);
+  const u64 entry = _rank->super[s];
+  usize out = DE_C_BRANK_super_prefix(_rank, s);
+  const usize block = (_idx / (DE_C_BRANK_BLOCK_WORDS * DE_BVEC_MBLK_BITS)) & 3;
+  /* blocks before this one, branch free */
+  const usize c0 = DE_C_BRANK_BLOCK(entry, 0), c1 = DE_C_BRANK_BLOCK(entry, 1),
+              c2 = DE_C_BRANK_BLOCK(entry, 2);
+  out += (block > 0 ? c0 : 0) + (block > 1 ? c1 : 0) + (block > 2 ? c2 : 0);
+  const usize word = _idx / DE_BVEC_MBLK_BITS;
+  for (usize w = word & ~(usize)(DE_C_BRANK_BLOCK_WORDS - 1); w < word; ++w)
+    out += (usize)__builtin_popcountll(words[w]);
+  const usize shift = _idx % DE_BVEC_MBLK_BITS;
+  if (shift)
+    out += (usize)__builtin_popcountll(words[word] << (DE_BVEC_MBLK_BITS - shift));
+  return out;
+}
+
+DE_CONTAINER_BVEC_RANK_INTERNAL usize de_bvec_rank0(de_bvec_rank *const _rank,
+                                                    const usize _idx) {
+  return _idx - de_bvec_rank1(_rank, _idx);
+}
+
+DE_CONTAINER_BVEC_RANK_INTERNAL usize de_bvec_select1(de_bvec_rank *const _rank,
+                                                      const usize _k) {
+  de_bvec_rank_build(_rank);
+  if (_k >= _rank->ones)
+    return _rank->built_bits;
+  /* last superblock whose prefix is <= _k, inside the sampled range */
+  const usize j = _k >> DE_C_BRANK_SAMPLE_SHIFT;
+  usize lo = _rank->samples[j];
+  usize hi = j + 1 < _rank->sample_count ? (usize)_rank->samples[j + 1] + 1
+                                         : _rank->super_count;
+  while (hi - lo > 1) {
+    const usize mid = lo + (hi - lo) / 2;
+    if (DE_C_BRANK_super_prefix(_rank, mid) <= _k)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  usize rest = _k - DE_C_BRANK_super_prefix(_rank, lo);
+  const u64 entry = _rank->super[lo];
+  usize word = lo * DE_C_BRANK_SUPER_WORDS;
+  for (usize b = 0; b < 3; ++b) {
+    const usize c = DE_C_BRANK_BLOCK(entry, b);
+    if (rest < c)
+      break;
+    rest -= c;
+    word += DE_C_BRANK_BLOCK_WORDS;
+  }
+  const mblk_t *const words = _rank->built_data;
+  const usize bits = _rank->built_bits;
+  for (;; ++word) {
+    const mblk_t w = DE_C_BRANK_word(words, word, bits);
+    const usize c = (usize)__builtin_popcountll(w);
+    if (rest < c)
+      return word * DE_BVEC_MBLK_BITS + DE_C_BRANK_select_word(w, rest);
+    rest -= c;
+  }
+}
+
+DE_CONTAINER_BVEC_RANK_INTERNAL usize
+de_bvec_rank_info_count(de_bvec_rank *const _rank) {
+  de_bvec_rank_build(_rank);
+  return _rank->ones;
+}
+
+DE_CONTAINER_BVEC_RANK_INTERNAL usize
+de_bvec_rank_info_memory(const de_bvec_rank *const _rank) {
+  return _rank->super_count * sizeof(u64) +
+         _rank->region_count * sizeof(u64) + _rank->sample_count * sizeof(u32);
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif
+#endif
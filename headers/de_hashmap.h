@@ -0,0 +1,635 @@
+#ifndef DE_CONTAINER_HASHMAP_HEADER
+#define DE_CONTAINER_HASHMAP_HEADER
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+to get function definitions #define DE_CONTAINER_HASHMAP_IMPLEMENTATION before
+any #include
+
+open addressing hash map with swiss table style control bytes.
+keys and values are stored by value (key_size / value_size bytes, like de_vec's
+item_size). a value_size of 0 turns the map into a set.
+
+probing is linear over slots and the control bytes are scanned 16 at a time,
+so deletion shifts the following entries back instead of leaving tombstones.
+
+IMPORTANT: pointers returned by get/insert go invalid once the map rehashes
+           (insert beyond capacity, reserve) or an element is removed
+*/
+
+/* clang-format off */
+/* possible options to set before 'first' include and IMPLEMENTATION */
+#ifndef DE_CONTAINER_HASHMAP_OPTIONS
+#ifdef DE_CONTAINER_HASHMAP_OPTIONS
+/* if defined removes assert checks */
+#define DE_OPTIONS_HASHMAP_NO_SAFETY_ASSERTS
+
+#define DE_OPTIONS_HASHMAP_INITIAL_SIZE defaults to 16 /* has to be 2^n and >= 16 */
+#define DE_OPTIONS_HASHMAP_MAX_LOAD_NUM defaults to 7 /* max load factor is NUM / DEN */
+#define DE_OPTIONS_HASHMAP_MAX_LOAD_DEN defaults to 8
+#define DE_OPTIONS_HASHMAP_DATA_PTR_MALLOC_FUNCTION defaults to malloc from stdlib
+#define DE_OPTIONS_HASHMAP_DATA_PTR_FREE_FUNCTION defaults to free
+#endif
+#endif
+
+#ifdef DE_CONTAINER_HASHMAP_IMPLEMENTATION
+#define DE_CONTAINER_HASHMAP_API
+#else
+#define DE_CONTAINER_HASHMAP_API extern
+#endif
+#define DE_CONTAINER_HASHMAP_INTERNAL
+
+/* declarations */
+#include <common.h>
+#include <stdbool.h>
+
+/* hash: returns a 64 bit hash of the _key_size bytes at key. NULL selects de_hashmap_hash_bytes */
+typedef u64 (*de_hashmap_hash_func)(const u0 *key, usize key_size);
+
+/* equality: returns true if both keys are equal. NULL selects memcmp */
+typedef bool (*de_hashmap_eq_func)(const u0 *a, const u0 *b, usize key_size);
+/* example:
+  bool eq_str(const void *a, const void *b, size_t key_size) {
+    return strcmp(*(const char **)a, *(const char **)b) == 0;
+  }
+*/
+
+/* amount of control bytes looked at per probe step */
+#define DE_HASHMAP_GROUP_WIDTH 16
+
+typedef struct {
+  usize key_size;
+  usize value_size;
+  usize value_offset;  /* offset of the value inside a slot */
+  usize slot_size;     /* bytes per slot (key + padding + value) */
+
+  usize capacity;      /* amount of slots, 2^n */
+  usize used;
+  usize growth_left;   /* inserts left until a rehash is required */
+
+  i8* ctrl;            /* capacity + GROUP_WIDTH - 1 control bytes, tail mirrors the head */
+  u8* slots;
+
+  de_hashmap_hash_func hash;
+  de_hashmap_eq_func   eq;
+} de_hashmap;
+
+/*
+  constructors
+*/
+
+/* returns a map. _key_size and _value_size in bytes, _hash and _eq may be NULL */
+DE_CONTAINER_HASHMAP_API de_hashmap
+de_hashmap_create(
+  const usize                _key_size,
+  const usize                _value_size,
+  const de_hashmap_hash_func _hash,
+  const de_hashmap_eq_func   _eq
+);
+
+/* returns a map that can hold _count elements without rehashing */
+DE_CONTAINER_HASHMAP_API de_hashmap
+de_hashmap_create_with_capacity(
+  const usize                _key_size,
+  const usize                _value_size,
+  const de_hashmap_hash_func _hash,
+  const de_hashmap_eq_func   _eq,
+  const usize                _count
+);
+
+/* removes all elements, keeps capacity */
+DE_CONTAINER_HASHMAP_API u0
+de_hashmap_clear(
+  de_hashmap *const _map
+);
+
+/* delete entire map */
+DE_CONTAINER_HASHMAP_API u0
+de_hashmap_delete(
+  de_hashmap *const _map
+);
+
+/*
+  Info getters
+*/
+
+/* current number of stored elements */
+DE_CONTAINER_HASHMAP_API usize
+de_hashmap_info_size(
+  const de_hashmap *const _map
+);
+
+/* amount of slots */
+DE_CONTAINER_HASHMAP_API usize
+de_hashmap_info_capacity(
+  const de_hashmap *const _map
+);
+
+DE_CONTAINER_HASHMAP_API bool
+de_hashmap_info_empty(
+  const de_hashmap *const _map
+);
+
+/*
+  Capacity / resizing
+*/
+
+/* makes room for _count elements, so that no rehash happens until then. will not shrink */
+DE_CONTAINER_HASHMAP_API u0
+de_hashmap_reserve(
+  de_hashmap *const _map,
+  const usize       _count
+);
+
+/*
+  Access
+*/
+
+/* returns address of the value stored for _key, NULL if not present.
+   for sets (value_size 0) the address of the stored key is returned */
+DE_CONTAINER_HASHMAP_API u0*
+de_hashmap_get(
+  const de_hashmap *const _map,
+  const u0 *const         _key
+);
+
+/* de_hashmap_get but with an automatic type* cast */
+#define de_hashmap_getA(type, _map, _key) ((type*)de_hashmap_get(_map, _key))
+
+DE_CONTAINER_HASHMAP_API bool
+de_hashmap_contains(
+  const de_hashmap *const _map,
+  const u0 *const         _key
+);
+
+/* returns address of the value stored for _key. if _key is not present it gets
+   inserted with an uninitialized value and *_inserted (may be NULL) is set to true */
+DE_CONTAINER_HASHMAP_API u0*
+de_hashmap_get_or_insert(
+  de_hashmap *const _map,
+  const u0 *const   _key,
+  bool *const       _inserted
+);
+
+/* copies _key and _value into the map, overwrites the value if _key is present.
+   returns true if a new element was inserted. _value may be NULL for sets */
+DE_CONTAINER_HASHMAP_API bool
+de_hashmap_insert(
+  de_hashmap *const _map,
+  const u0 *const   _key,
+  const u0 *const   _value
+);
+
+/* removes _key, returns true if removed */
+DE_CONTAINER_HASHMAP_API bool
+de_hashmap_remove(
+  de_hashmap *const _map,
+  const u0 *const   _key
+);
+
+/*
+  iteration
+*/
+
+/* advances *_iter (start with 0) to the next element and writes its key / value
+   addresses (both may be NULL). returns false once all elements were visited.
+   the map must not be modified during iteration */
+DE_CONTAINER_HASHMAP_API bool
+de_hashmap_next(
+  const de_hashmap *const _map,
+  usize *const            _iter,
+  u0 **const              _key,
+  u0 **const              _value
+);
+
+/* default hash over raw bytes */
+DE_CONTAINER_HASHMAP_API u64
+de_hashmap_hash_bytes(
+  const u0 *_key,
+  usize     _key_size
+);
+
+/* clang-format on */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif
+
+// #define DE_CONTAINER_HASHMAP_IMPLEMENTATION_DEVELOPMENT
+#if defined(DE_CONTAINER_HASHMAP_IMPLEMENTATION) ||                            \
+    defined(DE_CONTAINER_HASHMAP_IMPLEMENTATION_DEVELOPMENT)
+#ifndef DE_CONTAINER_HASHMAP_IMPLEMENTATION_INTERNAL
+#define DE_CONTAINER_HASHMAP_IMPLEMENTATION_INTERNAL
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* implementations */
+#include <assert.h>
+#include <common.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* macro defines */
+#ifndef DE_OPTIONS_HASHMAP_INITIAL_SIZE
+#define DE_OPTIONS_HASHMAP_INITIAL_SIZE 16
+#endif
+
+#ifndef DE_OPTIONS_HASHMAP_MAX_LOAD_NUM
+#define DE_OPTIONS_HASHMAP_MAX_LOAD_NUM 7
+#endif
+
+#ifndef DE_OPTIONS_HASHMAP_MAX_LOAD_DEN
+#define DE_OPTIONS_HASHMAP_MAX_LOAD_DEN 8
+#endif
+
+#ifndef DE_OPTIONS_HASHMAP_DATA_PTR_MALLOC_FUNCTION
+#define DE_OPTIONS_HASHMAP_DATA_PTR_MALLOC_FUNCTION malloc
+#endif
+
+#ifndef DE_OPTIONS_HASHMAP_DATA_PTR_FREE_FUNCTION
+#define DE_OPTIONS_HASHMAP_DATA_PTR_FREE_FUNCTION free
+#endif
+
+#define DE_C_HMAP_D_MALLOC DE_OPTIONS_HASHMAP_DATA_PTR_MALLOC_FUNCTION
+#define DE_C_HMAP_D_FREE DE_OPTIONS_HASHMAP_DATA_PTR_FREE_FUNCTION
+#define DE_C_HMAP_MEMCPY memcpy
+#define DE_C_HMAP_MEMCMP memcmp
+#define DE_C_HMAP_MEMSET memset
+#define DE_C_HMAP_ASSERT assert
+
+/* control byte states. full slots store the 7 bit h2 of their hash */
+#define DE_C_HMAP_CTRL_EMPTY ((i8)-128)
+#define DE_C_HMAP_H2(hash) ((i8)((hash) >> 57))
+
+/*
+  group matching, bit i of the result belongs to ctrl[i]
+*/
+
+#ifdef __SSE2__
+DE_CONTAINER_HASHMAP_INTERNAL u32 DE_C_HMAP_group_match(const i8 *const _ctrl,
+                                                        const i8 _h2) {
+  const __m128i group = _mm_loadu_si128((const __m128i *)_ctrl);
+  return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(_h2)));
+}
+
+DE_CONTAINER_HASHMAP_INTERNAL u32
+DE_C_HMAP_group_match_empty(const i8 *const _ctrl) {
+  /* only EMPTY has the sign bit set */
+  return (u32)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)_ctrl));
+}
+#else
+DE_CONTAINER_HASHMAP_INTERNAL u32 DE_C_HMAP_group_match(const i8 *const _ctrl,
+                                                        const i8 _h2) {
+  u32 out = 0;
+  for (u32 i = 0; i < DE_HASHMAP_GROUP_WIDTH; ++i)
+    out |= (u32)(_ctrl[i] == _h2) << i;
+  return out;
+}
+
+DE_CONTAINER_HASHMAP_INTERNAL u32
+DE_C_HMAP_group_match_empty(const i8 *const _ctrl) {
+  return DE_C_HMAP_group_match(_ctrl, DE_C_HMAP_CTRL_EMPTY);
+}
+#endif
+
+/*
+  internal helpers
+*/
+
+DE_CONTAINER_HASHMAP_INTERNAL usize DE_C_HMAP_align_of_size(const usize _size) {
+  if (_size == 0)
+    return 1;
+  const usize align = _size & (~_size + 1);
+  return align > 16 ? 16 : align;
+}
+
+DE_CONTAINER_HASHMAP_INTERNAL usize DE_C_HMAP_round_up(const usize _x,
+                                                       const usize _align) {
+  return (_x + _align - 1) / _align * _align;
+}
+
+/* smallest 2^n slot count that holds _count elements below the max load */
+DE_CONTAINER_HASHMAP_INTERNAL usize DE_C_HMAP_capacity_for(const usize _count) {
+  usize cap = DE_OPTIONS_HASHMAP_INITIAL_SIZE;
+  while (cap / DE_OPTIONS_HASHMAP_MAX_LOAD_DEN * DE_OPTIONS_HASHMAP_MAX_LOAD_NUM <
+         _count)
+    cap *= 2;
+  return cap;
+}
+
+DE_CONTAINER_HASHMAP_INTERNAL u64 DE_C_HMAP_hash(const de_hashmap *const _map,
+                                                 const u0 *const _key) {
+  return _map->hash ? _map->hash(_key, _map->key_size)
+                    : de_hashmap_hash_bytes(_key, _map->key_size);
+}
+
+DE_CONTAINER_HASHMAP_INTERNAL bool DE_C_HMAP_eq(const de_hashmap *const _map,
+                                                const u0 *const _a,
+                                                const u0 *const _b) {
+  return _map->eq ? _map->eq(_a, _b, _map->key_size)
+                  : DE_C_HMAP_MEMCMP(_a, _b, _map->key_size) == 0;
+}
+
+DE_CONTAINER_HASHMAP_INTERNAL u8 *DE_C_HMAP_slot(const de_hashmap *const _map,
+                                                 const usize _idx) {
+  return _map->slots + _idx * _map->slot_size;
+}
+
+/* sets a control byte and its mirror behind the end of the table */
+DE_CONTAINER_HASHMAP_INTERNAL u0 DE_C_HMAP_set_ctrl(de_hashmap *const _map,
+                                                    const usize _idx,
+                                                    const i8 _value) {
+  _map->ctrl[_idx] = _value;
+  if (_idx < DE_HASHMAP_GROUP_WIDTH - 1)
+    _map->ctrl[_map->capacity + _idx] = _value;
+}
+
+DE_CONTAINER_HASHMAP_INTERNAL u0 DE_C_HMAP_alloc(de_hashmap *const _map,
+                                                 const usize _capacity) {
+  _map->capacity = _capacity;
+  _map->used = 0;
+  _map->growth_left = _capacity / DE_OPTIONS_HASHMAP_MAX_LOAD_DEN *
+                      DE_OPTIONS_HASHMAP_MAX_LOAD_NUM;
+  _map->ctrl = (i8 *)DE_C_HMAP_D_MALLOC(_capacity + DE_HASHMAP_GROUP_WIDTH - 1);
+  _map->slots = (u8 *)DE_C_HMAP_D_MALLOC(_capacity * _map->slot_size);
+  DE_C_HMAP_MEMSET(_map->ctrl, DE_C_HMAP_CTRL_EMPTY,
+                   _capacity + DE_HASHMAP_GROUP_WIDTH - 1);
+}
+
+/* returns the slot index of _key, or _map->capacity if absent */
+DE_CONTAINER_HASHMAP_INTERNAL usize DE_C_HMAP_find(const de_hashmap *const _map,
+                                                   const u0 *const _key,
+                                                   const u64 _hash) {
+  const usize mask = _map->capacity - 1;
+  const i8 h2 = DE_C_HMAP_H2(_hash);
+  usize pos = (usize)_hash & mask;
+  for (;;) {
+    const i8 *group = _map->ctrl + pos;
+    u32 match = DE_C_HMAP_group_match(group, h2);
+    while (match) {
+      const usize idx = (pos + (usize)__builtin_ctz(match)) & mask;
+      if (DE_C_HMAP_eq(_map, DE_C_HMAP_slot(_map, idx), _key))
+        return idx;
+      match &= match - 1;
+    }
+    /* probing is linear, so an empty slot ends the run of possible matches */
+    if (DE_C_HMAP_group_match_empty(group))
+      return _map->capacity;
+    pos = (pos + DE_HASHMAP_GROUP_WIDTH) & mask;
+  }
+}
+
+/* returns the first empty slot on the probe sequence of _hash */
+DE_CONTAINER_HASHMAP_INTERNAL usize
+DE_C_HMAP_find_empty(const de_hashmap *const _map, const u64 _hash) {
+  const usize mask = _map->capacity - 1;
+  usize pos = (usize)_hash & mask;
+  for (;;) {
+    const u32 empty = DE_C_HMAP_group_match_empty(_map->ctrl + pos);
+    if (empty)
+      return (pos + (usize)__builtin_ctz(empty)) & mask;
+    pos = (pos + DE_HASHMAP_GROUP_WIDTH) & mask;
+  }
+}
+
+DE_CONTAINER_HASHMAP_INTERNAL u0 DE_C_HMAP_rehash(de_hashmap *const _map,
+                                                  const usize _capacity) {
+  i8 *old_ctrl = _map->ctrl;
+  u8 *old_slots = _map->slots;
+  const usize old_capacity = _map->capacity;
+  const usize used = _map->used;
+
+  DE_C_HMAP_alloc(_map, _capacity);
+  for (usize i = 0; i < old_capacity; ++i) {
+    if (old_ctrl[i] == DE_C_HMAP_CTRL_EMPTY)
+      continue;
+    const u8 *src = old_slots + i * _map->slot_size;
+    const u64 hash = DE_C_HMAP_hash(_map, src);
+    const usize idx = DE_C_HMAP_find_empty(_map, hash);
+    DE_C_HMAP_set_ctrl(_map, idx, DE_C_HMAP_H2(hash));
+    DE_C_HMAP_MEMCPY(DE_C_HMAP_slot(_map, idx), src, _map->slot_size);
+  }
+  _map->used = used;
+  _map->growth_left -= used;
+
+  DE_C_HMAP_D_FREE(old_ctrl);
+  DE_C_HMAP_D_FREE(old_slots);
+}
+
+/*
+  constructors
+*/
+
+DE_CONTAINER_HASHMAP_INTERNAL de_hashmap de_hashmap_create_with_capacity(
+    const usize _key_size, const usize _value_size,
+    const de_hashmap_hash_func _hash, const de_hashmap_eq_func _eq,
+    const usize _count) {
+#ifndef DE_OPTIONS_HASHMAP_NO_SAFETY_ASSERTS
+  DE_C_HMAP_ASSERT(_key_size > 0 && "keys need a size");
+#endif
+  de_hashmap out = {0};
+  const usize key_align = DE_C_HMAP_align_of_size(_key_size);
+  const usize value_align = DE_C_HMAP_align_of_size(_value_size);
+  out.key_size = _key_size;
+  out.value_size = _value_size;
+  /* sets hand out the key as their value */
+  out.value_offset =
+      _value_size ? DE_C_HMAP_round_up(_key_size, value_align) : 0;
+  out.slot_size = DE_C_HMAP_round_up(
+      _value_size ? out.value_offset + _value_size : _key_size,
+      key_align > value_align ? key_align : value_align);
+  out.hash = _hash;
+  out.eq = _eq;
+  DE_C_HMAP_alloc(&out, DE_C_HMAP_capacity_for(_count));
+  return out;
+}
+
+DE_CONTAINER_HASHMAP_INTERNAL de_hashmap
+de_hashmap_create(const usize _key_size, const usize _value_size,
+                  const de_hashmap_hash_func _hash,
+                  const de_hashmap_eq_func _eq) {
+  return de_hashmap_create_with_capacity(_key_size, _value_size, _hash, _eq, 0);
+}
+
+DE_CONTAINER_HASHMAP_INTERNAL u0 de_hashmap_clear(de_hashmap *const _map) {
+  DE_C_HMAP_MEMSET(_map->ctrl, DE_C_HMAP_CTRL_EMPTY,
+                   _map->capacity + DE_HASHMAP_GROUP_WIDTH - 1);
+  _map->used = 0;
+  _map->growth_left = _map->capacity / DE_OPTIONS_HASHMAP_MAX_LOAD_DEN *
+                      DE_OPTIONS_HASHMAP_MAX_LOAD_NUM;
+}
+
+DE_CONTAINER_HASHMAP_INTERNAL u0 de_hashmap_delete(de_hashmap *const _map) {
+  DE_C_HMAP_D_FREE(_map->ctrl);
+  DE_C_HMAP_D_FREE(_map->slots);
+  *_map = (de_hashmap){0};
+}
+
+/*
+  Info getters
+*/
+
+DE_CONTAINER_HASHMAP_INTERNAL usize
+de_hashmap_info_size(const de_hashmap *const _map) {
+  return _map->used;
+}
+
+DE_CONTAINER_HASHMAP_INTERNAL usize
+de_hashmap_info_capacity(const de_hashmap *const _map) {
+  return _map->capacity;
+}
+
+DE_CONTAINER_HASHMAP_INTERNAL bool
+de_hashmap_info_empty(const de_hashmap *const _map) {
+  return _map->used == 0;
+}
+
+/*
+  Capacity / resizing
+*/
+
+DE_CONTAINER_HASHMAP_INTERNAL u0 de_hashmap_reserve(de_hashmap *const _map,
+                                                    const usize _count) {
+  const usize capacity = DE_C_HMAP_capacity_for(_count);
+  if (capacity > _map->capacity)
+    DE_C_HMAP_rehash(_map, capacity);
+}
+
+/*
+  Access
+*/
+
+DE_CONTAINER_HASHMAP_INTERNAL u0 *de_hashmap_get(const de_hashmap *const _map,
+                                                 const u0 *const _key) {
+  const usize idx = DE_C_HMAP_find(_map, _key, DE_C_HMAP_hash(_map, _key));
+  if (idx == _map->capacity)
+    return NULL;
+  return (u0 *)(DE_C_HMAP_slot(_map, idx) + _map->value_offset);
+}
+
+DE_CONTAINER_HASHMAP_INTERNAL bool
+de_hashmap_contains(const de_hashmap *const _map, const u0 *const _key) {
+  return DE_C_HMAP_find(_map, _key, DE_C_HMAP_hash(_map, _key)) !=
+         _map->capacity;
+}
+
+DE_CONTAINER_HASHMAP_INTERNAL u0 *de_hashmap_get_or_insert(
+    de_hashmap *const _map, const u0 *const _key, bool *const _inserted) {
+  const u64 hash = DE_C_HMAP_hash(_map, _key);
+  usize idx = DE_C_HMAP_find(_map, _key, hash);
+  if (idx != _map->capacity) {
+    if (_inserted)
+      *_inserted = false;
+    return (u0 *)(DE_C_HMAP_slot(_map, idx) + _map->value_offset);
+  }
+
+  if (_map->growth_left == 0)
+    DE_C_HMAP_rehash(_map, _map->capacity * 2);
+
+  idx = DE_C_HMAP_find_empty(_map, hash);
+  DE_C_HMAP_set_ctrl(_map, idx, DE_C_HMAP_H2(hash));
+  u8 *slot = DE_C_HMAP_slot(_map, idx);
+  DE_C_HMAP_MEMCPY(slot, _key, _map->key_size);
+  ++_map->used;
+  --_map->growth_left;
+  if (_inserted)
+    *_inserted = true;
+  return (u0 *)(slot + _map->value_offset);
+}
+
+DE_CONTAINER_HASHMAP_INTERNAL bool de_hashmap_insert(de_hashmap *const _map,
+                                                     const u0 *const _key,
+                                                     const u0 *const _value) {
+  bool inserted;
+  u0 *value = de_hashmap_get_or_insert(_map, _key, &inserted);
+  if (_value && _map->value_size)
+    DE_C_HMAP_MEMCPY(value, _value, _map->value_size);
+  return inserted;
+}
+
+DE_CONTAINER_HASHMAP_INTERNAL bool de_hashmap_remove(de_hashmap *const _map,
+                                                     const u0 *const _key) {
+  usize hole = DE_C_HMAP_find(_map, _key, DE_C_HMAP_hash(_map, _key));
+  if (hole == _map->capacity)
+    return false;
+
+  /* backward shift: pull every following entry whose home is not between the
+     hole and itself into the hole, until an empty slot ends the run */
+  const usize mask = _map->capacity - 1;
+  usize idx = (hole + 1) & mask;
+  while (_map->ctrl[idx] != DE_C_HMAP_CTRL_EMPTY) {
+    u8 *slot = DE_C_HMAP_slot(_map, idx);
+    const usize home = (usize)DE_C_HMAP_hash(_map, slot) & mask;
+    if (((idx - home) & mask) >= ((idx - hole) & mask)) {
+      DE_C_HMAP_set_ctrl(_map, hole, _map->ctrl[idx]);
+      DE_C_HMAP_MEMCPY(DE_C_HMAP_slot(_map, hole), slot, _map->slot_size);
+      hole = idx;
+    }
+    idx = (idx + 1) & mask;
+  }
+  DE_C_HMAP_set_ctrl(_map, hole, DE_C_HMAP_CTRL_EMPTY);
+  --_map->used;
+  ++_map->growth_left;
+  return true;
+}
+
+/*
+  iteration
+*/
+
+DE_CONTAINER_HASHMAP_INTERNAL bool de_hashmap_next(const de_hashmap *const _map,
+                                                   usize *const _iter,
+                                                   u0 **const _key,
+                                                   u0 **const _value) {
+  for (usize i = *_iter; i < _map->capacity; ++i) {
+    if (_map->ctrl[i] == DE_C_HMAP_CTRL_EMPTY)
+      continue;
+    u8 *slot = DE_C_HMAP_slot(_map, i);
+    if (_key)
+      *_key = (u0 *)slot;
+    if (_value)
+      *_value = (u0 *)(slot + _map->value_offset);
+    *_iter = i + 1;
+    return true;
+  }
+  *_iter = _map->capacity;
+  return false;
+}
+
+/* wyhash style mixing of 8 byte words, finished with a murmur3 fmix64 */
+DE_CONTAINER_HASHMAP_INTERNAL u64 DE_C_HMAP_mix(u64 _a, u64 _b) {
+  const __uint128_t r = (__uint128_t)_a * _b;
+  return (u64)r ^ (u64)(r >> 64);
+}
+
+DE_CONTAINER_HASHMAP_INTERNAL u64 de_hashmap_hash_bytes(const u0 *_key,
+                                                        usize _key_size) {
+  const u8 *p = (const u8 *)_key;
+  u64 h = 0x9E3779B97F4A7C15ull ^ (u64)_key_size;
+  while (_key_size >= 8) {
+    u64 word;
+    DE_C_HMAP_MEMCPY(&word, p, 8);
+    h = DE_C_HMAP_mix(h ^ word, 0xBF58476D1CE4E5B9ull);
+    p += 8;
+    _key_size -= 8;
+  }
+  if (_key_size) {
+    u64 word = 0;
+    DE_C_HMAP_MEMCPY(&word, p, _key_size);
+    h = DE_C_HMAP_mix(h ^ word, 0x94D049BB133111EBull);
+  }
+  h ^= h >> 33;
+  h *= 0xFF51AFD7ED558CCDull;
+  h ^= h >> 33;
+  return h;
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif
+#endif
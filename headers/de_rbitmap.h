@@ -0,0 +1,1324 @@
+#ifndef DE_CONTAINER_RBITMAP_HEADER
+#define DE_CONTAINER_RBITMAP_HEADER
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+to get function definitions #define DE_CONTAINER_RBITMAP_IMPLEMENTATION before
+any #include. the de_bvec conversions read and build the de_bvec struct
+directly, no other IMPLEMENTATION define is needed
+
+compressed bitmap of u32 values (roaring layout): the upper 16 bits of a value
+select a chunk, a sorted key array holds one container per non empty chunk and
+the container stores the lower 16 bits as one of
+  array   sorted u16 values, up to 4096 of them (2 bytes per value)
+  bitmap  1024 u64 words, more than 4096 values (8 KB flat)
+  run     sorted (start, last) u16 pairs (4 bytes per run)
+inserts and removes switch between array and bitmap at 4096 values. runs come
+from de_rbitmap_add_range and de_rbitmap_optimize, a run container that gets
+single values inserted or removed goes back to array / bitmap.
+
+and / or / andnot / xor work chunk by chunk with one routine per container
+pair: merges (galloping for lopsided intersections) for arrays, word loops for
+bitmaps, interval merges for run and run, and the smaller of array / bitmap
+for a run against anything else. results are stored in the smallest of
+array / bitmap (and run for run results).
+*/
+
+/* clang-format off */
+/* possible options to set before 'first' include and IMPLEMENTATION */
+#ifndef DE_CONTAINER_RBITMAP_OPTIONS
+#ifdef DE_CONTAINER_RBITMAP_OPTIONS
+/* if defined removes assert checks */
+#define DE_OPTIONS_RBITMAP_NO_SAFETY_ASSERTS
+
+#define DE_OPTIONS_RBITMAP_DATA_PTR_REALLOC_FUNCTION defaults to realloc from stdlib
+#define DE_OPTIONS_RBITMAP_DATA_PTR_FREE_FUNCTION defaults to free
+#endif
+#endif
+
+#ifdef DE_CONTAINER_RBITMAP_IMPLEMENTATION
+#define DE_CONTAINER_RBITMAP_API
+#else
+#define DE_CONTAINER_RBITMAP_API extern
+#endif
+#define DE_CONTAINER_RBITMAP_INTERNAL
+
+/* declarations */
+#include <common.h>
+#include <stdbool.h>
+#include <de_bitmask.h>
+
+typedef enum {
+  DE_RBITMAP_ARRAY,
+  DE_RBITMAP_BITMAP,
+  DE_RBITMAP_RUN
+} de_rbitmap_container_type;
+
+/* inclusive range of set values inside a chunk */
+typedef struct {
+  u16 start;
+  u16 last;
+} de_rbitmap_run;
+
+typedef struct {
+  u0* data;        /* u16 values, 1024 u64 words or de_rbitmap_run pairs */
+  u32 size;        /* values, words (1024) or runs */
+  u32 capacity;    /* allocated values, words or runs */
+  u32 cardinality;
+  u8  type;        /* de_rbitmap_container_type */
+} de_rbitmap_container;
+
+typedef struct {
+  u16*                  keys;       /* sorted upper 16 bits of each chunk */
+  de_rbitmap_container* containers;
+  usize                 size;
+  usize                 capacity;
+} de_rbitmap;
+
+/* ascending iteration, .value holds the current value after next returned true */
+typedef struct {
+  const de_rbitmap* map;
+  usize             container;
+  u32               pos;
+  u32               run_value;
+  u64               word;
+  u32               value;
+} de_rbitmap_iter;
+
+/*
+  constructors
+*/
+
+/* returns an empty bitmap, nothing is allocated */
+DE_CONTAINER_RBITMAP_API de_rbitmap
+de_rbitmap_create(
+  u0
+);
+
+/* removes all values and frees the containers, keeps the key arrays */
+DE_CONTAINER_RBITMAP_API u0
+de_rbitmap_clear(
+  de_rbitmap *const       _map
+);
+
+/* delete entire bitmap */
+DE_CONTAINER_RBITMAP_API u0
+de_rbitmap_delete(
+  de_rbitmap *const       _map
+);
+
+/* deep copies _src into _dst, previous contents of _dst are freed */
+DE_CONTAINER_RBITMAP_API u0
+de_rbitmap_copy(
+  de_rbitmap *const       _dst,
+  const de_rbitmap *const _src
+);
+
+/*
+  single values
+*/
+
+/* returns true if _value was not present */
+DE_CONTAINER_RBITMAP_API bool
+de_rbitmap_add(
+  de_rbitmap *const       _map,
+  const u32               _value
+);
+
+/* adds every value of [_start, _last], whole chunks become single runs */
+DE_CONTAINER_RBITMAP_API u0
+de_rbitmap_add_range(
+  de_rbitmap *const       _map,
+  const u32               _start,
+  const u32               _last
+);
+
+/* returns true if _value was present */
+DE_CONTAINER_RBITMAP_API bool
+de_rbitmap_remove(
+  de_rbitmap *const       _map,
+  const u32               _value
+);
+
+DE_CONTAINER_RBITMAP_API bool
+de_rbitmap_contains(
+  const de_rbitmap *const _map,
+  const u32               _value
+);
+
+/*
+  set operations, _dst op= _src
+*/
+
+DE_CONTAINER_RBITMAP_API u0
+de_rbitmap_and(
+  de_rbitmap *const       _dst,
+  const de_rbitmap *const _src
+);
+
+DE_CONTAINER_RBITMAP_API u0
+de_rbitmap_or(
+  de_rbitmap *const       _dst,
+  const de_rbitmap *const _src
+);
+
+/* removes the values of _src from _dst */
+DE_CONTAINER_RBITMAP_API u0
+de_rbitmap_andnot(
+  de_rbitmap *const       _dst,
+  const de_rbitmap *const _src
+);
+
+DE_CONTAINER_RBITMAP_API u0
+de_rbitmap_xor(
+  de_rbitmap *const       _dst,
+  const de_rbitmap *const _src
+);
+
+/* converts array and bitmap containers to runs where that is smaller */
+DE_CONTAINER_RBITMAP_API u0
+de_rbitmap_optimize(
+  de_rbitmap *const       _map
+);
+
+/*
+  info
+*/
+
+/* number of values */
+DE_CONTAINER_RBITMAP_API usize
+de_rbitmap_info_cardinality(
+  const de_rbitmap *const _map
+);
+
+DE_CONTAINER_RBITMAP_API bool
+de_rbitmap_info_empty(
+  const de_rbitmap *const _map
+);
+
+/* largest value, 0 for an empty bitmap */
+DE_CONTAINER_RBITMAP_API u32
+de_rbitmap_info_max(
+  const de_rbitmap *const _map
+);
+
+/* bytes held by the bitmap */
+DE_CONTAINER_RBITMAP_API usize
+de_rbitmap_info_memory(
+  const de_rbitmap *const _map
+);
+
+/*
+  iteration and conversion
+*/
+
+DE_CONTAINER_RBITMAP_API de_rbitmap_iter
+de_rbitmap_iter_create(
+  const de_rbitmap *const _map
+);
+
+/* advances to the next value (stored in _it->value), false at the end */
+DE_CONTAINER_RBITMAP_API bool
+de_rbitmap_iter_next(
+  de_rbitmap_iter *const  _it
+);
+
+/* writes all values in ascending order to _out (room for info_cardinality values),
+   returns the amount written */
+DE_CONTAINER_RBITMAP_API usize
+de_rbitmap_to_array(
+  const de_rbitmap *const _map,
+  u32 *const              _out
+);
+
+/* every set bit of _msk becomes a value, _msk may hold at most 2^32 bits */
+DE_CONTAINER_RBITMAP_API de_rbitmap
+de_rbitmap_from_bvec(
+  const de_bvec *const    _msk
+);
+
+/* returns a new de_bvec of _bits_amount bits (0 picks max + 1) with the values set.
+   all values have to be < _bits_amount */
+DE_CONTAINER_RBITMAP_API de_bvec
+de_rbitmap_to_bvec(
+  const de_rbitmap *const _map,
+  const usize             _bits_amount
+);
+
+/* iterates _it (de_rbitmap_iter, declared by the macro) over the values, read _it.value.
+   _map must not be changed inside the loop */
+#define DE_RBITMAP_FOR_EACH(_it, _map)                                         \
+  for (de_rbitmap_iter _it = de_rbitmap_iter_create(_map);                     \
+       de_rbitmap_iter_next(&_it);)
+
+/* clang-format on */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif
+
+// #define DE_CONTAINER_RBITMAP_IMPLEMENTATION_DEVELOPMENT
+#if defined(DE_CONTAINER_RBITMAP_IMPLEMENTATION) ||                            \
+    defined(DE_CONTAINER_RBITMAP_IMPLEMENTATION_DEVELOPMENT)
+#ifndef DE_CONTAINER_RBITMAP_IMPLEMENTATION_INTERNAL
+#define DE_CONTAINER_RBITMAP_IMPLEMENTATION_INTERNAL
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* implementations */
+#include <assert.h>
+#include <common.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* macro defines */
+#ifndef DE_OPTIONS_RBITMAP_DATA_PTR_REALLOC_FUNCTION
+#define DE_OPTIONS_RBITMAP_DATA_PTR_REALLOC_FUNCTION realloc
+#endif
+
+#ifndef DE_OPTIONS_RBITMAP_DATA_PTR_FREE_FUNCTION
+#define DE_OPTIONS_RBITMAP_DATA_PTR_FREE_FUNCTION free
+#endif
+
+#define DE_C_RBMP_D_REALLOC DE_OPTIONS_RBITMAP_DATA_PTR_REALLOC_FUNCTION
+#define DE_C_RBMP_D_FREE DE_OPTIONS_RBITMAP_DATA_PTR_FREE_FUNCTION
+
+#define DE_C_RBMP_ASSERT assert
+
+#define DE_C_RBMP_ARRAY_MAX 4096 /* more values than this go to a bitmap */
+#define DE_C_RBMP_WORDS 1024     /* u64 words of a bitmap container */
+#define DE_C_RBMP_BITMAP_BYTES (DE_C_RBMP_WORDS * sizeof(u64))
+
+typedef enum {
+  DE_C_RBMP_AND,
+  DE_C_RBMP_OR,
+  DE_C_RBMP_ANDNOT,
+  DE_C_RBMP_XOR
+} DE_C_RBMP_op;
+
+/*
+  container helpers
+*/
+
+DE_CONTAINER_RBITMAP_INTERNAL u0 *DE_C_RBMP_realloc(u0 *_ptr, usize _bytes) {
+  u0 *out = DE_C_RBMP_D_REALLOC(_ptr, _bytes ? _bytes : 1);
+  DE_C_RBMP_ASSERT(out && "out of memory");
+  return out;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL usize DE_C_RBMP_unit(const u8 _type) {
+  return _type == DE_RBITMAP_ARRAY    ? sizeof(u16)
+         : _type == DE_RBITMAP_BITMAP ? sizeof(u64)
+                                      : sizeof(de_rbitmap_run);
+}
+
+/* empty container, bitmaps come zeroed with size 1024 */
+DE_CONTAINER_RBITMAP_INTERNAL de_rbitmap_container
+DE_C_RBMP_make(const u8 _type, u32 _capacity) {
+  de_rbitmap_container c = {0};
+  c.type = _type;
+  if (_type == DE_RBITMAP_BITMAP) {
+    _capacity = DE_C_RBMP_WORDS;
+    c.size = DE_C_RBMP_WORDS;
+  }
+  c.capacity = _capacity;
+  c.data = DE_C_RBMP_realloc(NULL, _capacity * DE_C_RBMP_unit(_type));
+  if (_type == DE_RBITMAP_BITMAP)
+    memset(c.data, 0, DE_C_RBMP_BITMAP_BYTES);
+  return c;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL u0 DE_C_RBMP_free(de_rbitmap_container *_c) {
+  DE_C_RBMP_D_FREE(_c->data);
+  _c->data = NULL;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL de_rbitmap_container
+DE_C_RBMP_clone(const de_rbitmap_container *_c) {
+  de_rbitmap_container out = *_c;
+  out.capacity = _c->size ? _c->size : 1;
+  out.data = DE_C_RBMP_realloc(NULL, out.capacity * DE_C_RBMP_unit(_c->type));
+  memcpy(out.data, _c->data, _c->size * DE_C_RBMP_unit(_c->type));
+  return out;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL u0 DE_C_RBMP_reserve(de_rbitmap_container *_c,
+                                                   u32 _amount) {
+  if (_amount <= _c->capacity)
+    return;
+  u32 cap = _c->capacity * 2;
+  if (cap < _amount)
+    cap = _amount;
+  _c->data = DE_C_RBMP_realloc(_c->data, cap * DE_C_RBMP_unit(_c->type));
+  _c->capacity = cap;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL u0 DE_C_RBMP_words_set_range(u64 *_words,
+                                                           usize _start,
+                                                           usize _last) {
+  const usize first = _start / 64, end = _last / 64;
+  const u64 head = ~(u64)0 << (_start % 64);
+  const u64 tail = ~(u64)0 >> (63 - _last % 64);
+  if (first == end) {
+    _words[first] |= head & tail;
+    return;
+  }
+  _words[first] |= head;
+  for (usize w = first + 1; w < end; ++w)
+    _words[w] = ~(u64)0;
+  _words[end] |= tail;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL u32 DE_C_RBMP_words_count(const u64 *_words) {
+  u32 out = 0;
+  for (usize w = 0; w < DE_C_RBMP_WORDS; ++w)
+    out += (u32)__builtin_popcountll(_words[w]);
+  return out;
+}
+
+/* lower bound of _v in a sorted u16 array */
+DE_CONTAINER_RBITMAP_INTERNAL u32 DE_C_RBMP_lower(const u16 *_a, u32 _n,
+                                                  u16 _v) {
+  u32 lo = 0;
+  while (_n) {
+    const u32 half = _n / 2;
+    if (_a[lo + half] < _v) {
+      lo += half + 1;
+      _n -= half + 1;
+    } else {
+      _n = half;
+    }
+  }
+  return lo;
+}
+
+/* index of the last run with start <= _v, -1 if none */
+DE_CONTAINER_RBITMAP_INTERNAL i64 DE_C_RBMP_run_find(const de_rbitmap_run *_r,
+                                                     u32 _n, u16 _v) {
+  i64 lo = 0, hi = (i64)_n - 1, out = -1;
+  while (lo <= hi) {
+    const i64 mid = lo + (hi - lo) / 2;
+    if (_r[mid].start <= _v) {
+      out = mid;
+      lo = mid + 1;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  return out;
+}
+
+/*
+  conversions
+*/
+
+DE_CONTAINER_RBITMAP_INTERNAL de_rbitmap_container
+DE_C_RBMP_array_to_bitmap(const de_rbitmap_container *_c) {
+  de_rbitmap_container out = DE_C_RBMP_make(DE_RBITMAP_BITMAP, 0);
+  u64 *const words = (u64 *)out.data;
+  const u16 *const values = (const u16 *)_c->data;
+  for (u32 i = 0; i < _c->size; ++i)
+    words[values[i] >> 6] |= (u64)1 << (values[i] & 63);
+  out.cardinality = _c->cardinality;
+  return out;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL de_rbitmap_container
+DE_C_RBMP_bitmap_to_array(const de_rbitmap_container *_c) {
+  de_rbitmap_container out =
+      DE_C_RBMP_make(DE_RBITMAP_ARRAY, _c->cardinality ? _c->cardinality : 1);
+  const u64 *const words = (const u64 *)_c->data;
+  u16 *o = (u16 *)out.data;
+  for (u32 w = 0; w < DE_C_RBMP_WORDS; ++w)
+    for (u64 bits = words[w]; bits; bits &= bits - 1)
+      *o++ = (u16)(w * 64 + (u32)__builtin_ctzll(bits));
+  out.size = out.cardinality = _c->cardinality;
+  return out;
+}
+
+/* a run container as array (<= 4096 values) or bitmap */
+DE_CONTAINER_RBITMAP_INTERNAL de_rbitmap_container
+DE_C_RBMP_run_materialize(const de_rbitmap_container *_c) {
+  const de_rbitmap_run *const runs = (const de_rbitmap_run *)_c->data;
+  de_rbitmap_container out;
+  if (_c->cardinality <= DE_C_RBMP_ARRAY_MAX) {
+    out = DE_C_RBMP_make(DE_RBITMAP_ARRAY, _c->cardinality ? _c->cardinality : 1);
+    u16 *o = (u16 *)out.data;
+    for (u32 r = 0; r < _c->size; ++r)
+      for (u32 v = runs[r].start; v <= runs[r].last; ++v)
+        *o++ = (u16)v;
+    out.size = _c->cardinality;
+  } else {
+    out = DE_C_RBMP_make(DE_RBITMAP_BITMAP, 0);
+    for (u32 r = 0; r < _c->size; ++r)
+      DE_C_RBMP_words_set_range((u64 *)out.data, runs[r].start, runs[r].last);
+  }
+  out.cardinality = _c->cardinality;
+  return out;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL u32
+DE_C_RBMP_count_runs(const de_rbitmap_container *_c) {
+  if (_c->type == DE_RBITMAP_RUN)
+    return _c->size;
+  if (_c->type == DE_RBITMAP_ARRAY) {
+    const u16 *const v = (const u16 *)_c->data;
+    u32 out = _c->size ? 1 : 0;
+    for (u32 i = 1; i < _c->size; ++i)
+      out += v[i] != (u16)(v[i - 1] + 1);
+    return out;
+  }
+  /* a run starts at every 1 bit whose lower neighbour is 0 */
+  const u64 *const words = (const u64 *)_c->data;
+  u32 out = 0;
+  u64 carry = 0;
+  for (u32 w = 0; w < DE_C_RBMP_WORDS; ++w) {
+    out += (u32)__builtin_popcountll(words[w] & ~((words[w] << 1) | carry));
+    carry = words[w] >> 63;
+  }
+  return out;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL de_rbitmap_container
+DE_C_RBMP_to_runs(const de_rbitmap_container *_c, u32 _runs) {
+  de_rbitmap_container out =
+      DE_C_RBMP_make(DE_RBITMAP_RUN, _runs ? _runs : 1);
+  de_rbitmap_run *r = (de_rbitmap_run *)out.data;
+  if (_c->type == DE_RBITMAP_ARRAY) {
+    const u16 *const v = (const u16 *)_c->data;
+    for (u32 i = 0; i < _c->size;) {
+      u32 j = i;
+      while (j + 1 < _c->size && v[j + 1] == (u16)(v[j] + 1))
+        ++j;
+      *r++ = (de_rbitmap_run){v[i], v[j]};
+      i = j + 1;
+    }
+  } else {
+    const u64 *const words = (const u64 *)_c->data;
+    u32 w = 0;
+    u64 cur = words[0];
+    for (;;) {
+      while (!cur && ++w < DE_C_RBMP_WORDS)
+        cur = words[w];
+      if (w == DE_C_RBMP_WORDS)
+        break;
+      const u32 start = w * 64 + (u32)__builtin_ctzll(cur);
+      /* fill the bits below the run start, then look for the first 0 */
+      cur |= cur - 1;
+      while (cur == ~(u64)0 && ++w < DE_C_RBMP_WORDS)
+        cur = words[w];
+      u32 last;
+      if (w == DE_C_RBMP_WORDS) {
+        last = DE_C_RBMP_WORDS * 64 - 1;
+      } else {
+        last = w * 64 + (u32)__builtin_ctzll(~cur) - 1;
+        cur &= cur + 1;
+      }
+      *r++ = (de_rbitmap_run){(u16)start, (u16)last};
+      if (w == DE_C_RBMP_WORDS)
+        break;
+    }
+  }
+  out.size = (u32)(r - (de_rbitmap_run *)out.data);
+  out.cardinality = _c->cardinality;
+  return out;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL usize
+DE_C_RBMP_bytes(const u8 _type, const u32 _cardinality, const u32 _runs) {
+  return _type == DE_RBITMAP_ARRAY    ? _cardinality * sizeof(u16)
+         : _type == DE_RBITMAP_BITMAP ? DE_C_RBMP_BITMAP_BYTES
+                                      : _runs * sizeof(de_rbitmap_run);
+}
+
+/* moves _c into the smallest of array / bitmap, run containers stay runs
+   while they are smaller than both */
+DE_CONTAINER_RBITMAP_INTERNAL u0
+DE_C_RBMP_normalize(de_rbitmap_container *_c) {
+  de_rbitmap_container out;
+  if (_c->type == DE_RBITMAP_BITMAP && _c->cardinality <= DE_C_RBMP_ARRAY_MAX) {
+    out = DE_C_RBMP_bitmap_to_array(_c);
+  } else if (_c->type == DE_RBITMAP_ARRAY &&
+             _c->cardinality > DE_C_RBMP_ARRAY_MAX) {
+    out = DE_C_RBMP_array_to_bitmap(_c);
+  } else if (_c->type == DE_RBITMAP_RUN &&
+             _c->size * sizeof(de_rbitmap_run) >=
+                 (_c->cardinality <= DE_C_RBMP_ARRAY_MAX
+                      ? _c->cardinality * sizeof(u16)
+                      : DE_C_RBMP_BITMAP_BYTES)) {
+    out = DE_C_RBMP_run_materialize(_c);
+  } else {
+    return;
+  }
+  DE_C_RBMP_free(_c);
+  *_c = out;
+}
+
+/*
+  single value container ops
+*/
+
+DE_CONTAINER_RBITMAP_INTERNAL bool
+DE_C_RBMP_contains(const de_rbitmap_container *_c, u16 _v) {
+  if (_c->type == DE_RBITMAP_ARRAY) {
+    const u16 *const v = (const u16 *)_c->data;
+    const u32 i = DE_C_RBMP_lower(v, _c->size, _v);
+    return i < _c->size && v[i] == _v;
+  }
+  if (_c->type == DE_RBITMAP_BITMAP)
+    return (((const u64 *)_c->data)[_v >> 6] >> (_v & 63)) & 1;
+  const de_rbitmap_run *const r = (const de_rbitmap_run *)_c->data;
+  const i64 i = DE_C_RBMP_run_find(r, _c->size, _v);
+  return i >= 0 && r[i].last >= _v;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL bool DE_C_RBMP_add(de_rbitmap_container *_c,
+                                                 u16 _v) {
+  if (_c->type == DE_RBITMAP_RUN) {
+    if (DE_C_RBMP_contains(_c, _v))
+      return false;
+    de_rbitmap_container out = DE_C_RBMP_run_materialize(_c);
+    DE_C_RBMP_free(_c);
+    *_c = out;
+  }
+  if (_c->type == DE_RBITMAP_ARRAY) {
+    u16 *v = (u16 *)_c->data;
+    const u32 i = DE_C_RBMP_lower(v, _c->size, _v);
+    if (i < _c->size && v[i] == _v)
+      return false;
+    if (_c->size == DE_C_RBMP_ARRAY_MAX) {
+      de_rbitmap_container out = DE_C_RBMP_array_to_bitmap(_c);
+      DE_C_RBMP_free(_c);
+      *_c = out;
+    } else {
+      DE_C_RBMP_reserve(_c, _c->size + 1);
+      v = (u16 *)_c->data;
+      memmove(v + i + 1, v + i, (_c->size - i) * sizeof(u16));
+      v[i] = _v;
+      ++_c->size;
+      ++_c->cardinality;
+      return true;
+    }
+  }
+  u64 *const w = (u64 *)_c->data + (_v >> 6);
+  const u64 bit = (u64)1 << (_v & 63);
+  if (*w & bit)
+    return false;
+  *w |= bit;
+  ++_c->cardinality;
+  return true;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL bool DE_C_RBMP_remove(de_rbitmap_container *_c,
+                                                    u16 _v) {
+  if (!DE_C_RBMP_contains(_c, _v))
+    return false;
+  if (_c->type == DE_RBITMAP_RUN) {
+    de_rbitmap_container out = DE_C_RBMP_run_materialize(_c);
+    DE_C_RBMP_free(_c);
+    *_c = out;
+  }
+  if (_c->type == DE_RBITMAP_ARRAY) {
+    u16 *const v = (u16 *)_c->data;
+    const u32 i = DE_C_RBMP_lower(v, _c->size, _v);
+    memmove(v + i, v + i + 1, (_c->size - i - 1) * sizeof(u16));
+    --_c->size;
+  } else {
+    ((u64 *)_c->data)[_v >> 6] &= ~((u64)1 << (_v & 63));
+  }
+  --_c->cardinality;
+  DE_C_RBMP_normalize(_c);
+  return true;
+}
+
+/*
+  container pair ops
+*/
+
+/* first index >= _from with _a[index] >= _v, exponential then binary search */
+DE_CONTAINER_RBITMAP_INTERNAL u32 DE_C_RBMP_gallop(const u16 *_a, u32 _n,
+                                                   u32 _from, u16 _v) {
+  u32 step = 1, hi = _from;
+  while (hi < _n && _a[hi] < _v) {
+    _from = hi + 1;
+    hi += step;
+    step *= 2;
+  }
+  if (hi > _n)
+    hi = _n;
+  return _from + DE_C_RBMP_lower(_a + _from, hi - _from, _v);
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL de_rbitmap_container
+DE_C_RBMP_array_array(const DE_C_RBMP_op _op, const de_rbitmap_container *_a,
+                      const de_rbitmap_container *_b);
+DE_CONTAINER_RBITMAP_INTERNAL de_rbitmap_container
+DE_C_RBMP_bitmap_bitmap(const DE_C_RBMP_op _op, const de_rbitmap_container *_a,
+                        const de_rbitmap_container *_b);
+
+DE_CONTAINER_RBITMAP_INTERNAL de_rbitmap_container
+DE_C_RBMP_array_array(const DE_C_RBMP_op _op, const de_rbitmap_container *_a,
+                      const de_rbitmap_container *_b) {
+  const u16 *const a = (const u16 *)_a->data;
+  const u16 *const b = (const u16 *)_b->data;
+  const u32 na = _a->size, nb = _b->size;
+  if ((_op == DE_C_RBMP_OR || _op == DE_C_RBMP_XOR) &&
+      na + nb > DE_C_RBMP_ARRAY_MAX) {
+    /* the result may not fit an array, go through bitmaps */
+    de_rbitmap_container ba = DE_C_RBMP_array_to_bitmap(_a);
+    de_rbitmap_container bb = DE_C_RBMP_array_to_bitmap(_b);
+    de_rbitmap_container out = DE_C_RBMP_bitmap_bitmap(_op, &ba, &bb);
+    DE_C_RBMP_free(&ba);
+    DE_C_RBMP_free(&bb);
+    return out;
+  }
+  const u32 cap = _op == DE_C_RBMP_AND      ? (na < nb ? na : nb)
+                  : _op == DE_C_RBMP_ANDNOT ? na
+                                            : na + nb;
+  de_rbitmap_container out = DE_C_RBMP_make(DE_RBITMAP_ARRAY, cap ? cap : 1);
+  u16 *o = (u16 *)out.data;
+  u32 i = 0, j = 0;
+  if (_op == DE_C_RBMP_AND && (na * 32 < nb || nb * 32 < na)) {
+    /* lopsided: gallop through the larger one */
+    const u16 *small = na < nb ? a : b, *large = na < nb ? b : a;
+    const u32 ns = na < nb ? na : nb, nl = na < nb ? nb : na;
+    for (; i < ns && j < nl; ++i) {
+      j = DE_C_RBMP_gallop(large, nl, j, small[i]);
+      if (j < nl && large[j] == small[i])
+        *o++ = small[i];
+    }
+  } else {
+    const bool keep_a = _op != DE_C_RBMP_AND;
+    const bool keep_b = _op == DE_C_RBMP_OR || _op == DE_C_RBMP_XOR;
+    const bool keep_both = _op == DE_C_RBMP_AND || _op == DE_C_RBMP_OR;
+    while (i < na && j < nb) {
+      if (a[i] < b[j]) {
+        if (keep_a)
+          *o++ = a[i];
+        ++i;
+      } else if (b[j] < a[i]) {
+        if (keep_b)
+          *o++ = b[j];
+        ++j;
+      } else {
+        if (keep_both)
+          *o++ = a[i];
+        ++i;
+        ++j;
+      }
+    }
+    if (keep_a)
+      for (; i < na; ++i)
+        *o++ = a[i];
+    if (keep_b)
+      for (; j < nb; ++j)
+        *o++ = b[j];
+  }
+  out.size = out.cardinality = (u32)(o - (u16 *)out.data);
+  return out;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL de_rbitmap_container
+DE_C_RBMP_bitmap_bitmap(const DE_C_RBMP_op _op, const de_rbitmap_container *_a,
+                        const de_rbitmap_container *_b) {
+  de_rbitmap_container out = DE_C_RBMP_make(DE_RBITMAP_BITMAP, 0);
+  const u64 *const a = (const u64 *)_a->data;
+  const u64 *const b = (const u64 *)_b->data;
+  u64 *const o = (u64 *)out.data;
+  u32 card = 0;
+#define DE_C_RBMP_WORD_LOOP(_expr)                                             \
+  for (u32 w = 0; w < DE_C_RBMP_WORDS; ++w) {                                  \
+    o[w] = (_expr);                                                            \
+    card += (u32)__builtin_popcountll(o[w]);                                   \
+  }
+  switch (_op) {
+  case DE_C_RBMP_AND:
+    DE_C_RBMP_WORD_LOOP(a[w] & b[w]);
+    break;
+  case DE_C_RBMP_OR:
+    DE_C_RBMP_WORD_LOOP(a[w] | b[w]);
+    break;
+  case DE_C_RBMP_ANDNOT:
+    DE_C_RBMP_WORD_LOOP(a[w] & ~b[w]);
+    break;
+  case DE_C_RBMP_XOR:
+    DE_C_RBMP_WORD_LOOP(a[w] ^ b[w]);
+    break;
+  }
+#undef DE_C_RBMP_WORD_LOOP
+  out.cardinality = card;
+  DE_C_RBMP_normalize(&out);
+  return out;
+}
+
+/* _arr op _bm, or _bm op _arr when _arr_right is set */
+DE_CONTAINER_RBITMAP_INTERNAL de_rbitmap_container
+DE_C_RBMP_array_bitmap(const DE_C_RBMP_op _op,
+                       const de_rbitmap_container *_arr,
+                       const de_rbitmap_container *_bm, const bool _arr_right) {
+  const u16 *const v = (const u16 *)_arr->data;
+  const u64 *const words = (const u64 *)_bm->data;
+  if (_op == DE_C_RBMP_AND || (_op == DE_C_RBMP_ANDNOT && !_arr_right)) {
+    /* filter the array by the bitmap */
+    const u64 want = _op == DE_C_RBMP_AND ? 1 : 0;
+    de_rbitmap_container out =
+        DE_C_RBMP_make(DE_RBITMAP_ARRAY, _arr->size ? _arr->size : 1);
+    u16 *o = (u16 *)out.data;
+    for (u32 i = 0; i < _arr->size; ++i) {
+      *o = v[i];
+      o += ((words[v[i] >> 6] >> (v[i] & 63)) & 1) == want;
+    }
+    out.size = out.cardinality = (u32)(o - (u16 *)out.data);
+    return out;
+  }
+  de_rbitmap_container out = DE_C_RBMP_clone(_bm);
+  u64 *const o = (u64 *)out.data;
+  i64 card = (i64)out.cardinality;
+  for (u32 i = 0; i < _arr->size; ++i) {
+    u64 *const w = o + (v[i] >> 6);
+    const u64 bit = (u64)1 << (v[i] & 63);
+    const i64 had = (*w & bit) != 0;
+    if (_op == DE_C_RBMP_OR) {
+      *w |= bit;
+      card += 1 - had;
+    } else if (_op == DE_C_RBMP_XOR) {
+      *w ^= bit;
+      card += 1 - 2 * had;
+    } else {
+      *w &= ~bit;
+      card -= had;
+    }
+  }
+  out.cardinality = (u32)card;
+  DE_C_RBMP_normalize(&out);
+  return out;
+}
+
+/* interval intersection / union of two run containers */
+DE_CONTAINER_RBITMAP_INTERNAL de_rbitmap_container
+DE_C_RBMP_run_run(const DE_C_RBMP_op _op, const de_rbitmap_container *_a,
+                  const de_rbitmap_container *_b) {
+  const de_rbitmap_run *const a = (const de_rbitmap_run *)_a->data;
+  const de_rbitmap_run *const b = (const de_rbitmap_run *)_b->data;
+  const u32 na = _a->size, nb = _b->size;
+  de_rbitmap_container out = DE_C_RBMP_make(
+      DE_RBITMAP_RUN, na + nb ? na + nb : 1);
+  de_rbitmap_run *o = (de_rbitmap_run *)out.data;
+  u32 card = 0, i = 0, j = 0;
+  if (_op == DE_C_RBMP_AND) {
+    while (i < na && j < nb) {
+      const u16 start = a[i].start > b[j].start ? a[i].start : b[j].start;
+      const u16 last = a[i].last < b[j].last ? a[i].last : b[j].last;
+      if (start <= last) {
+        *o++ = (de_rbitmap_run){start, last};
+        card += (u32)last - start + 1;
+      }
+      if (a[i].last < b[j].last)
+        ++i;
+      else
+        ++j;
+    }
+  } else {
+    while (i < na || j < nb) {
+      const de_rbitmap_run next =
+          (j == nb || (i < na && a[i].start <= b[j].start)) ? a[i++] : b[j++];
+      if (o != (de_rbitmap_run *)out.data &&
+          (u32)o[-1].last + 1 >= next.start) {
+        if (next.last > o[-1].last) {
+          card += (u32)next.last - o[-1].last;
+          o[-1].last = next.last;
+        }
+      } else {
+        *o++ = next;
+        card += (u32)next.last - next.start + 1;
+      }
+    }
+  }
+  out.size = (u32)(o - (de_rbitmap_run *)out.data);
+  out.cardinality = card;
+  DE_C_RBMP_normalize(&out);
+  return out;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL de_rbitmap_container
+DE_C_RBMP_container_op(const DE_C_RBMP_op _op, const de_rbitmap_container *_a,
+                       const de_rbitmap_container *_b) {
+  if (_a->type == DE_RBITMAP_RUN && _b->type == DE_RBITMAP_RUN &&
+      (_op == DE_C_RBMP_AND || _op == DE_C_RBMP_OR))
+    return DE_C_RBMP_run_run(_op, _a, _b);
+  /* a run against anything else: take its array / bitmap form */
+  de_rbitmap_container ta = {0}, tb = {0};
+  if (_a->type == DE_RBITMAP_RUN) {
+    ta = DE_C_RBMP_run_materialize(_a);
+    _a = &ta;
+  }
+  if (_b->type == DE_RBITMAP_RUN) {
+    tb = DE_C_RBMP_run_materialize(_b);
+    _b = &tb;
+  }
+  de_rbitmap_container out;
+  if (_a->type == DE_RBITMAP_ARRAY && _b->type == DE_RBITMAP_ARRAY)
+    out = DE_C_RBMP_array_array(_op, _a, _b);
+  else if (_a->type == DE_RBITMAP_BITMAP && _b->type == DE_RBITMAP_BITMAP)
+    out = DE_C_RBMP_bitmap_bitmap(_op, _a, _b);
+  else if (_a->type == DE_RBITMAP_ARRAY)
+    out = DE_C_RBMP_array_bitmap(_op, _a, _b, false);
+  else
+    out = DE_C_RBMP_array_bitmap(_op, _b, _a, true);
+  if (ta.data)
+    DE_C_RBMP_free(&ta);
+  if (tb.data)
+    DE_C_RBMP_free(&tb);
+  return out;
+}
+
+/*
+  key array helpers
+*/
+
+/* lower bound of _key in the sorted keys */
+DE_CONTAINER_RBITMAP_INTERNAL usize DE_C_RBMP_key_lower(const de_rbitmap *_map,
+                                                        u16 _key) {
+  usize lo = 0, n = _map->size;
+  while (n) {
+    const usize half = n / 2;
+    if (_map->keys[lo + half] < _key) {
+      lo += half + 1;
+      n -= half + 1;
+    } else {
+      n = half;
+    }
+  }
+  return lo;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL u0 DE_C_RBMP_insert_at(de_rbitmap *_map,
+                                                     usize _idx, u16 _key,
+                                                     de_rbitmap_container _c) {
+  if (_map->size == _map->capacity) {
+    const usize cap = _map->capacity ? _map->capacity * 2 : 4;
+    _map->keys = (u16 *)DE_C_RBMP_realloc(_map->keys, cap * sizeof(u16));
+    _map->containers = (de_rbitmap_container *)DE_C_RBMP_realloc(
+        _map->containers, cap * sizeof(de_rbitmap_container));
+    _map->capacity = cap;
+  }
+  memmove(_map->keys + _idx + 1, _map->keys + _idx,
+          (_map->size - _idx) * sizeof(u16));
+  memmove(_map->containers + _idx + 1, _map->containers + _idx,
+          (_map->size - _idx) * sizeof(de_rbitmap_container));
+  _map->keys[_idx] = _key;
+  _map->containers[_idx] = _c;
+  ++_map->size;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL u0 DE_C_RBMP_erase_at(de_rbitmap *_map,
+                                                    usize _idx) {
+  DE_C_RBMP_free(&_map->containers[_idx]);
+  memmove(_map->keys + _idx, _map->keys + _idx + 1,
+          (_map->size - _idx - 1) * sizeof(u16));
+  memmove(_map->containers + _idx, _map->containers + _idx + 1,
+          (_map->size - _idx - 1) * sizeof(de_rbitmap_container));
+  --_map->size;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL u0 DE_C_RBMP_push(de_rbitmap *_map, u16 _key,
+                                                de_rbitmap_container _c) {
+  DE_C_RBMP_insert_at(_map, _map->size, _key, _c);
+}
+
+/* chunk by chunk _a op _b into a new bitmap */
+DE_CONTAINER_RBITMAP_INTERNAL de_rbitmap DE_C_RBMP_combine(
+    const DE_C_RBMP_op _op, const de_rbitmap *_a, const de_rbitmap *_b) {
+  de_rbitmap out = de_rbitmap_create();
+  const bool keep_a = _op != DE_C_RBMP_AND;
+  const bool keep_b = _op == DE_C_RBMP_OR || _op == DE_C_RBMP_XOR;
+  usize i = 0, j = 0;
+  while (i < _a->size || j < _b->size) {
+    if (j == _b->size || (i < _a->size && _a->keys[i] < _b->keys[j])) {
+      if (!keep_a && j == _b->size)
+        break;
+      if (keep_a)
+        DE_C_RBMP_push(&out, _a->keys[i], DE_C_RBMP_clone(&_a->containers[i]));
+      ++i;
+    } else if (i == _a->size || _b->keys[j] < _a->keys[i]) {
+      if (!keep_b && i == _a->size)
+        break;
+      if (keep_b)
+        DE_C_RBMP_push(&out, _b->keys[j], DE_C_RBMP_clone(&_b->containers[j]));
+      ++j;
+    } else {
+      de_rbitmap_container c =
+          DE_C_RBMP_container_op(_op, &_a->containers[i], &_b->containers[j]);
+      if (c.cardinality)
+        DE_C_RBMP_push(&out, _a->keys[i], c);
+      else
+        DE_C_RBMP_free(&c);
+      ++i;
+      ++j;
+    }
+  }
+  return out;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL u0 DE_C_RBMP_assign(de_rbitmap *const _dst,
+                                                  de_rbitmap _src) {
+  de_rbitmap_delete(_dst);
+  *_dst = _src;
+}
+
+/*
+  constructors
+*/
+
+DE_CONTAINER_RBITMAP_INTERNAL de_rbitmap de_rbitmap_create(u0) {
+  return (de_rbitmap){NULL, NULL, 0, 0};
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL u0 de_rbitmap_clear(de_rbitmap *const _map) {
+  for (usize i = 0; i < _map->size; ++i)
+    DE_C_RBMP_free(&_map->containers[i]);
+  _map->size = 0;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL u0 de_rbitmap_delete(de_rbitmap *const _map) {
+  de_rbitmap_clear(_map);
+  DE_C_RBMP_D_FREE(_map->keys);
+  DE_C_RBMP_D_FREE(_map->containers);
+  *_map = de_rbitmap_create();
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL u0 de_rbitmap_copy(de_rbitmap *const _dst,
+                                                 const de_rbitmap *const _src) {
+  de_rbitmap out = de_rbitmap_create();
+  for (usize i = 0; i < _src->size; ++i)
+    DE_C_RBMP_push(&out, _src->keys[i], DE_C_RBMP_clone(&_src->containers[i]));
+  DE_C_RBMP_assign(_dst, out);
+}
+
+/*
+  single values
+*/
+
+DE_CONTAINER_RBITMAP_INTERNAL bool de_rbitmap_add(de_rbitmap *const _map,
+                                                  const u32 _value) {
+  const u16 key = (u16)(_value >> 16);
+  const usize i = DE_C_RBMP_key_lower(_map, key);
+  if (i == _map->size || _map->keys[i] != key)
+    DE_C_RBMP_insert_at(_map, i, key, DE_C_RBMP_make(DE_RBITMAP_ARRAY, 4));
+  return DE_C_RBMP_add(&_map->containers[i], (u16)_value);
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL u0 de_rbitmap_add_range(de_rbitmap *const _map,
+                                                      const u32 _start,
+                                                      const u32 _last) {
+#ifndef DE_OPTIONS_RBITMAP_NO_SAFETY_ASSERTS
+  DE_C_RBMP_ASSERT(_start <= _last && "empty range");
+#endif
+  for (u32 key = _start >> 16;; ++key) {
+    const u16 lo = key == _start >> 16 ? (u16)_start : 0;
+    const u16 hi = key == _last >> 16 ? (u16)_last : 0xffff;
+    de_rbitmap_container run = DE_C_RBMP_make(DE_RBITMAP_RUN, 1);
+    ((de_rbitmap_run *)run.data)[0] = (de_rbitmap_run){lo, hi};
+    run.size = 1;
+    run.cardinality = (u32)hi - lo + 1;
+    const usize i = DE_C_RBMP_key_lower(_map, (u16)key);
+    if (i == _map->size || _map->keys[i] != key) {
+      DE_C_RBMP_normalize(&run);
+      DE_C_RBMP_insert_at(_map, i, (u16)key, run);
+    } else {
+      de_rbitmap_container *const c = &_map->containers[i];
+      de_rbitmap_container merged = DE_C_RBMP_container_op(DE_C_RBMP_OR, c, &run);
+      DE_C_RBMP_free(c);
+      DE_C_RBMP_free(&run);
+      *c = merged;
+    }
+    if (key == _last >> 16)
+      break;
+  }
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL bool de_rbitmap_remove(de_rbitmap *const _map,
+                                                     const u32 _value) {
+  const u16 key = (u16)(_value >> 16);
+  const usize i = DE_C_RBMP_key_lower(_map, key);
+  if (i == _map->size || _map->keys[i] != key)
+    return false;
+  if (!DE_C_RBMP_remove(&_map->containers[i], (u16)_value))
+    return false;
+  if (_map->containers[i].cardinality == 0)
+    DE_C_RBMP_erase_at(_map, i);
+  return true;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL bool
+de_rbitmap_contains(const de_rbitmap *const _map, const u32 _value) {
+  const u16 key = (u16)(_value >> 16);
+  const usize i = DE_C_RBMP_key_lower(_map, key);
+  return i < _map->size && _map->keys[i] == key &&
+         DE_C_RBMP_contains(&_map->containers[i], (u16)_value);
+}
+
+/*
+  set operations
+*/
+
+DE_CONTAINER_RBITMAP_INTERNAL u0 de_rbitmap_and(de_rbitmap *const _dst,
+                                                const de_rbitmap *const _src) {
+  DE_C_RBMP_assign(_dst, DE_C_RBMP_combine(DE_C_RBMP_AND, _dst, _src));
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL u0 de_rbitmap_or(de_rbitmap *const _dst,
+                                               const de_rbitmap *const _src) {
+  DE_C_RBMP_assign(_dst, DE_C_RBMP_combine(DE_C_RBMP_OR, _dst, _src));
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL u0
+de_rbitmap_andnot(de_rbitmap *const _dst, const de_rbitmap *const _src) {
+  DE_C_RBMP_assign(_dst, DE_C_RBMP_combine(DE_C_RBMP_ANDNOT, _dst, _src));
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL u0 de_rbitmap_xor(de_rbitmap *const _dst,
+                                                const de_rbitmap *const _src) {
+  DE_C_RBMP_assign(_dst, DE_C_RBMP_combine(DE_C_RBMP_XOR, _dst, _src));
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL u0 de_rbitmap_optimize(de_rbitmap *const _map) {
+  for (usize i = 0; i < _map->size; ++i) {
+    de_rbitmap_container *const c = &_map->containers[i];
+    if (c->type == DE_RBITMAP_RUN)
+      continue;
+    const u32 runs = DE_C_RBMP_count_runs(c);
+    if (DE_C_RBMP_bytes(DE_RBITMAP_RUN, c->cardinality, runs) <
+        DE_C_RBMP_bytes(c->type, c->cardinality, runs)) {
+      de_rbitmap_container out = DE_C_RBMP_to_runs(c, runs);
+      DE_C_RBMP_free(c);
+      *c = out;
+    }
+  }
+}
+
+/*
+  info
+*/
+
+DE_CONTAINER_RBITMAP_INTERNAL usize
+de_rbitmap_info_cardinality(const de_rbitmap *const _map) {
+  usize out = 0;
+  for (usize i = 0; i < _map->size; ++i)
+    out += _map->containers[i].cardinality;
+  return out;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL bool
+de_rbitmap_info_empty(const de_rbitmap *const _map) {
+  return _map->size == 0;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL u32
+de_rbitmap_info_max(const de_rbitmap *const _map) {
+  if (_map->size == 0)
+    return 0;
+  const de_rbitmap_container *const c = &_map->containers[_map->size - 1];
+  const u32 high = (u32)_map->keys[_map->size - 1] << 16;
+  if (c->type == DE_RBITMAP_ARRAY)
+    return high | ((const u16 *)c->data)[c->size - 1];
+  if (c->type == DE_RBITMAP_RUN)
+    return high | ((const de_rbitmap_run *)c->data)[c->size - 1].last;
+  const u64 *const words = (const u64 *)c->data;
+  u32 w = DE_C_RBMP_WORDS - 1;
+  while (!words[w])
+    --w;
+  return high | (w * 64 + 63 - (u32)__builtin_clzll(words[w]));
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL usize
+de_rbitmap_info_memory(const de_rbitmap *const _map) {
+  usize out = _map->capacity * (sizeof(u16) + sizeof(de_rbitmap_container));
+  for (usize i = 0; i < _map->size; ++i)
+    out += _map->containers[i].capacity *
+           DE_C_RBMP_unit(_map->containers[i].type);
+  return out;
+}
+
+/*
+  iteration and conversion
+*/
+
+/* positions the iterator at the start of its current container */
+DE_CONTAINER_RBITMAP_INTERNAL u0 DE_C_RBMP_iter_enter(de_rbitmap_iter *_it) {
+  _it->pos = 0;
+  if (_it->container >= _it->map->size)
+    return;
+  const de_rbitmap_container *const c = &_it->map->containers[_it->container];
+  if (c->type == DE_RBITMAP_BITMAP)
+    _it->word = ((const u64 *)c->data)[0];
+  else if (c->type == DE_RBITMAP_RUN)
+    _it->run_value = ((const de_rbitmap_run *)c->data)[0].start;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL de_rbitmap_iter
+de_rbitmap_iter_create(const de_rbitmap *const _map) {
+  de_rbitmap_iter it = {0};
+  it.map = _map;
+  DE_C_RBMP_iter_enter(&it);
+  return it;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL bool
+de_rbitmap_iter_next(de_rbitmap_iter *const _it) {
+  for (; _it->container < _it->map->size;
+       ++_it->container, DE_C_RBMP_iter_enter(_it)) {
+    const de_rbitmap_container *const c =
+        &_it->map->containers[_it->container];
+    const u32 high = (u32)_it->map->keys[_it->container] << 16;
+    if (c->type == DE_RBITMAP_ARRAY) {
+      if (_it->pos < c->size) {
+        _it->value = high | ((const u16 *)c->data)[_it->pos++];
+        return true;
+      }
+    } else if (c->type == DE_RBITMAP_BITMAP) {
+      for (;;) {
+        if (_it->word) {
+          _it->value =
+              high | (_it->pos * 64 + (u32)__builtin_ctzll(_it->word));
+          _it->word &= _it->word - 1;
+          return true;
+        }
+        if (++_it->pos == DE_C_RBMP_WORDS)
+          break;
+        _it->word = ((const u64 *)c->data)[_it->pos];
+      }
+    } else if (_it->pos < c->size) {
+      const de_rbitmap_run *const r = (const de_rbitmap_run *)c->data;
+      _it->value = high | _it->run_value;
+      if (_it->run_value == r[_it->pos].last) {
+        if (++_it->pos < c->size)
+          _it->run_value = r[_it->pos].start;
+      } else {
+        ++_it->run_value;
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL usize
+de_rbitmap_to_array(const de_rbitmap *const _map, u32 *const _out) {
+  u32 *o = _out;
+  for (usize i = 0; i < _map->size; ++i) {
+    const de_rbitmap_container *const c = &_map->containers[i];
+    const u32 high = (u32)_map->keys[i] << 16;
+    if (c->type == DE_RBITMAP_ARRAY) {
+      const u16 *const v = (const u16 *)c->data;
+      for (u32 k = 0; k < c->size; ++k)
+        *o++ = high | v[k];
+    } else if (c->type == DE_RBITMAP_BITMAP) {
+      const u64 *const words = (const u64 *)c->data;
+      for (u32 w = 0; w < DE_C_RBMP_WORDS; ++w)
+        for (u64 bits = words[w]; bits; bits &= bits - 1)
+          *o++ = high | (w * 64 + (u32)__builtin_ctzll(bits));
+    } else {
+      const de_rbitmap_run *const r = (const de_rbitmap_run *)c->data;
+      for (u32 k = 0; k < c->size; ++k)
+        for (u32 v = r[k].start; v <= r[k].last; ++v)
+          *o++ = high | v;
+    }
+  }
+  return (usize)(o - _out);
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL de_rbitmap
+de_rbitmap_from_bvec(const de_bvec *const _msk) {
+  const usize bits = _msk->bits_amount;
+#ifndef DE_OPTIONS_RBITMAP_NO_SAFETY_ASSERTS
+  DE_C_RBMP_ASSERT(bits <= (usize)UINT32_MAX + 1 &&
+                   "bitmask larger than the u32 universe");
+#endif
+  const u64 *const words =
+      _msk->is_small ? &_msk->data.small : _msk->data.blocks;
+  const usize word_count = (bits + 63) / 64;
+  de_rbitmap out = de_rbitmap_create();
+  for (usize first = 0; first < word_count; first += DE_C_RBMP_WORDS) {
+    const usize n = word_count - first < DE_C_RBMP_WORDS ? word_count - first
+                                                         : DE_C_RBMP_WORDS;
+    /* the last word may hold stale bits past bits_amount */
+    u64 chunk_tail = words[first + n - 1];
+    if (first + n == word_count && bits % 64)
+      chunk_tail &= ((u64)1 << (bits % 64)) - 1;
+    u32 card = (u32)__builtin_popcountll(chunk_tail);
+    for (usize w = 0; w + 1 < n; ++w)
+      card += (u32)__builtin_popcountll(words[first + w]);
+    if (card == 0)
+      continue;
+    de_rbitmap_container c;
+    if (card > DE_C_RBMP_ARRAY_MAX) {
+      c = DE_C_RBMP_make(DE_RBITMAP_BITMAP, 0);
+      memcpy(c.data, words + first, (n - 1) * sizeof(u64));
+      ((u64 *)c.data)[n - 1] = chunk_tail;
+    } else {
+      c = DE_C_RBMP_make(DE_RBITMAP_ARRAY, card);
+      u16 *o = (u16 *)c.data;
+      for (usize w = 0; w < n; ++w)
+        for (u64 b = w + 1 < n ? words[first + w] : chunk_tail; b; b &= b - 1)
+          *o++ = (u16)(w * 64 + (usize)__builtin_ctzll(b));
+      c.size = card;
+    }
+    c.cardinality = card;
+    DE_C_RBMP_push(&out, (u16)(first / DE_C_RBMP_WORDS), c);
+  }
+  return out;
+}
+
+DE_CONTAINER_RBITMAP_INTERNAL de_bvec
+de_rbitmap_to_bvec(const de_rbitmap *const _map, const usize _bits_amount) {
+  const usize bits =
+      _bits_amount ? _bits_amount
+                   : (_map->size ? (usize)de_rbitmap_info_max(_map) + 1 : 0);
+#ifndef DE_OPTIONS_RBITMAP_NO_SAFETY_ASSERTS
+  DE_C_RBMP_ASSERT((!_map->size || de_rbitmap_info_max(_map) < bits) &&
+                   "values past the requested size");
+#endif
+  /* same shape de_bvec_create builds */
+  de_bvec out = {0};
+  out.bits_amount = bits;
+  out.last_block_bits_count = bits == 0 ? 0 : (bits % 64 ? bits % 64 : 64);
+  u64 *words;
+  if (bits <= 64) {
+    out.is_small = true;
+    words = &out.data.small;
+  } else {
+    out.block_count = (bits + 63) / 64;
+    out.data.blocks = (mblk_t *)calloc(out.block_count, sizeof(mblk_t));
+    words = out.data.blocks;
+  }
+  for (usize i = 0; i < _map->size; ++i) {
+    const de_rbitmap_container *const c = &_map->containers[i];
+    const usize base = (usize)_map->keys[i] << 16;
+    u64 *const chunk = words + base / 64;
+    if (c->type == DE_RBITMAP_ARRAY) {
+      const u16 *const v = (const u16 *)c->data;
+      for (u32 k = 0; k < c->size; ++k)
+        chunk[v[k] >> 6] |= (u64)1 << (v[k] & 63);
+    } else if (c->type == DE_RBITMAP_BITMAP) {
+      const usize left = (bits + 63) / 64 - base / 64;
+      memcpy(chunk, c->data,
+             (left < DE_C_RBMP_WORDS ? left : DE_C_RBMP_WORDS) * sizeof(u64));
+    } else {
+      const de_rbitmap_run *const r = (const de_rbitmap_run *)c->data;
+      for (u32 k = 0; k < c->size; ++k)
+        DE_C_RBMP_words_set_range(chunk, r[k].start, r[k].last);
+    }
+  }
+  return out;
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif
+#endif
@@ -0,0 +1,348 @@
+#ifndef DE_CONTAINER_SLOTMAP_HEADER
+#define DE_CONTAINER_SLOTMAP_HEADER
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+to get function definitions #define DE_CONTAINER_SLOTMAP_IMPLEMENTATION before
+any #include. the implementation uses de_vec and de_bvec, so
+DE_CONTAINER_VECTOR_IMPLEMENTATION and DE_CONTAINER_BITMASK_IMPLEMENTATION have
+to be defined in the same translation unit as well
+
+generational slot map: insert returns a handle (slot index + generation) that
+stays valid until exactly that element is removed. the values live densely
+packed in a de_vec (iterate over de_slotmap_values), removal moves the last
+value into the hole, the handles keep pointing at the right value through the
+slot table. removing bumps the generation of the slot, so stale handles are
+detected instead of aliasing a newer element. a zeroed handle is never valid
+
+IMPORTANT: pointers returned by get/insert go invalid once the map grows or an
+           element is removed, keep the handle and get again
+*/
+
+/* clang-format off */
+/* possible options to set before 'first' include and IMPLEMENTATION */
+#ifndef DE_CONTAINER_SLOTMAP_OPTIONS
+#ifdef DE_CONTAINER_SLOTMAP_OPTIONS
+/* if defined removes assert checks */
+#define DE_OPTIONS_SLOTMAP_NO_SAFETY_ASSERTS
+#endif
+#endif
+
+#ifdef DE_CONTAINER_SLOTMAP_IMPLEMENTATION
+#define DE_CONTAINER_SLOTMAP_API
+#else
+#define DE_CONTAINER_SLOTMAP_API extern
+#endif
+#define DE_CONTAINER_SLOTMAP_INTERNAL
+
+/* declarations */
+#include <common.h>
+#include <stdbool.h>
+#include <de_vector.h>
+#include <de_bitmask.h>
+
+typedef struct {
+  u32 index;      /* slot index */
+  u32 generation; /* 0 is never handed out */
+} de_slotmap_handle;
+
+typedef struct {
+  de_vec  values;     /* dense values, item_size bytes each */
+  de_vec  dense_slot; /* u32 slot index of each dense value */
+  de_vec  slots;      /* slot table (internal) */
+  de_bvec occupied;   /* bit per slot, set while it holds a value */
+  u32     free_head;  /* first free slot, chained through the slots */
+} de_slotmap;
+
+/*
+  constructors
+*/
+
+/* returns a slot map. _item_size in bytes */
+DE_CONTAINER_SLOTMAP_API de_slotmap
+de_slotmap_create(
+  const usize             _item_size
+);
+
+/* returns a slot map that holds _count values before growing */
+DE_CONTAINER_SLOTMAP_API de_slotmap
+de_slotmap_create_with_capacity(
+  const usize             _item_size,
+  const usize             _count
+);
+
+/* removes all values, every handle handed out so far becomes stale. keeps capacity */
+DE_CONTAINER_SLOTMAP_API u0
+de_slotmap_clear(
+  de_slotmap *const       _map
+);
+
+/* delete entire map */
+DE_CONTAINER_SLOTMAP_API u0
+de_slotmap_delete(
+  de_slotmap *const       _map
+);
+
+/*
+  Info getters
+*/
+
+/* current number of stored values */
+DE_CONTAINER_SLOTMAP_API usize
+de_slotmap_info_size(
+  const de_slotmap *const _map
+);
+
+DE_CONTAINER_SLOTMAP_API bool
+de_slotmap_info_empty(
+  const de_slotmap *const _map
+);
+
+/*
+  Access
+*/
+
+/* copies _value into the map, returns its handle. O(1) */
+DE_CONTAINER_SLOTMAP_API de_slotmap_handle
+de_slotmap_insert(
+  de_slotmap *const       _map,
+  const u0 *const         _value
+);
+
+/* inserts an uninitialized value, writes its handle to *_handle and returns its address */
+DE_CONTAINER_SLOTMAP_API u0*
+de_slotmap_emplace(
+  de_slotmap *const       _map,
+  de_slotmap_handle *const _handle
+);
+
+/* returns address of the value of _handle, NULL if the handle is stale. O(1) */
+DE_CONTAINER_SLOTMAP_API u0*
+de_slotmap_get(
+  const de_slotmap *const _map,
+  const de_slotmap_handle _handle
+);
+
+/* de_slotmap_get but with an automatic type* cast */
+#define de_slotmap_getA(type, _map, _handle) ((type*)de_slotmap_get(_map, _handle))
+
+DE_CONTAINER_SLOTMAP_API bool
+de_slotmap_contains(
+  const de_slotmap *const _map,
+  const de_slotmap_handle _handle
+);
+
+/* removes the value of _handle, returns false if the handle was stale. O(1) */
+DE_CONTAINER_SLOTMAP_API bool
+de_slotmap_remove(
+  de_slotmap *const       _map,
+  const de_slotmap_handle _handle
+);
+
+/*
+  iteration
+  the values are a plain de_vec: DE_VEC_FOR_EACH(T, it, de_slotmap_values(&map))
+*/
+
+#define de_slotmap_values(_map) (&(_map)->values)
+
+/* handle of the value at dense position _idx (< de_slotmap_info_size) */
+DE_CONTAINER_SLOTMAP_API de_slotmap_handle
+de_slotmap_handle_at(
+  const de_slotmap *const _map,
+  const usize             _idx
+);
+
+/* clang-format on */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif
+
+// #define DE_CONTAINER_SLOTMAP_IMPLEMENTATION_DEVELOPMENT
+#if defined(DE_CONTAINER_SLOTMAP_IMPLEMENTATION) ||                            \
+    defined(DE_CONTAINER_SLOTMAP_IMPLEMENTATION_DEVELOPMENT)
+#ifndef DE_CONTAINER_SLOTMAP_IMPLEMENTATION_INTERNAL
+#define DE_CONTAINER_SLOTMAP_IMPLEMENTATION_INTERNAL
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* implementations */
+#include <assert.h>
+#include <common.h>
+#include <string.h>
+
+/* macro defines */
+#define DE_C_SMAP_ASSERT assert
+/* end of the free list */
+#define DE_C_SMAP_NONE ((u32)0xffffffffu)
+
+/* a free slot stores the next free slot in dense */
+typedef struct {
+  u32 dense;
+  u32 generation;
+} DE_C_SMAP_slot;
+
+DE_CONTAINER_SLOTMAP_INTERNAL de_slotmap
+de_slotmap_create_with_capacity(const usize _item_size, const usize _count) {
+  return (de_slotmap){de_vec_create_with_capacity(_item_size, _count),
+                      de_vec_create_with_capacity(sizeof(u32), _count),
+                      de_vec_create_with_capacity(sizeof(DE_C_SMAP_slot), _count),
+                      de_bvec_create(_count), DE_C_SMAP_NONE};
+}
+
+DE_CONTAINER_SLOTMAP_INTERNAL de_slotmap
+de_slotmap_create(const usize _item_size) {
+  return de_slotmap_create_with_capacity(_item_size, 0);
+}
+
+DE_CONTAINER_SLOTMAP_INTERNAL u0 de_slotmap_clear(de_slotmap *const _map) {
+  DE_C_SMAP_slot *slots = (DE_C_SMAP_slot *)_map->slots.data;
+  const u32 *dense_slot = (const u32 *)_map->dense_slot.data;
+  /* only the occupied slots need a new generation and a free list entry */
+  for (usize i = 0; i < _map->dense_slot.used; ++i) {
+    DE_C_SMAP_slot *slot = slots + dense_slot[i];
+    if (++slot->generation == 0)
+      slot->generation = 1;
+    slot->dense = _map->free_head;
+    _map->free_head = dense_slot[i];
+  }
+  de_bvec_clear(&_map->occupied);
+  _map->values.used = 0;
+  _map->dense_slot.used = 0;
+}
+
+DE_CONTAINER_SLOTMAP_INTERNAL u0 de_slotmap_delete(de_slotmap *const _map) {
+  de_vec_delete(&_map->values);
+  de_vec_delete(&_map->dense_slot);
+  de_vec_delete(&_map->slots);
+  de_bvec_delete(&_map->occupied);
+  _map->free_head = DE_C_SMAP_NONE;
+}
+
+/*
+  Info getters
+*/
+
+DE_CONTAINER_SLOTMAP_INTERNAL usize
+de_slotmap_info_size(const de_slotmap *const _map) {
+  return _map->values.used;
+}
+
+DE_CONTAINER_SLOTMAP_INTERNAL bool
+de_slotmap_info_empty(const de_slotmap *const _map) {
+  return _map->values.used == 0;
+}
+
+/*
+  Access
+*/
+
+/* returns the slot of _handle if it is live, NULL otherwise */
+DE_CONTAINER_SLOTMAP_INTERNAL DE_C_SMAP_slot *
+DE_C_SMAP_lookup(const de_slotmap *const _map,
+                 const de_slotmap_handle _handle) {
+  if (_handle.index >= _map->slots.used ||
+      !de_bvec_get(&_map->occupied, _handle.index))
+    return NULL;
+  DE_C_SMAP_slot *slot = (DE_C_SMAP_slot *)_map->slots.data + _handle.index;
+  return slot->generation == _handle.generation ? slot : NULL;
+}
+
+DE_CONTAINER_SLOTMAP_INTERNAL u0 *
+de_slotmap_emplace(de_slotmap *const _map, de_slotmap_handle *const _handle) {
+  const usize dense = _map->values.used;
+  u32 index = _map->free_head;
+  DE_C_SMAP_slot *slot;
+  if (index != DE_C_SMAP_NONE) {
+    slot = (DE_C_SMAP_slot *)_map->slots.data + index;
+    _map->free_head = slot->dense;
+  } else {
+#ifndef DE_OPTIONS_SLOTMAP_NO_SAFETY_ASSERTS
+    DE_C_SMAP_ASSERT(_map->slots.used < DE_C_SMAP_NONE &&
+                     " slot map is limited to 2^32 - 1 slots");
+#endif
+    index = (u32)_map->slots.used;
+    const DE_C_SMAP_slot fresh = {0, 1};
+    de_vec_push_back(&_map->slots, &fresh);
+    slot = (DE_C_SMAP_slot *)_map->slots.data + index;
+    /* the bitmask follows the capacity of the slot table */
+    if (_map->slots.capacity > de_bvec_info_size(&_map->occupied))
+      de_bvec_resize(&_map->occupied, _map->slots.capacity);
+  }
+  slot->dense = (u32)dense;
+  de_bvec_set(&_map->occupied, index, true);
+  de_vec_push_back(&_map->dense_slot, &index);
+  de_vec_reserve(&_map->values, dense + 1);
+  ++_map->values.used;
+  *_handle = (de_slotmap_handle){index, slot->generation};
+  return _map->values.data + dense * _map->values.item_size;
+}
+
+DE_CONTAINER_SLOTMAP_INTERNAL de_slotmap_handle
+de_slotmap_insert(de_slotmap *const _map, const u0 *const _value) {
+  de_slotmap_handle out;
+  u0 *dst = de_slotmap_emplace(_map, &out);
+  memcpy(dst, _value, _map->values.item_size);
+  return out;
+}
+
+DE_CONTAINER_SLOTMAP_INTERNAL u0 *
+de_slotmap_get(const de_slotmap *const _map, const de_slotmap_handle _handle) {
+  const DE_C_SMAP_slot *slot = DE_C_SMAP_lookup(_map, _handle);
+  return slot ? _map->values.data + slot->dense * _map->values.item_size
+              : NULL;
+}
+
+DE_CONTAINER_SLOTMAP_INTERNAL bool
+de_slotmap_contains(const de_slotmap *const _map,
+                    const de_slotmap_handle _handle) {
+  return DE_C_SMAP_lookup(_map, _handle) != NULL;
+}
+
+DE_CONTAINER_SLOTMAP_INTERNAL bool
+de_slotmap_remove(de_slotmap *const _map, const de_slotmap_handle _handle) {
+  DE_C_SMAP_slot *slot = DE_C_SMAP_lookup(_map, _handle);
+  if (!slot)
+    return false;
+  const usize item_size = _map->values.item_size;
+  const u32 dense = slot->dense;
+  const u32 last = (u32)_map->values.used - 1;
+  u32 *dense_slot = (u32 *)_map->dense_slot.data;
+  if (dense != last) {
+    /* move the last value into the hole and repoint its slot */
+    memcpy(_map->values.data + (usize)dense * item_size,
+           _map->values.data + (usize)last * item_size, item_size);
+    dense_slot[dense] = dense_slot[last];
+    ((DE_C_SMAP_slot *)_map->slots.data)[dense_slot[dense]].dense = dense;
+  }
+  --_map->values.used;
+  --_map->dense_slot.used;
+
+  if (++slot->generation == 0)
+    slot->generation = 1;
+  slot->dense = _map->free_head;
+  _map->free_head = _handle.index;
+  de_bvec_set(&_map->occupied, _handle.index, false);
+  return true;
+}
+
+DE_CONTAINER_SLOTMAP_INTERNAL de_slotmap_handle
+de_slotmap_handle_at(const de_slotmap *const _map, const usize _idx) {
+#ifndef DE_OPTIONS_SLOTMAP_NO_SAFETY_ASSERTS
+  DE_C_SMAP_ASSERT(_idx < _map->values.used && " has to recieve a valid index");
+#endif
+  const u32 index = ((const u32 *)_map->dense_slot.data)[_idx];
+  return (de_slotmap_handle){
+      index, ((const DE_C_SMAP_slot *)_map->slots.data)[index].generation};
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif
+#endif
@@ -0,0 +1,357 @@
+#ifndef DE_CONTAINER_SPARSE_SET_HEADER
+#define DE_CONTAINER_SPARSE_SET_HEADER
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+to get function definitions #define DE_CONTAINER_SPARSE_SET_IMPLEMENTATION
+before any #include. the implementation uses de_vec and de_bvec, so
+DE_CONTAINER_VECTOR_IMPLEMENTATION and DE_CONTAINER_BITMASK_IMPLEMENTATION have
+to be defined in the same translation unit as well
+
+sparse set of u32 ids in [0, universe): the members are packed in a dense de_vec
+(iteration costs O(size), not O(universe)) and sparse[id] holds the position of
+id in it. an id is a member if dense[sparse[id]] == id, so the sparse array is
+never initialized and clear only resets the size.
+insert, erase, contains and clear are O(1). erase moves the last member into
+the hole, so the dense order is not stable
+
+IMPORTANT: the sparse array is read before it was written for ids that were
+           never inserted. that is intended, but memory checkers (valgrind,
+           msan) report it
+*/
+
+/* clang-format off */
+/* possible options to set before 'first' include and IMPLEMENTATION */
+#ifndef DE_CONTAINER_SPARSE_SET_OPTIONS
+#ifdef DE_CONTAINER_SPARSE_SET_OPTIONS
+/* if defined removes assert checks */
+#define DE_OPTIONS_SPARSE_SET_NO_SAFETY_ASSERTS
+
+#define DE_OPTIONS_SPARSE_SET_DATA_PTR_MALLOC_FUNCTION defaults to malloc from stdlib
+#define DE_OPTIONS_SPARSE_SET_DATA_PTR_FREE_FUNCTION defaults to free
+#endif
+#endif
+
+#ifdef DE_CONTAINER_SPARSE_SET_IMPLEMENTATION
+#define DE_CONTAINER_SPARSE_SET_API
+#else
+#define DE_CONTAINER_SPARSE_SET_API extern
+#endif
+#define DE_CONTAINER_SPARSE_SET_INTERNAL
+
+/* declarations */
+#include <common.h>
+#include <stdbool.h>
+#include <de_vector.h>
+#include <de_bitmask.h>
+
+typedef struct {
+  de_vec dense;    /* u32 members */
+  u32*   sparse;   /* position of each id in dense, only valid for members */
+  usize  universe; /* ids have to be < universe, grows on insert */
+} de_sparse_set;
+
+/*
+  constructors
+*/
+
+/* returns a set for ids in [0, _universe) */
+DE_CONTAINER_SPARSE_SET_API de_sparse_set
+de_sparse_set_create(
+  const usize                 _universe
+);
+
+/* removes all members in O(1) */
+DE_CONTAINER_SPARSE_SET_API u0
+de_sparse_set_clear(
+  de_sparse_set *const        _set
+);
+
+/* delete entire set */
+DE_CONTAINER_SPARSE_SET_API u0
+de_sparse_set_delete(
+  de_sparse_set *const        _set
+);
+
+/* grows the universe to at least _universe ids, will not shrink */
+DE_CONTAINER_SPARSE_SET_API u0
+de_sparse_set_reserve_universe(
+  de_sparse_set *const        _set,
+  const usize                 _universe
+);
+
+/*
+  Info getters
+*/
+
+/* current number of members */
+DE_CONTAINER_SPARSE_SET_API usize
+de_sparse_set_info_size(
+  const de_sparse_set *const  _set
+);
+
+DE_CONTAINER_SPARSE_SET_API usize
+de_sparse_set_info_universe(
+  const de_sparse_set *const  _set
+);
+
+DE_CONTAINER_SPARSE_SET_API bool
+de_sparse_set_info_empty(
+  const de_sparse_set *const  _set
+);
+
+/*
+  Access
+*/
+
+/* adds _id (grows the universe if needed), returns true if it was not a member yet */
+DE_CONTAINER_SPARSE_SET_API bool
+de_sparse_set_insert(
+  de_sparse_set *const        _set,
+  const u32                   _id
+);
+
+/* removes _id, returns true if it was a member */
+DE_CONTAINER_SPARSE_SET_API bool
+de_sparse_set_erase(
+  de_sparse_set *const        _set,
+  const u32                   _id
+);
+
+DE_CONTAINER_SPARSE_SET_API bool
+de_sparse_set_contains(
+  const de_sparse_set *const  _set,
+  const u32                   _id
+);
+
+/*
+  iteration
+  the members are a plain de_vec of u32: DE_VEC_FOR_EACH(u32, it, de_sparse_set_members(&set))
+  it must not be modified directly
+*/
+
+#define de_sparse_set_members(_set) (&(_set)->dense)
+
+/*
+  de_bvec interop
+  bit i of a mask stands for id i, ids beyond the mask size count as unset
+*/
+
+/* keeps only the members whose bit is set in _msk. O(size) */
+DE_CONTAINER_SPARSE_SET_API u0
+de_sparse_set_intersect_bvec(
+  de_sparse_set *const        _set,
+  const de_bvec *const        _msk
+);
+
+/* inserts the members of _set whose bit is set in _msk into _out (not cleared first) */
+DE_CONTAINER_SPARSE_SET_API u0
+de_sparse_set_intersect_bvec_into(
+  const de_sparse_set *const  _set,
+  const de_bvec *const        _msk,
+  de_sparse_set *const        _out
+);
+
+/* amount of members whose bit is set in _msk */
+DE_CONTAINER_SPARSE_SET_API usize
+de_sparse_set_count_intersect_bvec(
+  const de_sparse_set *const  _set,
+  const de_bvec *const        _msk
+);
+
+/* sets the bit of every member in _msk (has to hold the largest member) */
+DE_CONTAINER_SPARSE_SET_API u0
+de_sparse_set_to_bvec(
+  const de_sparse_set *const  _set,
+  de_bvec *const              _msk
+);
+
+/* clang-format on */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif
+
+// #define DE_CONTAINER_SPARSE_SET_IMPLEMENTATION_DEVELOPMENT
+#if defined(DE_CONTAINER_SPARSE_SET_IMPLEMENTATION) ||                         \
+    defined(DE_CONTAINER_SPARSE_SET_IMPLEMENTATION_DEVELOPMENT)
+#ifndef DE_CONTAINER_SPARSE_SET_IMPLEMENTATION_INTERNAL
+#define DE_CONTAINER_SPARSE_SET_IMPLEMENTATION_INTERNAL
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* implementations */
+#include <assert.h>
+#include <common.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* macro defines */
+#ifndef DE_OPTIONS_SPARSE_SET_DATA_PTR_MALLOC_FUNCTION
+#define DE_OPTIONS_SPARSE_SET_DATA_PTR_MALLOC_FUNCTION malloc
+#endif
+
+#ifndef DE_OPTIONS_SPARSE_SET_DATA_PTR_FREE_FUNCTION
+#define DE_OPTIONS_SPARSE_SET_DATA_PTR_FREE_FUNCTION free
+#endif
+
+#define DE_C_SSET_D_MALLOC DE_OPTIONS_SPARSE_SET_DATA_PTR_MALLOC_FUNCTION
+#define DE_C_SSET_D_FREE DE_OPTIONS_SPARSE_SET_DATA_PTR_FREE_FUNCTION
+#define DE_C_SSET_MEMCPY memcpy
+#define DE_C_SSET_ASSERT assert
+
+DE_CONTAINER_SPARSE_SET_INTERNAL de_sparse_set
+de_sparse_set_create(const usize _universe) {
+  const usize universe = _universe ? _universe : 1;
+  return (de_sparse_set){
+      de_vec_create(sizeof(u32)),
+      (u32 *)DE_C_SSET_D_MALLOC(universe * sizeof(u32)), universe};
+}
+
+DE_CONTAINER_SPARSE_SET_INTERNAL u0 de_sparse_set_clear(de_sparse_set *const _set) {
+  _set->dense.used = 0;
+}
+
+DE_CONTAINER_SPARSE_SET_INTERNAL u0
+de_sparse_set_delete(de_sparse_set *const _set) {
+  de_vec_delete(&_set->dense);
+  DE_C_SSET_D_FREE(_set->sparse);
+  _set->sparse = NULL;
+  _set->universe = 0;
+}
+
+DE_CONTAINER_SPARSE_SET_INTERNAL u0
+de_sparse_set_reserve_universe(de_sparse_set *const _set,
+                               const usize _universe) {
+  if (_universe <= _set->universe)
+    return;
+  /* only the entries of members have to survive, the rest stays garbage */
+  u32 *new_mem = (u32 *)DE_C_SSET_D_MALLOC(_universe * sizeof(u32));
+  DE_C_SSET_MEMCPY(new_mem, _set->sparse, _set->universe * sizeof(u32));
+  DE_C_SSET_D_FREE(_set->sparse);
+  _set->sparse = new_mem;
+  _set->universe = _universe;
+}
+
+/*
+  Info getters
+*/
+
+DE_CONTAINER_SPARSE_SET_INTERNAL usize
+de_sparse_set_info_size(const de_sparse_set *const _set) {
+  return _set->dense.used;
+}
+
+DE_CONTAINER_SPARSE_SET_INTERNAL usize
+de_sparse_set_info_universe(const de_sparse_set *const _set) {
+  return _set->universe;
+}
+
+DE_CONTAINER_SPARSE_SET_INTERNAL bool
+de_sparse_set_info_empty(const de_sparse_set *const _set) {
+  return _set->dense.used == 0;
+}
+
+/*
+  Access
+*/
+
+DE_CONTAINER_SPARSE_SET_INTERNAL bool
+de_sparse_set_contains(const de_sparse_set *const _set, const u32 _id) {
+  if (_id >= _set->universe)
+    return false;
+  const u32 pos = _set->sparse[_id];
+  return pos < _set->dense.used && ((const u32 *)_set->dense.data)[pos] == _id;
+}
+
+DE_CONTAINER_SPARSE_SET_INTERNAL bool
+de_sparse_set_insert(de_sparse_set *const _set, const u32 _id) {
+  if (_id >= _set->universe) {
+    const usize doubled = _set->universe * 2;
+    de_sparse_set_reserve_universe(_set, doubled > _id ? doubled
+                                                       : (usize)_id + 1);
+  } else if (de_sparse_set_contains(_set, _id)) {
+    return false;
+  }
+  _set->sparse[_id] = (u32)_set->dense.used;
+  de_vec_push_back(&_set->dense, &_id);
+  return true;
+}
+
+DE_CONTAINER_SPARSE_SET_INTERNAL bool
+de_sparse_set_erase(de_sparse_set *const _set, const u32 _id) {
+  if (!de_sparse_set_contains(_set, _id))
+    return false;
+  u32 *dense = (u32 *)_set->dense.data;
+  const u32 pos = _set->sparse[_id];
+  const u32 last = dense[--_set->dense.used];
+  dense[pos] = last;
+  _set->sparse[last] = pos;
+  return true;
+}
+
+/*
+  de_bvec interop
+*/
+
+DE_CONTAINER_SPARSE_SET_INTERNAL bool
+DE_C_SSET_bvec_test(const de_bvec *const _msk, const u32 _id) {
+  return _id < de_bvec_info_size(_msk) && de_bvec_get(_msk, _id);
+}
+
+DE_CONTAINER_SPARSE_SET_INTERNAL u0 de_sparse_set_intersect_bvec(
+    de_sparse_set *const _set, const de_bvec *const _msk) {
+  u32 *dense = (u32 *)_set->dense.data;
+  const usize used = _set->dense.used;
+  usize kept = 0;
+  /* compacting in order only ever moves members to lower positions */
+  for (usize i = 0; i < used; ++i) {
+    const u32 id = dense[i];
+    if (DE_C_SSET_bvec_test(_msk, id)) {
+      dense[kept] = id;
+      _set->sparse[id] = (u32)kept++;
+    }
+  }
+  _set->dense.used = kept;
+}
+
+DE_CONTAINER_SPARSE_SET_INTERNAL u0 de_sparse_set_intersect_bvec_into(
+    const de_sparse_set *const _set, const de_bvec *const _msk,
+    de_sparse_set *const _out) {
+  const u32 *dense = (const u32 *)_set->dense.data;
+  for (usize i = 0; i < _set->dense.used; ++i) {
+    if (DE_C_SSET_bvec_test(_msk, dense[i]))
+      de_sparse_set_insert(_out, dense[i]);
+  }
+}
+
+DE_CONTAINER_SPARSE_SET_INTERNAL usize de_sparse_set_count_intersect_bvec(
+    const de_sparse_set *const _set, const de_bvec *const _msk) {
+  const u32 *dense = (const u32 *)_set->dense.data;
+  usize out = 0;
+  for (usize i = 0; i < _set->dense.used; ++i)
+    out += DE_C_SSET_bvec_test(_msk, dense[i]) ? 1 : 0;
+  return out;
+}
+
+DE_CONTAINER_SPARSE_SET_INTERNAL u0
+de_sparse_set_to_bvec(const de_sparse_set *const _set, de_bvec *const _msk) {
+  const u32 *dense = (const u32 *)_set->dense.data;
+  for (usize i = 0; i < _set->dense.used; ++i) {
+#ifndef DE_OPTIONS_SPARSE_SET_NO_SAFETY_ASSERTS
+    DE_C_SSET_ASSERT(dense[i] < _msk->bits_amount &&
+                     "the mask has to hold the largest member");
+#endif
+    de_bvec_set(_msk, dense[i], true);
+  }
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif
+#endif
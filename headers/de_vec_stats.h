@@ -0,0 +1,607 @@
+#ifndef DE_CONTAINER_VEC_STATS_HEADER
+#define DE_CONTAINER_VEC_STATS_HEADER
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+to get function definitions #define DE_CONTAINER_VEC_STATS_IMPLEMENTATION before
+any #include. the implementation reads de_vec and de_bvec structs directly, no
+other IMPLEMENTATION define is needed
+
+typed reductions over numeric de_vec contents: count, sum, min, max (with the
+first index of each), mean and population variance. the kernels are compiled
+for sse2, avx2 and avx-512 (f, bw, dq, vl) and picked at runtime from the cpu
+feature bits on first use.
+
+an optional de_bvec mask selects the participating rows (bit i -> row i, rows
+beyond the mask size do not participate). runs of set bits are handed to the
+vector kernels as a whole, so dense masks cost about as much as no mask and
+sparse masks only touch the selected rows.
+
+sums of integer types are exact modulo 2^64 (i64 / u64 wrap around), f32 is
+summed in f64. min / max ignore NaN values that are not the first selected row
+*/
+
+/* clang-format off */
+/* possible options to set before 'first' include and IMPLEMENTATION */
+#ifndef DE_CONTAINER_VEC_STATS_OPTIONS
+#ifdef DE_CONTAINER_VEC_STATS_OPTIONS
+/* if defined removes assert checks */
+#define DE_OPTIONS_VEC_STATS_NO_SAFETY_ASSERTS
+/* if defined never selects the avx-512 kernels */
+#define DE_OPTIONS_VEC_STATS_NO_AVX512
+#endif
+#endif
+
+#ifdef DE_CONTAINER_VEC_STATS_IMPLEMENTATION
+#define DE_CONTAINER_VEC_STATS_API
+#else
+#define DE_CONTAINER_VEC_STATS_API extern
+#endif
+#define DE_CONTAINER_VEC_STATS_INTERNAL
+
+/* declarations */
+#include <common.h>
+#include <stdbool.h>
+#include <de_vector.h>
+#include <de_bitmask.h>
+
+/* element type of the vector, item_size has to match */
+typedef enum {
+  DE_VEC_STATS_I8,
+  DE_VEC_STATS_I16,
+  DE_VEC_STATS_I32,
+  DE_VEC_STATS_I64,
+  DE_VEC_STATS_U8,
+  DE_VEC_STATS_U16,
+  DE_VEC_STATS_U32,
+  DE_VEC_STATS_U64,
+  DE_VEC_STATS_F32,
+  DE_VEC_STATS_F64,
+  DE_VEC_STATS_TYPE_COUNT
+} de_vec_stats_type;
+
+/* read .i for signed, .u for unsigned and .f for floating point types */
+typedef union {
+  i64 i;
+  u64 u;
+  f64 f;
+} de_vec_stats_value;
+
+typedef struct {
+  usize              count;    /* participating rows */
+  de_vec_stats_value sum;
+  de_vec_stats_value min;
+  de_vec_stats_value max;
+  usize              argmin;   /* first row holding min, undefined if count is 0 */
+  usize              argmax;   /* first row holding max, undefined if count is 0 */
+  f64                mean;
+  f64                variance; /* population variance (divides by count) */
+} de_vec_stats;
+
+/* all fields. the variance needs an extra pass over the rows around the mean.
+   _mask may be NULL */
+DE_CONTAINER_VEC_STATS_API de_vec_stats
+de_vec_stats_compute(
+  const de_vec *const     _vec,
+  const de_vec_stats_type _type,
+  const de_bvec *const    _mask
+);
+
+/* only count, min, max, argmin and argmax */
+DE_CONTAINER_VEC_STATS_API de_vec_stats
+de_vec_stats_minmax(
+  const de_vec *const     _vec,
+  const de_vec_stats_type _type,
+  const de_bvec *const    _mask
+);
+
+/* only count, sum and mean */
+DE_CONTAINER_VEC_STATS_API de_vec_stats
+de_vec_stats_sum(
+  const de_vec *const     _vec,
+  const de_vec_stats_type _type,
+  const de_bvec *const    _mask
+);
+
+/* name of the selected kernel set: "avx512", "avx2" or "sse2" */
+DE_CONTAINER_VEC_STATS_API const char*
+de_vec_stats_info_isa(
+  u0
+);
+
+/* clang-format on */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif
+
+// #define DE_CONTAINER_VEC_STATS_IMPLEMENTATION_DEVELOPMENT
+#if defined(DE_CONTAINER_VEC_STATS_IMPLEMENTATION) ||                          \
+    defined(DE_CONTAINER_VEC_STATS_IMPLEMENTATION_DEVELOPMENT)
+#ifndef DE_CONTAINER_VEC_STATS_IMPLEMENTATION_INTERNAL
+#define DE_CONTAINER_VEC_STATS_IMPLEMENTATION_INTERNAL
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* implementations */
+#include <assert.h>
+#include <common.h>
+#include <string.h>
+
+/* macro defines */
+#define DE_C_VSTAT_ASSERT assert
+
+/*
+  kernels
+  written with gcc vector extensions so one definition compiles for every
+  width, the target attribute decides which instructions get emitted.
+  all kernels work on a plain [0, _n) range of items:
+    sum    adds the items to the accumulator (.u for integers, .f for floats)
+    minmax lowers / raises *_min / *_max (already holding a value of the range)
+    find   index of the first item equal to _value, _n if there is none
+    sqdev  sum of (item - _mean)^2
+*/
+
+typedef u0 (*DE_C_VSTAT_sum_func)(const u0 *_p, usize _n,
+                                  de_vec_stats_value *_acc);
+typedef u0 (*DE_C_VSTAT_minmax_func)(const u0 *_p, usize _n,
+                                     de_vec_stats_value *_min,
+                                     de_vec_stats_value *_max);
+typedef usize (*DE_C_VSTAT_find_func)(const u0 *_p, usize _n,
+                                      de_vec_stats_value _value);
+typedef f64 (*DE_C_VSTAT_sqdev_func)(const u0 *_p, usize _n, f64 _mean);
+
+typedef struct {
+  DE_C_VSTAT_sum_func sum;
+  DE_C_VSTAT_minmax_func minmax;
+  DE_C_VSTAT_find_func find;
+  DE_C_VSTAT_sqdev_func sqdev;
+} DE_C_VSTAT_kernels;
+
+/*
+  SUF    type suffix
+  T      item type
+  I      unsigned integer of the same size (lane masks)
+  F      de_vec_stats_value member of T
+  W      lane type the sum accumulates in
+  FLUSH  max vector iterations before W lanes could overflow, 0 for never
+  ACC    scalar sum type, SUMF its de_vec_stats_value member
+  ISA    name of the kernel set, BYTES its vector width, TARGET its attribute
+*/
+#define DE_C_VSTAT_DEFINE_KERNELS(SUF, T, I, F, W, FLUSH, ACC, SUMF, ISA,       \
+                                  BYTES, TARGET)                               \
+  typedef T DE_C_VSTAT_##ISA##_##SUF##_v __attribute__((vector_size(BYTES)));  \
+  typedef I DE_C_VSTAT_##ISA##_##SUF##_vi __attribute__((vector_size(BYTES))); \
+  typedef u64 DE_C_VSTAT_##ISA##_##SUF##_vq                                    \
+      __attribute__((vector_size(BYTES)));                                     \
+  typedef W DE_C_VSTAT_##ISA##_##SUF##_vw __attribute__((vector_size(BYTES)));  \
+  typedef T DE_C_VSTAT_##ISA##_##SUF##_vs                                      \
+      __attribute__((vector_size(BYTES / sizeof(W) * sizeof(T))));             \
+  typedef f64 DE_C_VSTAT_##ISA##_##SUF##_vd                                    \
+      __attribute__((vector_size(BYTES)));                                     \
+  typedef T DE_C_VSTAT_##ISA##_##SUF##_vk                                      \
+      __attribute__((vector_size(BYTES / sizeof(f64) * sizeof(T))));           \
+                                                                               \
+  TARGET DE_CONTAINER_VEC_STATS_INTERNAL u0 DE_C_VSTAT_sum_##ISA##_##SUF(      \
+      const u0 *_p, usize _n, de_vec_stats_value *_acc) {                      \
+    typedef DE_C_VSTAT_##ISA##_##SUF##_vw VW;                                  \
+    typedef DE_C_VSTAT_##ISA##_##SUF##_vs VS;                                  \
+    /* items are widened to W one register at a time, 4 independent chains */ \
+    const usize lanes = BYTES / sizeof(W);                                     \
+    const usize step = 4 * lanes;                                              \
+    const T *p = (const T *)_p;                                                \
+    usize i = 0;                                                               \
+    ACC total = 0;                                                             \
+    while (_n - i >= step) {                                                   \
+      usize rounds = (_n - i) / step;                                          \
+      if ((FLUSH) && rounds > (usize)(FLUSH))                                  \
+        rounds = (usize)(FLUSH);                                               \
+      const usize end = i + rounds * step;                                     \
+      VW acc0 = {0}, acc1 = {0}, acc2 = {0}, acc3 = {0};                       \
+      for (; i < end; i += step) {                                             \
+        VS v0, v1, v2, v3;                                                     \
+        memcpy(&v0, p + i, sizeof(v0));                                        \
+        memcpy(&v1, p + i + lanes, sizeof(v1));                                \
+        memcpy(&v2, p + i + 2 * lanes, sizeof(v2));                            \
+        memcpy(&v3, p + i + 3 * lanes, sizeof(v3));                            \
+        acc0 += __builtin_convertvector(v0, VW);                               \
+        acc1 += __builtin_convertvector(v1, VW);                               \
+        acc2 += __builtin_convertvector(v2, VW);                               \
+        acc3 += __builtin_convertvector(v3, VW);                               \
+      }                                                                        \
+      /* each chain is near the W limit after FLUSH rounds, widen first */     \
+      for (usize k = 0; k < lanes; ++k)                                        \
+        total += (ACC)acc0[k] + (ACC)acc1[k] + (ACC)acc2[k] + (ACC)acc3[k];    \
+    }                                                                          \
+    for (; i < _n; ++i)                                                        \
+      total += (ACC)p[i];                                                      \
+    _acc->SUMF += total;                                                       \
+  }                                                                            \
+                                                                               \
+  TARGET DE_CONTAINER_VEC_STATS_INTERNAL u0 DE_C_VSTAT_minmax_##ISA##_##SUF(   \
+      const u0 *_p, usize _n, de_vec_stats_value *_min,                        \
+      de_vec_stats_value *_max) {                                              \
+    typedef DE_C_VSTAT_##ISA##_##SUF##_v V;                                    \
+    typedef DE_C_VSTAT_##ISA##_##SUF##_vi VI;                                  \
+    const usize lanes = BYTES / sizeof(T);                                     \
+    const T *p = (const T *)_p;                                                \
+    T mn = (T)_min->F, mx = (T)_max->F;                                        \
+    usize i = 0;                                                               \
+    if (_n >= lanes) {                                                         \
+      /* seeded from the scalars, a NaN lane of the data never sticks */       \
+      V vmn = (V){0} + mn, vmx = (V){0} + mx;                                  \
+      for (; i + lanes <= _n; i += lanes) {                                    \
+        V v;                                                                   \
+        memcpy(&v, p + i, sizeof(v));                                          \
+        const VI lt = (VI)(v < vmn);                                           \
+        const VI gt = (VI)(v > vmx);                                           \
+        vmn = (V)(((VI)v & lt) | ((VI)vmn & ~lt));                             \
+        vmx = (V)(((VI)v & gt) | ((VI)vmx & ~gt));                             \
+      }                                                                        \
+      for (usize k = 0; k < lanes; ++k) {                                      \
+        if (vmn[k] < mn)                                                       \
+          mn = vmn[k];                                                         \
+        if (vmx[k] > mx)                                                       \
+          mx = vmx[k];                                                         \
+      }                                                                        \
+    }                                                                          \
+    for (; i < _n; ++i) {                                                      \
+      if (p[i] < mn)                                                           \
+        mn = p[i];                                                             \
+      if (p[i] > mx)                                                           \
+        mx = p[i];                                                             \
+    }                                                                          \
+    _min->F = mn;                                                              \
+    _max->F = mx;                                                              \
+  }                                                                            \
+                                                                               \
+  TARGET DE_CONTAINER_VEC_STATS_INTERNAL usize DE_C_VSTAT_find_##ISA##_##SUF(  \
+      const u0 *_p, usize _n, de_vec_stats_value _value) {                     \
+    typedef DE_C_VSTAT_##ISA##_##SUF##_v V;                                    \
+    typedef DE_C_VSTAT_##ISA##_##SUF##_vq VQ;                                  \
+    const usize lanes = BYTES / sizeof(T);                                     \
+    const T *p = (const T *)_p;                                                \
+    const T value = (T)_value.F;                                               \
+    const V vvalue = (V){0} + value;                                           \
+    usize i = 0;                                                               \
+    for (; i + lanes <= _n; i += lanes) {                                      \
+      V v;                                                                     \
+      memcpy(&v, p + i, sizeof(v));                                            \
+      const VQ eq = (VQ)(v == vvalue);                                         \
+      u64 any = 0;                                                             \
+      for (usize k = 0; k < BYTES / sizeof(u64); ++k)                          \
+        any |= eq[k];                                                          \
+      if (any)                                                                 \
+        break;                                                                 \
+    }                                                                          \
+    for (; i < _n; ++i) {                                                      \
+      if (p[i] == value)                                                       \
+        return i;                                                              \
+    }                                                                          \
+    return _n;                                                                 \
+  }                                                                            \
+                                                                               \
+  TARGET DE_CONTAINER_VEC_STATS_INTERNAL f64 DE_C_VSTAT_sqdev_##ISA##_##SUF(   \
+      const u0 *_p, usize _n, f64 _mean) {                                     \
+    typedef DE_C_VSTAT_##ISA##_##SUF##_vd VD;                                  \
+    typedef DE_C_VSTAT_##ISA##_##SUF##_vk VK;                                  \
+    const usize lanes = BYTES / sizeof(f64);                                   \
+    const T *p = (const T *)_p;                                                \
+    const VD vmean = (VD){0} + _mean;                                          \
+    VD acc = {0};                                                              \
+    usize i = 0;                                                               \
+    for (; i + lanes <= _n; i += lanes) {                                      \
+      VK v;                                                                    \
+      memcpy(&v, p + i, sizeof(v));                                            \
+      const VD d = __builtin_convertvector(v, VD) - vmean;                     \
+      acc += d * d;                                                            \
+    }                                                                          \
+    f64 out = 0;                                                               \
+    for (usize k = 0; k < lanes; ++k)                                          \
+      out += acc[k];                                                           \
+    for (; i < _n; ++i) {                                                      \
+      const f64 d = (f64)p[i] - _mean;                                         \
+      out += d * d;                                                            \
+    }                                                                          \
+    return out;                                                                \
+  }
+
+/* instantiates the kernels of every type for one kernel set, in
+ * de_vec_stats_type order */
+#define DE_C_VSTAT_DEFINE_ISA(ISA, BYTES, TARGET)                              \
+  DE_C_VSTAT_DEFINE_KERNELS(i8, i8, u8, i, i32, 1 << 23, u64, u, ISA, BYTES,   \
+                            TARGET)                                            \
+  DE_C_VSTAT_DEFINE_KERNELS(i16, i16, u16, i, i32, 1 << 15, u64, u, ISA,       \
+                            BYTES, TARGET)                                     \
+  DE_C_VSTAT_DEFINE_KERNELS(i32, i32, u32, i, u64, 0, u64, u, ISA, BYTES,      \
+                            TARGET)                                            \
+  DE_C_VSTAT_DEFINE_KERNELS(i64, i64, u64, i, u64, 0, u64, u, ISA, BYTES,      \
+                            TARGET)                                            \
+  DE_C_VSTAT_DEFINE_KERNELS(u8, u8, u8, u, u32, 1 << 23, u64, u, ISA, BYTES,   \
+                            TARGET)                                            \
+  DE_C_VSTAT_DEFINE_KERNELS(u16, u16, u16, u, u32, 1 << 15, u64, u, ISA,       \
+                            BYTES, TARGET)                                     \
+  DE_C_VSTAT_DEFINE_KERNELS(u32, u32, u32, u, u64, 0, u64, u, ISA, BYTES,      \
+                            TARGET)                                            \
+  DE_C_VSTAT_DEFINE_KERNELS(u64, u64, u64, u, u64, 0, u64, u, ISA, BYTES,      \
+                            TARGET)                                            \
+  DE_C_VSTAT_DEFINE_KERNELS(f32, f32, u32, f, f64, 0, f64, f, ISA, BYTES,      \
+                            TARGET)                                            \
+  DE_C_VSTAT_DEFINE_KERNELS(f64, f64, u64, f, f64, 0, f64, f, ISA, BYTES,      \
+                            TARGET)                                            \
+                                                                               \
+  static const DE_C_VSTAT_kernels                                              \
+      DE_C_VSTAT_kernels_##ISA[DE_VEC_STATS_TYPE_COUNT] = {                    \
+          DE_C_VSTAT_KERNEL_ENTRY(ISA, i8),                                    \
+          DE_C_VSTAT_KERNEL_ENTRY(ISA, i16),                                   \
+          DE_C_VSTAT_KERNEL_ENTRY(ISA, i32),                                   \
+          DE_C_VSTAT_KERNEL_ENTRY(ISA, i64),                                   \
+          DE_C_VSTAT_KERNEL_ENTRY(ISA, u8),                                    \
+          DE_C_VSTAT_KERNEL_ENTRY(ISA, u16),                                   \
+          DE_C_VSTAT_KERNEL_ENTRY(ISA, u32),                                   \
+          DE_C_VSTAT_KERNEL_ENTRY(ISA, u64),                                   \
+          DE_C_VSTAT_KERNEL_ENTRY(ISA, f32),                                   \
+          DE_C_VSTAT_KERNEL_ENTRY(ISA, f64)};
+
+#define DE_C_VSTAT_KERNEL_ENTRY(ISA, SUF)                                      \
+  {DE_C_VSTAT_sum_##ISA##_##SUF, DE_C_VSTAT_minmax_##ISA##_##SUF,              \
+   DE_C_VSTAT_find_##ISA##_##SUF, DE_C_VSTAT_sqdev_##ISA##_##SUF}
+
+#pragma GCC diagnostic push
+/* the vector types never cross a function boundary */
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+DE_C_VSTAT_DEFINE_ISA(sse2, 16, )
+#if defined(__x86_64__) || defined(__i386__)
+#define DE_C_VSTAT_HAVE_DISPATCH
+DE_C_VSTAT_DEFINE_ISA(avx2, 32, __attribute__((target("avx2"))))
+#ifndef DE_OPTIONS_VEC_STATS_NO_AVX512
+DE_C_VSTAT_DEFINE_ISA(avx512, 64,
+                      __attribute__((target("avx512f,avx512bw,avx512dq,"
+                                            "avx512vl"))))
+#endif
+#endif
+
+#pragma GCC diagnostic pop
+
+/*
+  dispatch
+*/
+
+static const u0 *DE_C_VSTAT_selected = NULL;
+static const char *DE_C_VSTAT_selected_name = "sse2";
+
+DE_CONTAINER_VEC_STATS_INTERNAL const u0 *DE_C_VSTAT_pick(u0) {
+  const char *name = "sse2";
+  const DE_C_VSTAT_kernels *out = DE_C_VSTAT_kernels_sse2;
+#ifdef DE_C_VSTAT_HAVE_DISPATCH
+  const DE_BVEC_cpu_level cpu = DE_BVEC_cpu_detect();
+#ifndef DE_OPTIONS_VEC_STATS_NO_AVX512
+  if (cpu >= DE_BVEC_CPU_AVX512) {
+    out = DE_C_VSTAT_kernels_avx512;
+    name = "avx512";
+  } else
+#endif
+      if (cpu >= DE_BVEC_CPU_AVX2) {
+    out = DE_C_VSTAT_kernels_avx2;
+    name = "avx2";
+  }
+#endif
+  __atomic_store_n(&DE_C_VSTAT_selected_name, name, __ATOMIC_RELAXED);
+  return out;
+}
+
+DE_CONTAINER_VEC_STATS_INTERNAL const DE_C_VSTAT_kernels *
+DE_C_VSTAT_select(u0) {
+  return (const DE_C_VSTAT_kernels *)DE_BVEC_dispatch(&DE_C_VSTAT_selected,
+                                                      DE_C_VSTAT_pick);
+}
+
+DE_CONTAINER_VEC_STATS_INTERNAL const char *de_vec_stats_info_isa(u0) {
+  DE_C_VSTAT_select();
+  return __atomic_load_n(&DE_C_VSTAT_selected_name, __ATOMIC_RELAXED);
+}
+
+/*
+  masked iteration
+*/
+
+DE_CONTAINER_VEC_STATS_INTERNAL usize
+DE_C_VSTAT_type_size(const de_vec_stats_type _type) {
+  static const usize sizes[DE_VEC_STATS_TYPE_COUNT] = {1, 2, 4, 8, 1,
+                                                       2, 4, 8, 4, 8};
+  return sizes[_type];
+}
+
+/* iterates the runs of consecutive participating rows */
+typedef struct {
+  const mblk_t *blocks; /* NULL without a mask */
+  usize rows;           /* rows that can participate */
+  usize pos;            /* next row to look at */
+} DE_C_VSTAT_runs;
+
+DE_CONTAINER_VEC_STATS_INTERNAL DE_C_VSTAT_runs
+DE_C_VSTAT_runs_create(const de_vec *const _vec, const de_bvec *const _mask) {
+  DE_C_VSTAT_runs out = {NULL, _vec->used, 0};
+  if (_mask) {
+    out.blocks = _mask->is_small ? &_mask->data.small : _mask->data.blocks;
+    if (_mask->bits_amount < out.rows)
+      out.rows = _mask->bits_amount;
+  }
+  return out;
+}
+
+/* index of the first row >= _pos whose bit equals _set, _rows if none */
+DE_CONTAINER_VEC_STATS_INTERNAL usize
+DE_C_VSTAT_scan(const mblk_t *const _blocks, usize _pos, const usize _rows,
+                const bool _set) {
+  while (_pos < _rows) {
+    mblk_t w = _blocks[_pos / DE_BVEC_MBLK_BITS];
+    if (!_set)
+      w = ~w;
+    w &= ~(mblk_t)0 << (_pos % DE_BVEC_MBLK_BITS);
+    if (w) {
+      _pos = _pos / DE_BVEC_MBLK_BITS * DE_BVEC_MBLK_BITS +
+             (usize)__builtin_ctzll(w);
+      return _pos < _rows ? _pos : _rows;
+    }
+    _pos = (_pos / DE_BVEC_MBLK_BITS + 1) * DE_BVEC_MBLK_BITS;
+  }
+  return _rows;
+}
+
+DE_CONTAINER_VEC_STATS_INTERNAL bool
+DE_C_VSTAT_runs_next(DE_C_VSTAT_runs *const _it, usize *const _start,
+                     usize *const _count) {
+  if (_it->pos >= _it->rows)
+    return false;
+  if (!_it->blocks) {
+    *_start = 0;
+    *_count = _it->rows;
+    _it->pos = _it->rows;
+    return true;
+  }
+  const usize start = DE_C_VSTAT_scan(_it->blocks, _it->pos, _it->rows, true);
+  if (start == _it->rows) {
+    _it->pos = _it->rows;
+    return false;
+  }
+  const usize end = DE_C_VSTAT_scan(_it->blocks, start, _it->rows, false);
+  *_start = start;
+  *_count = end - start;
+  _it->pos = end;
+  return true;
+}
+
+/*
+  reductions
+*/
+
+DE_CONTAINER_VEC_STATS_INTERNAL u0
+DE_C_VSTAT_load(const u0 *_p, const de_vec_stats_type _type,
+                de_vec_stats_value *const _out) {
+  switch (_type) {
+  case DE_VEC_STATS_I8: _out->i = *(const i8 *)_p; break;
+  case DE_VEC_STATS_I16: _out->i = *(const i16 *)_p; break;
+  case DE_VEC_STATS_I32: _out->i = *(const i32 *)_p; break;
+  case DE_VEC_STATS_I64: _out->i = *(const i64 *)_p; break;
+  case DE_VEC_STATS_U8: _out->u = *(const u8 *)_p; break;
+  case DE_VEC_STATS_U16: _out->u = *(const u16 *)_p; break;
+  case DE_VEC_STATS_U32: _out->u = *(const u32 *)_p; break;
+  case DE_VEC_STATS_U64: _out->u = *(const u64 *)_p; break;
+  case DE_VEC_STATS_F32: _out->f = *(const f32 *)_p; break;
+  default: _out->f = *(const f64 *)_p; break;
+  }
+}
+
+DE_CONTAINER_VEC_STATS_INTERNAL f64
+DE_C_VSTAT_to_f64(const de_vec_stats_value _value,
+                  const de_vec_stats_type _type) {
+  if (_type <= DE_VEC_STATS_I64)
+    return (f64)_value.i;
+  if (_type <= DE_VEC_STATS_U64)
+    return (f64)_value.u;
+  return _value.f;
+}
+
+/* first participating row equal to _value. only a NaN matches nothing, it
+   can only be the result when it is the first participating row */
+DE_CONTAINER_VEC_STATS_INTERNAL usize
+DE_C_VSTAT_find(const de_vec *const _vec, const de_bvec *const _mask,
+                const DE_C_VSTAT_kernels *const _k,
+                const de_vec_stats_value _value) {
+  DE_C_VSTAT_runs it = DE_C_VSTAT_runs_create(_vec, _mask);
+  usize start, count;
+  usize first = _vec->used;
+  while (DE_C_VSTAT_runs_next(&it, &start, &count)) {
+    if (first == _vec->used)
+      first = start;
+    const usize idx =
+        _k->find(_vec->data + start * _vec->item_size, count, _value);
+    if (idx != count)
+      return start + idx;
+  }
+  return first;
+}
+
+#define DE_C_VSTAT_DO_SUM (1u << 0)
+#define DE_C_VSTAT_DO_MINMAX (1u << 1)
+#define DE_C_VSTAT_DO_VARIANCE (1u << 2)
+
+DE_CONTAINER_VEC_STATS_INTERNAL de_vec_stats
+DE_C_VSTAT_run(const de_vec *const _vec, const de_vec_stats_type _type,
+               const de_bvec *const _mask, const u32 _what) {
+#ifndef DE_OPTIONS_VEC_STATS_NO_SAFETY_ASSERTS
+  DE_C_VSTAT_ASSERT(_type < DE_VEC_STATS_TYPE_COUNT && " has to recieve a valid type");
+  DE_C_VSTAT_ASSERT(_vec->item_size == DE_C_VSTAT_type_size(_type) &&
+                    " item_size has to match the type");
+#endif
+  const DE_C_VSTAT_kernels *const k = DE_C_VSTAT_select() + _type;
+  const usize item_size = _vec->item_size;
+  de_vec_stats out;
+  memset(&out, 0, sizeof(out));
+
+  DE_C_VSTAT_runs it = DE_C_VSTAT_runs_create(_vec, _mask);
+  usize start, count;
+  while (DE_C_VSTAT_runs_next(&it, &start, &count)) {
+    const u8 *p = _vec->data + start * item_size;
+    if (_what & DE_C_VSTAT_DO_MINMAX) {
+      if (!out.count) {
+        DE_C_VSTAT_load(p, _type, &out.min);
+        out.max = out.min;
+      }
+      k->minmax(p, count, &out.min, &out.max);
+    }
+    if (_what & (DE_C_VSTAT_DO_SUM | DE_C_VSTAT_DO_VARIANCE))
+      k->sum(p, count, &out.sum);
+    out.count += count;
+  }
+  if (!out.count)
+    return out;
+
+  if (_what & DE_C_VSTAT_DO_MINMAX) {
+    out.argmin = DE_C_VSTAT_find(_vec, _mask, k, out.min);
+    out.argmax = DE_C_VSTAT_find(_vec, _mask, k, out.max);
+  }
+  if (_what & (DE_C_VSTAT_DO_SUM | DE_C_VSTAT_DO_VARIANCE))
+    out.mean = DE_C_VSTAT_to_f64(out.sum, _type) / (f64)out.count;
+  if (_what & DE_C_VSTAT_DO_VARIANCE) {
+    /* second pass around the mean, sum of squares would cancel out */
+    f64 sq = 0;
+    it = DE_C_VSTAT_runs_create(_vec, _mask);
+    while (DE_C_VSTAT_runs_next(&it, &start, &count))
+      sq += k->sqdev(_vec->data + start * item_size, count, out.mean);
+    out.variance = sq / (f64)out.count;
+  }
+  return out;
+}
+
+DE_CONTAINER_VEC_STATS_INTERNAL de_vec_stats
+de_vec_stats_compute(const de_vec *const _vec, const de_vec_stats_type _type,
+                     const de_bvec *const _mask) {
+  return DE_C_VSTAT_run(_vec, _type, _mask,
+                        DE_C_VSTAT_DO_SUM | DE_C_VSTAT_DO_MINMAX |
+                            DE_C_VSTAT_DO_VARIANCE);
+}
+
+DE_CONTAINER_VEC_STATS_INTERNAL de_vec_stats
+de_vec_stats_minmax(const de_vec *const _vec, const de_vec_stats_type _type,
+                    const de_bvec *const _mask) {
+  return DE_C_VSTAT_run(_vec, _type, _mask, DE_C_VSTAT_DO_MINMAX);
+}
+
+DE_CONTAINER_VEC_STATS_INTERNAL de_vec_stats
+de_vec_stats_sum(const de_vec *const _vec, const de_vec_stats_type _type,
+                 const de_bvec *const _mask) {
+  return DE_C_VSTAT_run(_vec, _type, _mask, DE_C_VSTAT_DO_SUM);
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif
+#endif
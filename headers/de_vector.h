@@ -16,6 +16,20 @@ any #include
 IMPORTANT: If you keep a data* to a value stored in the vector, this pointer
            will go invalid if the vector size will be changed, so ensure you use
            get again once a resize might happen
+
+SHARED: de_vec_snapshot hands out O(1) copies that share one refcounted buffer.
+        all mutating functions copy the buffer first if it is still shared
+        (copy on write). pointers from de_vec_get / de_vec_find / de_vec_foreach
+        are not covered by that, call de_vec_make_unique before writing
+        through them. the refcount is atomic, so every thread can own and
+        delete its own snapshot, but one de_vec struct must not be used by
+        multiple threads at once. items are shared bitwise, destructors only
+        run for the items the last owner still holds
+
+VIEWS: de_vec_view is a non owning (data, used, item_size) window, turn it into
+       a borrowing de_vec with de_vec_from_view to run any algorithm on it
+       without copying. de_vec_adopt takes over an existing malloc'd / mmap'd
+       buffer together with the function that releases it
 */
 
 // #define DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
@@ -31,6 +45,9 @@ IMPORTANT: If you keep a data* to a value stored in the vector, this pointer
 #define DE_OPTIONS_VECTOR_GROWTH_FACTOR defaults to 2 /* i suggest a value resulting from 2^n */
 #define DE_OPTIONS_VECTOR_DATA_PTR_MALLOC_FUNCTION defaults to malloc from stdlib
 #define DE_OPTIONS_VECTOR_DATA_PTR_FREE_FUNCTION defaults to free
+#define DE_OPTIONS_VECTOR_PARALLEL_MIN_BLOCK defaults to 65536 /* min elements per thread of the parallel algorithms */
+#define DE_OPTIONS_VECTOR_EXTSORT_MEMORY defaults to (64 << 20) /* bytes an external sort may hold in memory */
+#define DE_OPTIONS_VECTOR_EXTSORT_FAN_IN defaults to 64 /* max runs an external sort merges at once */
 #endif
 #endif
 
@@ -44,10 +61,22 @@ IMPORTANT: If you keep a data* to a value stored in the vector, this pointer
 /* declarations */
 #include <common.h>
 #include <stdbool.h>
+#include <stdio.h>
 
-/* defaults to free */
+/* defaults to free
+   a NULL destructor marks the items as trivially destructible, the *_with_destructor
+   functions then skip the per item loop entirely */
 typedef u0 (*de_vec_destructor_func)(u0 *_p);
 
+/* range destructor: destroys _count items starting at _begin in one call.
+   if set it is used instead of the per item destructor */
+typedef u0 (*de_vec_range_destructor_func)(u0 *_begin, usize _count, usize _item_size);
+/* example:
+  void free_bufs(void *begin, size_t count, size_t item_size) {
+    for (size_t i = 0; i < count; ++i) free(((buf_t*)begin)[i].ptr);
+  }
+*/
+
 /* comparator: returns <0, 0, >0 like qsort */
 typedef int (*de_vec_cmp_func)(const u0 *a, const u0 *b);
 /* example: 
@@ -76,6 +105,20 @@ typedef u0 (*de_vec_foreach_func)(u0 *item, u0 *data);
   }
 */
 
+/* hash: returns a 64 bit hash of the item. NULL hashes the raw item_size bytes */
+typedef u64 (*de_vec_hash_func)(const u0 *item);
+
+/* key: maps an item to the key of its group (used by de_vec_group_by) */
+typedef u64 (*de_vec_key_func)(const u0 *item, u0 *data);
+/* example:
+  u64 key_parity(const void *item, void *data) { return *(int*)item & 1; }
+*/
+
+/* releases a buffer handed to de_vec_adopt, _bytes is capacity * item_size
+   (handy for munmap). de_vec_buffer_borrowed marks memory the vector must
+   never free */
+typedef u0 (*de_vec_buffer_free_func)(u0 *_buffer, usize _bytes);
+
 /* more like byte lol */
 #define DE_C_VEC_VOID_REPLACEMENT u8
 typedef struct {
@@ -87,8 +130,21 @@ typedef struct {
   DE_C_VEC_VOID_REPLACEMENT* data;
 
   de_vec_destructor_func destructor;
+  de_vec_range_destructor_func range_destructor; /* preferred over destructor, NULL if unused */
+
+  usize* shared; /* refcount of a buffer shared by snapshots, NULL if exclusively owned */
+
+  de_vec_buffer_free_func buffer_free; /* frees an adopted buffer, NULL for DE_OPTIONS_VECTOR_DATA_PTR_FREE_FUNCTION */
 } de_vec;
 
+/* non owning window into contiguous items (a de_vec, a sub range of one or any
+   plain array). it never frees anything, the memory has to outlive it */
+typedef struct {
+  DE_C_VEC_VOID_REPLACEMENT* data;
+  usize used;
+  usize item_size;
+} de_vec_view;
+
 /* 
   constructors
 */
@@ -130,6 +186,64 @@ de_vec_create_from_vector(
   const de_vec* const _src
 );
 
+/* takes ownership of an existing buffer holding _count items with room for
+   _capacity, no copy. _free_fn releases it later (NULL uses the configured
+   free function, de_vec_buffer_borrowed never frees it). growing past
+   _capacity moves the items into a buffer of the vector and releases _buffer */
+DE_CONTAINER_VECTOR_API de_vec
+de_vec_adopt(
+  const usize                   _item_size,
+  u0                           *_buffer,
+  const usize                   _count,
+  const usize                   _capacity,
+  const de_vec_buffer_free_func _free_fn
+);
+
+/* free function for de_vec_adopt that leaves the buffer alone */
+DE_CONTAINER_VECTOR_API u0
+de_vec_buffer_borrowed(
+  u0                 *_buffer,
+  usize               _bytes
+);
+
+/* view over _count items of _data */
+DE_CONTAINER_VECTOR_API de_vec_view
+de_vec_view_create(
+  u0                 *_data,
+  const usize         _count,
+  const usize         _item_size
+);
+
+/* view over the items [_start, _end) of _vec, invalidated like de_vec_get pointers.
+   a shared buffer is copied first, so writing through the view never reaches a snapshot */
+DE_CONTAINER_VECTOR_API de_vec_view
+de_vec_view_of(
+  de_vec *const       _vec,
+  const usize         _start,
+  const usize         _end
+);
+
+/* borrows the memory of _view as a full vector, so every read / algorithm
+   function (sort, find, foreach, ...) runs on it in place without a copy.
+   de_vec_delete on it frees nothing, growing it copies into its own buffer */
+DE_CONTAINER_VECTOR_API de_vec
+de_vec_from_view(
+  const de_vec_view   _view
+);
+
+/* O(1) copy that shares the buffer of _src until either of them is mutated.
+   delete the snapshot with de_vec_delete like any other vector */
+DE_CONTAINER_VECTOR_API de_vec
+de_vec_snapshot(
+  de_vec *const       _src
+);
+
+/* gives _vec its own buffer if it is shared, no-op otherwise */
+DE_CONTAINER_VECTOR_API u0
+de_vec_make_unique(
+  de_vec *const       _vec
+);
+
 /* set used amount to 0 */
 DE_CONTAINER_VECTOR_API u0
 de_vec_clear(
@@ -148,19 +262,26 @@ de_vec_delete(
   de_vec *const           _vec
 );
 
-/* delete entire vector, call destructor on each item */
+/* delete entire vector, call destructor on each item (only by the last owner of a shared buffer) */
 DE_CONTAINER_VECTOR_API u0
 de_vec_delete_with_destructor(
   de_vec *const           _vec
 );
 
-/* set or replace element destructor function */
+/* set or replace element destructor function, NULL marks the items as trivial */
 DE_CONTAINER_VECTOR_API u0
 de_vec_set_destructor(
   de_vec *const              _vec,
   de_vec_destructor_func     _destructor
 );
 
+/* set or replace the range destructor function, NULL falls back to the element destructor */
+DE_CONTAINER_VECTOR_API u0
+de_vec_set_range_destructor(
+  de_vec *const                _vec,
+  de_vec_range_destructor_func _range_destructor
+);
+
 /*
   Info getters
 */
@@ -199,6 +320,19 @@ de_vec_info_empty(
   de_vec *const _vec
 );
 
+/* true if destroying the items is a no-op (no range destructor and a NULL or
+   the built in default destructor) */
+DE_CONTAINER_VECTOR_API bool
+de_vec_info_trivial(
+  de_vec *const _vec
+);
+
+/* true if the buffer is currently shared with a snapshot */
+DE_CONTAINER_VECTOR_API bool
+de_vec_info_shared(
+  de_vec *const _vec
+);
+
 /*
   Capacity / resizing
 */
@@ -282,6 +416,26 @@ de_vec_insert_batch(
   const usize                  _amount
 );
 
+/* inserts _amount elements in one pass, _elements[i] goes before the original element
+   at _positions[i]. _positions has to be ascending (equal positions keep the order of
+   _elements) with values <= size. grows once and moves every element at most once */
+DE_CONTAINER_VECTOR_API u0
+de_vec_insert_many(
+  de_vec *const                _vec,
+  const usize *const           _positions,
+  const u0 *const              _elements,
+  const usize                  _amount
+);
+
+/* merges the sorted _src into the sorted _dst, keeps _dst sorted (stable, elements of
+   _dst stay in front of equal elements of _src). _src is not modified */
+DE_CONTAINER_VECTOR_API u0
+de_vec_merge_sorted_into(
+  de_vec *const                _dst,
+  de_vec *const                _src,
+  de_vec_cmp_func              _cmp
+);
+
 /* appends _src to _dst (destroys _src) */
 DE_CONTAINER_VECTOR_API u0
 de_vec_concat(
@@ -305,7 +459,10 @@ DE_CONTAINER_VECTOR_API u0
 de_vec_pop_back(
   de_vec *const _vec
 );
-/* remove last element. */
+/* remove last element and destroy it. on a shared buffer the item is left alone,
+   other owners still see it and a copy would only duplicate what it owns. it is
+   destroyed by the last owner only while that one still holds it, so an item
+   popped from every owner of a shared buffer is never destroyed (leaks) */
 DE_CONTAINER_VECTOR_API u0
 de_vec_pop_back_with_destructor(
   de_vec *const _vec
@@ -388,7 +545,7 @@ de_vec_sort(
   de_vec_cmp_func         _cmp
 );
 
-/* sorts the vector based on the provided search function in the provided range*/
+/* sorts the vector based on the provided search function in the range [_start_idx, _end_idx) */
 DE_CONTAINER_VECTOR_API u0
 de_vec_sort_range(
   de_vec *const           _vec,
@@ -397,12 +554,383 @@ de_vec_sort_range(
   const usize             _end_idx
 );
 
+/* stable, adaptive merge sort (powersort run merging with galloping).
+   detects existing ascending / descending runs, so presorted input takes about
+   linear time. allocates one temporary buffer of at most half the vector */
+DE_CONTAINER_VECTOR_API u0
+de_vec_sort_stable(
+  de_vec *const           _vec,
+  de_vec_cmp_func         _cmp
+);
+
+/* de_vec_sort_stable on the elements in [_start_idx, _end_idx) */
+DE_CONTAINER_VECTOR_API u0
+de_vec_sort_stable_range(
+  de_vec *const           _vec,
+  de_vec_cmp_func         _cmp,
+  const usize             _start_idx,
+  const usize             _end_idx
+);
+
+/*
+  indirect sorting and permutations
+  index vectors hold u32 (item_size 4) or u64 (item_size 8) indices
+*/
+
+/* fills _out_indices (created, item_size 4 or 8, previous contents dropped) with the
+   indices of _vec in the order a stable sort by _cmp would produce. _vec is not modified */
+DE_CONTAINER_VECTOR_API u0
+de_vec_argsort(
+  de_vec *const           _vec,
+  de_vec_cmp_func         _cmp,
+  de_vec *const           _out_indices
+);
+
+/* de_vec_argsort by an unsigned integer key of _key_size (1, 2, 4 or 8) bytes stored
+   at _key_offset inside each item. stable LSD radix sort, O(n) */
+DE_CONTAINER_VECTOR_API u0
+de_vec_argsort_by_key(
+  de_vec *const           _vec,
+  const usize             _key_offset,
+  const usize             _key_size,
+  de_vec *const           _out_indices
+);
+
+/* reorders _vec in place so that item[i] becomes the old item[_indices[i]].
+   _indices has to be a permutation of [0, size). follows the cycles with one
+   temporary element, so every item is moved once.
+   returns false and leaves _vec untouched if an index repeats or is out of range */
+DE_CONTAINER_VECTOR_API bool
+de_vec_apply_permutation(
+  de_vec *const           _vec,
+  de_vec *const           _indices
+);
+
+/* _out (created, same item_size, previous contents dropped) receives
+   _vec[_indices[0]], _vec[_indices[1]], ... */
+DE_CONTAINER_VECTOR_API u0
+de_vec_gather(
+  de_vec *const           _vec,
+  de_vec *const           _indices,
+  de_vec *const           _out
+);
+
 /* reverses the vector */
 DE_CONTAINER_VECTOR_API u0
 de_vec_reverse(
   de_vec *const           _vec
 );
 
+/*
+  selection
+  "smaller" is decided by _cmp, pass a reversed comparator to select the largest
+*/
+
+/* rearranges the vector so that the element at _nth is the one that would be there
+   if the vector was sorted, all elements before it are <= and all after it are >= (introselect) */
+DE_CONTAINER_VECTOR_API u0
+de_vec_nth_element(
+  de_vec *const           _vec,
+  const usize             _nth,
+  de_vec_cmp_func         _cmp
+);
+
+/* sorts the _k smallest elements into [0, _k), the order of the rest is unspecified.
+   does not allocate */
+DE_CONTAINER_VECTOR_API u0
+de_vec_partial_sort(
+  de_vec *const           _vec,
+  const usize             _k,
+  de_vec_cmp_func         _cmp
+);
+
+/* offers _element to the bounded heap _heap (holds at most _k elements, start with an
+   empty vector), keeps it if it is among the _k smallest seen so far.
+   returns true if _element was kept */
+DE_CONTAINER_VECTOR_API bool
+de_vec_top_k_push(
+  de_vec *const           _heap,
+  const usize             _k,
+  const u0 *const         _element,
+  de_vec_cmp_func         _cmp
+);
+
+/* turns a heap filled by de_vec_top_k_push into an ascending sorted vector */
+DE_CONTAINER_VECTOR_API u0
+de_vec_top_k_finish(
+  de_vec *const           _heap,
+  de_vec_cmp_func         _cmp
+);
+
+/* streams over _vec keeping the _k smallest elements in a bounded heap, _out
+   (created, same item_size, previous contents dropped) receives them sorted ascending */
+DE_CONTAINER_VECTOR_API u0
+de_vec_top_k(
+  de_vec *const           _vec,
+  const usize             _k,
+  de_vec_cmp_func         _cmp,
+  de_vec *const           _out
+);
+
+/*
+  inline iteration
+  macro forms of foreach / find / remove_all, the loop body or predicate gets
+  inlined instead of being called through a function pointer per element.
+  T has to match the item_size of the vector
+*/
+
+/* loops over all elements, it is a T* to the current element
+   DE_VEC_FOR_EACH(int, it, &vec) { *it += 1; }
+   __typeof__ keeps both pointers a T* for pointer types like int* */
+#define DE_VEC_FOR_EACH(T, it, _vec)                                           \
+  for (__typeof__(T) *it = (T *)(_vec)->data, *it##_end_ = it + (_vec)->used;  \
+       it != it##_end_; ++it)
+
+/* loops over the elements in [_start_idx, _end_idx) */
+#define DE_VEC_FOR_EACH_RANGE(T, it, _vec, _start_idx, _end_idx)               \
+  for (__typeof__(T) *it = (T *)(_vec)->data + (_start_idx),                   \
+                     *it##_end_ = (T *)(_vec)->data + (_end_idx);              \
+       it != it##_end_; ++it)
+
+/*
+generates typed algorithms with an inlined predicate:
+  T*    _name##_find(de_vec *const _vec, u0 *_data)      first match or one-past-end
+  usize _name##_count(de_vec *const _vec, u0 *_data)     amount of matches
+  usize _name##_remove_if(de_vec *const _vec, u0 *_data) removes matches in one pass,
+                                                         keeps order, returns amount removed
+_pred is a function or macro usable as bool _pred(const T *item, u0 *data)
+example:
+  static inline bool is_neg(const int *item, void *data) { return *item < 0; }
+  DE_VEC_DEFINE_PRED_ALGORITHMS(ints_neg, int, is_neg)
+  usize removed = ints_neg_remove_if(&vec, NULL);
+*/
+#define DE_VEC_DEFINE_PRED_ALGORITHMS(_name, T, _pred)                         \
+  static inline T *_name##_find(de_vec *const _vec, u0 *_data) {               \
+    T *it = (T *)_vec->data;                                                   \
+    T *const end = it + _vec->used;                                            \
+    while (it != end && !(_pred(it, _data)))                                   \
+      ++it;                                                                    \
+    return it;                                                                 \
+  }                                                                            \
+  static inline usize _name##_count(de_vec *const _vec, u0 *_data) {           \
+    usize out = 0;                                                             \
+    DE_VEC_FOR_EACH(T, it, _vec) { out += (_pred(it, _data)) ? 1 : 0; }        \
+    return out;                                                                \
+  }                                                                            \
+  static inline usize _name##_remove_if(de_vec *const _vec, u0 *_data) {       \
+    T *const begin = (T *)_vec->data;                                          \
+    const usize used = _vec->used;                                             \
+    usize first = 0;                                                           \
+    while (first != used && !(_pred(begin + first, _data)))                    \
+      ++first;                                                                 \
+    if (first == used)                                                         \
+      return 0;                                                                \
+    if (_vec->shared)                                                          \
+      de_vec_make_unique(_vec);                                                \
+    T *const data = (T *)_vec->data;                                           \
+    usize kept = first;                                                        \
+    for (usize i = first + 1; i != used; ++i) {                                \
+      if (!(_pred(data + i, _data)))                                           \
+        data[kept++] = data[i];                                                \
+    }                                                                          \
+    _vec->used = kept;                                                         \
+    return used - kept;                                                        \
+  }
+
+/*
+  hashing algorithms
+  every call allocates one temporary hash table sized for the vector
+*/
+
+/* removes all duplicates, keeps the first occurrence and the order of the kept elements.
+   _hash may be NULL (hashes raw bytes), _cmp may be NULL (compares raw bytes).
+   returns amount of removed */
+DE_CONTAINER_VECTOR_API usize
+de_vec_unique_hashed(
+  de_vec *const           _vec,
+  de_vec_hash_func        _hash,
+  de_vec_cmp_func         _cmp   /* comparator: returns 0 when equal */
+);
+
+/* returns the amount of distinct elements, same _hash / _cmp rules as de_vec_unique_hashed */
+DE_CONTAINER_VECTOR_API usize
+de_vec_count_distinct(
+  de_vec *const           _vec,
+  de_vec_hash_func        _hash,
+  de_vec_cmp_func         _cmp   /* comparator: returns 0 when equal */
+);
+
+/* partitions the elements by _key into _out (groups ordered by first appearance,
+   elements keep their order inside a group). _out_offsets receives group_count + 1
+   usize entries, group g lives in [offsets[g], offsets[g + 1]) of _out.
+   _out (same item_size) and _out_offsets (item_size sizeof(usize)) have to be created,
+   previous contents are dropped. returns the amount of groups */
+DE_CONTAINER_VECTOR_API usize
+de_vec_group_by(
+  de_vec *const           _vec,
+  de_vec_key_func         _key,
+  u0 *                    _data,
+  de_vec *const           _out,
+  de_vec *const           _out_offsets
+);
+
+/*
+  reductions and prefix sums
+  _threads: 1 runs on the calling thread, 0 uses one thread per logical cpu.
+  with more than one thread the vector is split into blocks (two pass block
+  algorithm), so _combine has to be associative.
+  parallel mode uses pthreads (link with -pthread), on _WIN32 it runs serial
+*/
+
+/* folds item into acc (acc = acc op item), both are item_size bytes */
+typedef u0 (*de_vec_combine_func)(u0 *acc, const u0 *item, u0 *data);
+/* example:
+  void add_int(void *acc, const void *item, void *data) { *(int*)acc += *(const int*)item; }
+*/
+
+/* folds all elements into _acc, which holds the initial value on input and the result on output */
+DE_CONTAINER_VECTOR_API u0
+de_vec_reduce(
+  de_vec *const           _vec,
+  u0 *const               _acc,
+  de_vec_combine_func     _combine,
+  u0 *                    _data,
+  const usize             _threads
+);
+
+/* in place prefix fold starting from _init.
+   inclusive: item[i] = init op item[0] op .. op item[i]
+   exclusive: item[i] = init op item[0] op .. op item[i - 1] */
+DE_CONTAINER_VECTOR_API u0
+de_vec_scan(
+  de_vec *const           _vec,
+  const u0 *const         _init,
+  de_vec_combine_func     _combine,
+  u0 *                    _data,
+  const bool              _inclusive,
+  const usize             _threads
+);
+
+/* typed sums (SIMD), u32 is accumulated in u64 and f32 in f64 */
+DE_CONTAINER_VECTOR_API u64
+de_vec_sum_u32(
+  de_vec *const           _vec,
+  const usize             _threads
+);
+
+DE_CONTAINER_VECTOR_API u64
+de_vec_sum_u64(
+  de_vec *const           _vec,
+  const usize             _threads
+);
+
+DE_CONTAINER_VECTOR_API f64
+de_vec_sum_f32(
+  de_vec *const           _vec,
+  const usize             _threads
+);
+
+DE_CONTAINER_VECTOR_API f64
+de_vec_sum_f64(
+  de_vec *const           _vec,
+  const usize             _threads
+);
+
+/* typed in place prefix sums (SIMD) starting from 0, wrap around like the
+   element type. an exclusive scan turns counts into offsets */
+DE_CONTAINER_VECTOR_API u0
+de_vec_scan_sum_u32(
+  de_vec *const           _vec,
+  const bool              _inclusive,
+  const usize             _threads
+);
+
+DE_CONTAINER_VECTOR_API u0
+de_vec_scan_sum_u64(
+  de_vec *const           _vec,
+  const bool              _inclusive,
+  const usize             _threads
+);
+
+/*
+  external sorting
+  sorts more fixed size records than fit into memory: pushed items collect in a
+  buffer of memory_limit bytes, every full buffer is stable sorted and spilled
+  as a run into an unlinked temporary file, finishing merges the runs fan_in at
+  a time with a loser tree. the result is stable (equal items keep push order).
+  the runs are raw item bytes, only meant for local disk
+*/
+
+/* 0 fields fall back to the defaults */
+typedef struct {
+  usize       memory_limit; /* bytes for the run buffer with its sort scratch, and for the merge buffers, DE_OPTIONS_VECTOR_EXTSORT_MEMORY */
+  usize       fan_in;       /* max runs merged at once (>= 2), DE_OPTIONS_VECTOR_EXTSORT_FAN_IN */
+  const char *temp_dir;     /* directory of the run files, NULL uses tmpfile() */
+} de_vec_extsort_config;
+
+/* receives the sorted items one by one */
+typedef u0 (*de_vec_extsort_emit_func)(const u0 *item, u0 *data);
+
+typedef struct {
+  usize            item_size;
+  de_vec_cmp_func  cmp;
+  usize            fan_in;
+  usize            io_buffer_size; /* bytes read / written per call while merging */
+  usize            run_items;      /* capacity of buffer in items */
+  const char      *temp_dir;
+
+  de_vec           buffer; /* current run, never grows */
+  de_vec           runs;   /* spilled runs (internal) */
+  usize            total;  /* items pushed so far */
+  bool             failed; /* an io operation failed, finishing will report false */
+} de_vec_extsort;
+
+/* _config may be NULL */
+DE_CONTAINER_VECTOR_API de_vec_extsort
+de_vec_extsort_create(
+  const usize                         _item_size,
+  de_vec_cmp_func                     _cmp,
+  const de_vec_extsort_config *const  _config
+);
+
+/* adds _count items, spills a run whenever the buffer is full.
+   returns false as soon as writing a run failed, the items not taken yet are dropped */
+DE_CONTAINER_VECTOR_API bool
+de_vec_extsort_push(
+  de_vec_extsort *const   _sorter,
+  const u0 *const         _items,
+  const usize             _count
+);
+
+/* adds all items of _vec (item_size has to match) */
+DE_CONTAINER_VECTOR_API bool
+de_vec_extsort_push_vec(
+  de_vec_extsort *const   _sorter,
+  de_vec *const           _vec
+);
+
+/* hands all items in sorted order to _emit, the sorter is empty afterwards.
+   without a spilled run nothing touches the disk. returns false on io errors */
+DE_CONTAINER_VECTOR_API bool
+de_vec_extsort_finish(
+  de_vec_extsort *const     _sorter,
+  de_vec_extsort_emit_func  _emit,
+  u0 *                      _data
+);
+
+/* like de_vec_extsort_finish but writes the raw sorted items to _out */
+DE_CONTAINER_VECTOR_API bool
+de_vec_extsort_finish_to_file(
+  de_vec_extsort *const   _sorter,
+  FILE *                  _out
+);
+
+/* frees the buffer and closes (removes) all run files */
+DE_CONTAINER_VECTOR_API u0
+de_vec_extsort_delete(
+  de_vec_extsort *const   _sorter
+);
+
 /* 
    swap and unpack 
 */
@@ -431,6 +959,108 @@ de_vec_to_array(
 
 #endif
 
+/*
+  parallel blocks, shared by the parallel algorithms here and the parallel bulk
+  operations of de_bitmask.h. emitted for either implementation, static so both
+  can live in different translation units
+*/
+#if defined(DE_CONTAINER_VECTOR_IMPLEMENTATION) ||                             \
+    defined(DE_CONTAINER_VECTOR_IMPLEMENTATION_DEVELOPMENT) ||                 \
+    defined(DE_CONTAINER_BITMASK_IMPLEMENTATION)
+#ifndef DE_CONTAINER_VECTOR_PARALLEL_INTERNAL
+#define DE_CONTAINER_VECTOR_PARALLEL_INTERNAL
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <common.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/* runs on block _block which covers the elements [_begin, _end) */
+typedef u0 (*DE_C_VEC_block_func)(const usize _block, const usize _begin,
+                                  const usize _end, u0 *_ctx);
+
+typedef struct {
+  DE_C_VEC_block_func func;
+  u0 *ctx;
+  usize block;
+  usize begin;
+  usize end;
+} DE_C_VEC_block_task;
+
+/* amount of blocks of at least _min_block elements to split _count elements
+   into for _threads threads */
+static usize DE_C_VEC_block_count(const usize _count, const usize _min_block,
+                                  usize _threads) {
+#ifdef _WIN32
+  (u0) _count;
+  (u0) _min_block;
+  (u0) _threads;
+  return 1;
+#else
+  if (_threads == 0) {
+    const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    _threads = cpus > 0 ? (usize)cpus : 1;
+  }
+  const usize max_blocks = _count / _min_block;
+  if (_threads > max_blocks)
+    _threads = max_blocks;
+  return _threads ? _threads : 1;
+#endif
+}
+
+#ifndef _WIN32
+static u0 *DE_C_VEC_block_entry(u0 *_task) {
+  DE_C_VEC_block_task *task = (DE_C_VEC_block_task *)_task;
+  task->func(task->block, task->begin, task->end, task->ctx);
+  return NULL;
+}
+#endif
+
+/* runs _func once per block, block 0 on the calling thread */
+static u0 DE_C_VEC_parallel_blocks(const usize _count, const usize _blocks,
+                                   DE_C_VEC_block_func _func, u0 *_ctx) {
+  if (_blocks <= 1) {
+    _func(0, 0, _count, _ctx);
+    return;
+  }
+#ifndef _WIN32
+  DE_C_VEC_block_task *tasks =
+      (DE_C_VEC_block_task *)malloc(_blocks * sizeof(DE_C_VEC_block_task));
+  pthread_t *threads = (pthread_t *)malloc(_blocks * sizeof(pthread_t));
+  bool *started = (bool *)calloc(_blocks, sizeof(bool));
+  for (usize b = 0; b < _blocks; ++b) {
+    tasks[b] = (DE_C_VEC_block_task){_func, _ctx, b, _count * b / _blocks,
+                                     _count * (b + 1) / _blocks};
+  }
+  for (usize b = 1; b < _blocks; ++b) {
+    started[b] = pthread_create(threads + b, NULL, DE_C_VEC_block_entry,
+                                tasks + b) == 0;
+  }
+  DE_C_VEC_block_entry(tasks);
+  for (usize b = 1; b < _blocks; ++b) {
+    if (started[b])
+      pthread_join(threads[b], NULL);
+    else
+      DE_C_VEC_block_entry(tasks + b);
+  }
+  free(started);
+  free(threads);
+  free(tasks);
+#endif
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif
+#endif
+
 // #define DE_CONTAINER_VECTOR_IMPLEMENTATION_DEVELOPMENT
 #if defined(DE_CONTAINER_VECTOR_IMPLEMENTATION) ||                             \
     defined(DE_CONTAINER_VECTOR_IMPLEMENTATION_DEVELOPMENT)
@@ -445,6 +1075,17 @@ extern "C" {
 #include <common.h>
 #include <stdlib.h>
 #include <string.h>
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+/* strict iso modes (-std=c11) hide these posix functions of the external sort,
+   and the feature macro would come too late once any system header was read */
+#if !defined(__cplusplus) && defined(__STRICT_ANSI__) &&                       \
+    !(_POSIX_C_SOURCE >= 200809L || _XOPEN_SOURCE >= 700)
+int mkstemp(char *_template);
+FILE *fdopen(int _fd, const char *_mode);
+#endif
+#endif
 
 /* macro defines */
 #ifndef DE_OPTIONS_VECTOR_DEFAULT_DESTRUCTOR
@@ -452,6 +1093,11 @@ void DE_OPTIONS_VECTOR_DEFAULT_DESTRUCTOR_brrrrr(__attribute__((__unused__))
                                                  u0 *const data) {}
 #define DE_OPTIONS_VECTOR_DEFAULT_DESTRUCTOR                                   \
   DE_OPTIONS_VECTOR_DEFAULT_DESTRUCTOR_brrrrr
+/* the built in default does nothing, treat it like a NULL destructor */
+#define DE_C_VEC_DESTRUCTOR_IS_TRIVIAL(f)                                      \
+  ((f) == NULL || (f) == DE_OPTIONS_VECTOR_DEFAULT_DESTRUCTOR_brrrrr)
+#else
+#define DE_C_VEC_DESTRUCTOR_IS_TRIVIAL(f) ((f) == NULL)
 #endif
 
 #ifndef DE_OPTIONS_VECTOR_INITIAL_SIZE
@@ -470,6 +1116,18 @@ void DE_OPTIONS_VECTOR_DEFAULT_DESTRUCTOR_brrrrr(__attribute__((__unused__))
 #define DE_OPTIONS_VECTOR_DATA_PTR_FREE_FUNCTION free
 #endif
 
+#ifndef DE_OPTIONS_VECTOR_EXTSORT_MEMORY
+#define DE_OPTIONS_VECTOR_EXTSORT_MEMORY (64 << 20)
+#endif
+
+#ifndef DE_OPTIONS_VECTOR_EXTSORT_FAN_IN
+#define DE_OPTIONS_VECTOR_EXTSORT_FAN_IN 64
+#endif
+
+#ifndef DE_OPTIONS_VECTOR_PARALLEL_MIN_BLOCK
+#define DE_OPTIONS_VECTOR_PARALLEL_MIN_BLOCK 65536
+#endif
+
 DE_CONTAINER_VECTOR_INTERNAL usize _next_power_of_2(usize x) {
   if (x == 0)
     return 1;
@@ -499,7 +1157,7 @@ DE_CONTAINER_VECTOR_INTERNAL de_vec de_vec_create(const usize _item_size) {
   return (de_vec){
       _item_size, DE_OPTIONS_VECTOR_INITIAL_SIZE, 0,
       DE_C_VEC_D_MALLOC(DE_OPTIONS_VECTOR_INITIAL_SIZE * _item_size),
-      DE_OPTIONS_VECTOR_DEFAULT_DESTRUCTOR};
+      DE_OPTIONS_VECTOR_DEFAULT_DESTRUCTOR, NULL, NULL, NULL};
 }
 
 DE_CONTAINER_VECTOR_INTERNAL de_vec
@@ -507,7 +1165,7 @@ de_vec_create_with_capacity(const usize _item_size, usize _initial_capacity) {
   _initial_capacity = _next_power_of_2(_initial_capacity);
   return (de_vec){_item_size, _initial_capacity, 0,
                   DE_C_VEC_D_MALLOC(_initial_capacity * _item_size),
-                  DE_OPTIONS_VECTOR_DEFAULT_DESTRUCTOR};
+                  DE_OPTIONS_VECTOR_DEFAULT_DESTRUCTOR, NULL, NULL, NULL};
 }
 
 DE_CONTAINER_VECTOR_INTERNAL de_vec de_vec_create_verbose(
@@ -515,7 +1173,7 @@ DE_CONTAINER_VECTOR_INTERNAL de_vec de_vec_create_verbose(
   return (de_vec){
       _item_size, DE_OPTIONS_VECTOR_INITIAL_SIZE, 0,
       DE_C_VEC_D_MALLOC(DE_OPTIONS_VECTOR_INITIAL_SIZE * _item_size),
-      _destructor_function};
+      _destructor_function, NULL, NULL, NULL};
 }
 
 DE_CONTAINER_VECTOR_INTERNAL de_vec de_vec_create_with_capacity_verbose(
@@ -525,7 +1183,7 @@ DE_CONTAINER_VECTOR_INTERNAL de_vec de_vec_create_with_capacity_verbose(
   return (de_vec){_item_size, _initial_capacity, 0,
                   DE_OPTIONS_VECTOR_DATA_PTR_MALLOC_FUNCTION(_initial_capacity *
                                                              _item_size),
-                  _destructor_function};
+                  _destructor_function, NULL, NULL, NULL};
 }
 
 /* initialize from existing contiguous vector  */
@@ -541,40 +1199,202 @@ DE_CONTAINER_VECTOR_INTERNAL de_vec de_vec_create_from_array(
 DE_CONTAINER_VECTOR_INTERNAL de_vec
 de_vec_create_from_vector(const de_vec *const _src) {
   de_vec out = *_src;
-  usize bytes = _src->item_size * _src->used;
-  out.data = DE_C_VEC_D_MALLOC(bytes);
-  DE_C_VEC_MEMCPY(out.data, _src->data, bytes);
+  out.data = DE_C_VEC_D_MALLOC(_src->item_size * _src->capacity);
+  out.shared = NULL;
+  out.buffer_free = NULL;
+  DE_C_VEC_MEMCPY(out.data, _src->data, _src->item_size * _src->used);
   return out;
 }
 
-DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_clear(de_vec *const _vec) {
-  _vec->used = 0;
+DE_CONTAINER_VECTOR_INTERNAL de_vec de_vec_adopt(
+    const usize _item_size, u0 *_buffer, const usize _count,
+    const usize _capacity, const de_vec_buffer_free_func _free_fn) {
+#ifndef DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
+  DE_C_VEC_ASSERT(_count <= _capacity && "adopted buffer holds more items "
+                                         "than its capacity");
+  DE_C_VEC_ASSERT(_capacity && "adopted buffer needs a capacity");
+#endif
+  return (de_vec){_item_size,
+                  _capacity,
+                  _count,
+                  (DE_C_VEC_VOID_REPLACEMENT *)_buffer,
+                  DE_OPTIONS_VECTOR_DEFAULT_DESTRUCTOR,
+                  NULL,
+                  NULL,
+                  _free_fn};
 }
 
-/* call element destroyer on each item, but keep capacity*/
-DE_CONTAINER_VECTOR_INTERNAL u0
-de_vec_clear_with_destructor(de_vec *const _vec) {
-  const de_vec_destructor_func f = _vec->destructor;
-  DE_C_VEC_VOID_REPLACEMENT *data = _vec->data;
+DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_buffer_borrowed(u0 *_buffer,
+                                                       usize _bytes) {
+  (void)_buffer;
+  (void)_bytes;
+}
+
+DE_CONTAINER_VECTOR_INTERNAL de_vec_view
+de_vec_view_create(u0 *_data, const usize _count, const usize _item_size) {
+  return (de_vec_view){(DE_C_VEC_VOID_REPLACEMENT *)_data, _count, _item_size};
+}
+
+DE_CONTAINER_VECTOR_INTERNAL de_vec_view de_vec_view_of(de_vec *const _vec,
+                                                       const usize _start,
+                                                       const usize _end) {
+#ifndef DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
+  DE_C_VEC_ASSERT(_start <= _end && _end <= _vec->used &&
+                  "view range out of bounds");
+#endif
+  if (_vec->shared)
+    de_vec_make_unique(_vec);
+  return (de_vec_view){_vec->data + _start * _vec->item_size, _end - _start,
+                       _vec->item_size};
+}
+
+DE_CONTAINER_VECTOR_INTERNAL de_vec de_vec_from_view(const de_vec_view _view) {
+  /* nothing to borrow, and a zero capacity would never grow */
+  if (!_view.used)
+    return de_vec_create(_view.item_size);
+  return de_vec_adopt(_view.item_size, _view.data, _view.used, _view.used,
+                      de_vec_buffer_borrowed);
+}
+
+/* hands the buffer back to whoever owns its memory */
+DE_CONTAINER_VECTOR_INTERNAL u0 DE_C_VEC_free_buffer(de_vec *const _vec) {
+  if (_vec->buffer_free)
+    _vec->buffer_free(_vec->data, _vec->capacity * _vec->item_size);
+  else
+    DE_C_VEC_D_FREE(_vec->data);
+}
+
+/* drops this vectors reference to its buffer, frees it if it was the last */
+DE_CONTAINER_VECTOR_INTERNAL u0 DE_C_VEC_release_data(de_vec *const _vec) {
+  if (_vec->shared) {
+    if (__atomic_sub_fetch(_vec->shared, 1, __ATOMIC_ACQ_REL) == 0) {
+      DE_C_VEC_free_buffer(_vec);
+      free(_vec->shared);
+    }
+    _vec->shared = NULL;
+  } else {
+    DE_C_VEC_free_buffer(_vec);
+  }
+}
+
+/* swaps in a freshly allocated buffer of _capacity items */
+DE_CONTAINER_VECTOR_INTERNAL u0 DE_C_VEC_replace_data(
+    de_vec *const _vec, DE_C_VEC_VOID_REPLACEMENT *_new_mem,
+    const usize _capacity) {
+  DE_C_VEC_release_data(_vec);
+  _vec->data = _new_mem;
+  _vec->capacity = _capacity;
+  _vec->buffer_free = NULL;
+}
+
+/* returns true if _vec is the only owner of its buffer (and makes it
+ * exclusive again) */
+DE_CONTAINER_VECTOR_INTERNAL bool DE_C_VEC_claim_data(de_vec *const _vec) {
+  if (!_vec->shared)
+    return true;
+  /* with a count of 1 no other owner exists that could add a reference */
+  if (__atomic_load_n(_vec->shared, __ATOMIC_ACQUIRE) == 1) {
+    free(_vec->shared);
+    _vec->shared = NULL;
+    return true;
+  }
+  return false;
+}
+
+DE_CONTAINER_VECTOR_INTERNAL de_vec de_vec_snapshot(de_vec *const _src) {
+  if (!_src->shared) {
+    _src->shared = (usize *)malloc(sizeof(usize));
+    *_src->shared = 1;
+  }
+  __atomic_fetch_add(_src->shared, 1, __ATOMIC_RELAXED);
+  return *_src;
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_make_unique(de_vec *const _vec) {
+  if (DE_C_VEC_claim_data(_vec))
+    return;
+  const usize item_size = _vec->item_size;
+  DE_C_VEC_VOID_REPLACEMENT *new_mem =
+      DE_C_VEC_D_MALLOC(_vec->capacity * item_size);
+  DE_C_VEC_MEMCPY(new_mem, _vec->data, _vec->used * item_size);
+  DE_C_VEC_replace_data(_vec, new_mem, _vec->capacity);
+}
+
+#define de_vec_check_unique(_vec)                                              \
+  if (_vec->shared) {                                                          \
+    de_vec_make_unique(_vec);                                                  \
+  }
+
+DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_clear(de_vec *const _vec) {
+  _vec->used = 0;
+}
+
+/* destroys the _count items starting at _idx, one call for range destructors,
+ * nothing for trivial items */
+DE_CONTAINER_VECTOR_INTERNAL u0 DE_C_VEC_destroy_range(de_vec *const _vec,
+                                                       const usize _idx,
+                                                       const usize _count) {
   const usize item_size = _vec->item_size;
-  const DE_C_VEC_VOID_REPLACEMENT *data_end = data + item_size * _vec->used;
+  DE_C_VEC_VOID_REPLACEMENT *data = _vec->data + _idx * item_size;
+  if (_vec->range_destructor) {
+    if (_count)
+      _vec->range_destructor(data, _count, item_size);
+    return;
+  }
+  const de_vec_destructor_func f = _vec->destructor;
+  if (DE_C_VEC_DESTRUCTOR_IS_TRIVIAL(f))
+    return;
+  const DE_C_VEC_VOID_REPLACEMENT *data_end = data + item_size * _count;
   while (data != data_end) {
     f(data);
     data += item_size;
   }
+}
+
+/* like DE_C_VEC_release_data, but the owner dropping the count to 0 destroys
+ * the items first. decided on the decrement itself, so two last owners
+ * releasing at once cannot both leave the items to the other */
+DE_CONTAINER_VECTOR_INTERNAL u0
+DE_C_VEC_release_data_with_destructor(de_vec *const _vec) {
+  if (_vec->shared) {
+    if (__atomic_sub_fetch(_vec->shared, 1, __ATOMIC_ACQ_REL) == 0) {
+      DE_C_VEC_destroy_range(_vec, 0, _vec->used);
+      DE_C_VEC_free_buffer(_vec);
+      free(_vec->shared);
+    }
+    _vec->shared = NULL;
+  } else {
+    DE_C_VEC_destroy_range(_vec, 0, _vec->used);
+    DE_C_VEC_free_buffer(_vec);
+  }
+}
+
+/* call element destroyer on each item, but keep capacity*/
+DE_CONTAINER_VECTOR_INTERNAL u0
+de_vec_clear_with_destructor(de_vec *const _vec) {
+  if (!DE_C_VEC_claim_data(_vec)) {
+    /* other owners may still use the elements, only drop our reference */
+    DE_C_VEC_VOID_REPLACEMENT *new_mem =
+        DE_C_VEC_D_MALLOC(_vec->capacity * _vec->item_size);
+    DE_C_VEC_release_data_with_destructor(_vec);
+    _vec->data = new_mem;
+    _vec->buffer_free = NULL;
+    _vec->used = 0;
+    return;
+  }
+  DE_C_VEC_destroy_range(_vec, 0, _vec->used);
   _vec->used = 0;
 }
 
 /* delete entire vector */
 DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_delete(de_vec *const _vec) {
-  DE_C_VEC_D_FREE(_vec->data);
+  DE_C_VEC_release_data(_vec);
   *_vec = (de_vec){0};
 }
 
 DE_CONTAINER_VECTOR_INTERNAL u0
 de_vec_delete_with_destructor(de_vec *const _vec) {
-  de_vec_clear_with_destructor(_vec);
-  DE_C_VEC_D_FREE(_vec->data);
+  DE_C_VEC_release_data_with_destructor(_vec);
   *_vec = (de_vec){0};
 }
 
@@ -584,6 +1404,12 @@ de_vec_set_destructor(de_vec *const _vec, de_vec_destructor_func _destructor) {
   _vec->destructor = _destructor;
 }
 
+/* set or replace the range destructor function */
+DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_set_range_destructor(
+    de_vec *const _vec, de_vec_range_destructor_func _range_destructor) {
+  _vec->range_destructor = _range_destructor;
+}
+
 /*
   Info getters
 */
@@ -616,6 +1442,15 @@ DE_CONTAINER_VECTOR_INTERNAL bool de_vec_info_empty(de_vec *const _vec) {
   return _vec->used == 0;
 }
 
+DE_CONTAINER_VECTOR_INTERNAL bool de_vec_info_trivial(de_vec *const _vec) {
+  return !_vec->range_destructor &&
+         DE_C_VEC_DESTRUCTOR_IS_TRIVIAL(_vec->destructor);
+}
+
+DE_CONTAINER_VECTOR_INTERNAL bool de_vec_info_shared(de_vec *const _vec) {
+  return _vec->shared != NULL;
+}
+
 /*
   Capacity / resizing
 */
@@ -627,9 +1462,7 @@ DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_reserve(de_vec *const _vec,
   if (_vec->capacity < _size) {
     void *new_mem = DE_C_VEC_D_MALLOC(_size * _vec->item_size);
     DE_C_VEC_MEMCPY(new_mem, _vec->data, _vec->used * _vec->item_size);
-    DE_C_VEC_D_FREE(_vec->data);
-    _vec->data = new_mem;
-    _vec->capacity = _size;
+    DE_C_VEC_replace_data(_vec, new_mem, _size);
   }
 }
 
@@ -639,9 +1472,7 @@ DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_shrink_to_fit(de_vec *const _vec) {
   if (_size < _vec->capacity) {
     void *new_mem = DE_C_VEC_D_MALLOC(_size * _vec->item_size);
     DE_C_VEC_MEMCPY(new_mem, _vec->data, _vec->used * _vec->item_size);
-    DE_C_VEC_D_FREE(_vec->data);
-    _vec->data = new_mem;
-    _vec->capacity = _size;
+    DE_C_VEC_replace_data(_vec, new_mem, _size);
   }
 }
 
@@ -656,18 +1487,14 @@ DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_resize(de_vec *const _vec,
   } else {
     DE_C_VEC_MEMCPY(new_mem, _vec->data, _vec->used * _vec->item_size);
   }
-  DE_C_VEC_D_FREE(_vec->data);
-  _vec->data = new_mem;
-  _vec->capacity = _size;
+  DE_C_VEC_replace_data(_vec, new_mem, _size);
 }
 
 DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_upsize(de_vec *const _vec) {
   const usize _size = _vec->capacity * DE_OPTIONS_VECTOR_GROWTH_FACTOR;
   void *new_mem = DE_C_VEC_D_MALLOC(_size * _vec->item_size);
   DE_C_VEC_MEMCPY(new_mem, _vec->data, _vec->used * _vec->item_size);
-  _vec->capacity = _size;
-  DE_C_VEC_D_FREE(_vec->data);
-  _vec->data = new_mem;
+  DE_C_VEC_replace_data(_vec, new_mem, _size);
 }
 
 #define de_vec_check_upsize(_vec)                                              \
@@ -697,6 +1524,7 @@ DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_set(de_vec *const _vec, const usize _idx,
 #ifndef DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
   DE_C_VEC_ASSERT(_idx < _vec->used && " has to recieve a valid index");
 #endif
+  de_vec_check_unique(_vec);
   DE_C_VEC_MEMCPY((u0 *)(_vec->data + _idx * _vec->item_size), _new_element,
                   _vec->item_size);
 }
@@ -709,6 +1537,7 @@ DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_swap_elements(de_vec *const _vec,
   DE_C_VEC_ASSERT(_idx_a < _vec->used && " has to recieve a valid index");
   DE_C_VEC_ASSERT(_idx_b < _vec->used && " has to recieve a valid index");
 #endif
+  de_vec_check_unique(_vec);
   usize item_size = _vec->item_size;
   DE_C_VEC_VOID_REPLACEMENT *s1 = _vec->data + _idx_a * item_size;
   DE_C_VEC_VOID_REPLACEMENT *s2 = _vec->data + _idx_b * item_size;
@@ -727,6 +1556,7 @@ DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_swap_elements(de_vec *const _vec,
 DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_push_back(de_vec *const _vec,
                                                  const u0 *const _element) {
   de_vec_check_upsize(_vec);
+  de_vec_check_unique(_vec);
   DE_C_VEC_MEMCPY(_vec->data + _vec->used * _vec->item_size, _element,
                   _vec->item_size);
   ++_vec->used;
@@ -741,6 +1571,7 @@ DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_insert(de_vec *const _vec,
   DE_C_VEC_ASSERT(_element && "Provided element must be valid");
 #endif
   de_vec_check_upsize(_vec);
+  de_vec_check_unique(_vec);
 
   usize itemsize = _vec->item_size;
   DE_C_VEC_VOID_REPLACEMENT *accesspoint = _vec->data + _idx * itemsize;
@@ -761,6 +1592,7 @@ DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_insert_batch(de_vec *const _vec,
   DE_C_VEC_ASSERT(_elements && "Provided elements must be valid");
 #endif
   de_vec_check_upsize_n(_vec, _amount);
+  de_vec_check_unique(_vec);
   usize itemsize = _vec->item_size;
   DE_C_VEC_VOID_REPLACEMENT *accesspoint = _vec->data + _idx * itemsize;
   usize amount_size = itemsize * _amount;
@@ -771,6 +1603,78 @@ DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_insert_batch(de_vec *const _vec,
   _vec->used += _amount;
 }
 
+/* inserts _amount elements at ascending positions, moves every segment once
+ * from back to front */
+DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_insert_many(de_vec *const _vec,
+                                                   const usize *const _positions,
+                                                   const u0 *const _elements,
+                                                   const usize _amount) {
+  if (_amount == 0)
+    return;
+#ifndef DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
+  DE_C_VEC_ASSERT(_positions && _elements && "Provided elements must be valid");
+  for (usize k = 0; k < _amount; ++k) {
+    DE_C_VEC_ASSERT(_positions[k] <= _vec->used &&
+                    " has to recieve a valid index");
+    DE_C_VEC_ASSERT((k == 0 || _positions[k - 1] <= _positions[k]) &&
+                    "positions have to be ascending");
+  }
+#endif
+  de_vec_check_upsize_n(_vec, _amount);
+  de_vec_check_unique(_vec);
+  const usize itemsize = _vec->item_size;
+  const DE_C_VEC_VOID_REPLACEMENT *elements =
+      (const DE_C_VEC_VOID_REPLACEMENT *)_elements;
+  usize segment_end = _vec->used;
+  for (usize k = _amount; k-- > 0;) {
+    const usize pos = _positions[k];
+    /* original elements [pos, segment_end) end up k + 1 slots further back */
+    DE_C_VEC_MEMMOV(_vec->data + (pos + k + 1) * itemsize,
+                    _vec->data + pos * itemsize, (segment_end - pos) * itemsize);
+    DE_C_VEC_MEMCPY(_vec->data + (pos + k) * itemsize, elements + k * itemsize,
+                    itemsize);
+    segment_end = pos;
+  }
+  _vec->used += _amount;
+}
+
+/* merges from the back, every element of _src binary searches its slot so
+ * runs of _dst move as one memmove */
+DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_merge_sorted_into(de_vec *const _dst,
+                                                         de_vec *const _src,
+                                                         de_vec_cmp_func _cmp) {
+#ifndef DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
+  DE_C_VEC_ASSERT(_dst->item_size == _src->item_size &&
+                  "vectors have to store the same items");
+  DE_C_VEC_ASSERT(_dst != _src && "can not merge a vector into itself");
+#endif
+  const usize amount = _src->used;
+  if (amount == 0)
+    return;
+  de_vec_check_upsize_n(_dst, amount);
+  de_vec_check_unique(_dst);
+  const usize itemsize = _dst->item_size;
+  DE_C_VEC_VOID_REPLACEMENT *data = _dst->data;
+  usize left = _dst->used; /* unmerged prefix of _dst */
+  for (usize j = amount; j-- > 0;) {
+    const DE_C_VEC_VOID_REPLACEMENT *item = _src->data + j * itemsize;
+    /* upper bound, equal elements of _dst stay in front */
+    usize lo = 0, hi = left;
+    while (lo < hi) {
+      const usize mid = lo + (hi - lo) / 2;
+      if (_cmp(data + mid * itemsize, item) > 0)
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+    DE_C_VEC_MEMMOV(data + (lo + j + 1) * itemsize, data + lo * itemsize,
+                    (left - lo) * itemsize);
+    DE_C_VEC_MEMCPY(data + (lo + j) * itemsize, item, itemsize);
+    left = lo;
+  }
+  _dst->used += amount;
+}
+
 /* appends _src to _dst (destroys _src) */
 DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_concat(de_vec *const _dst,
                                               de_vec *const _src) {
@@ -801,7 +1705,10 @@ de_vec_pop_back_with_destructor(de_vec *const _vec) {
 #ifndef DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
   DE_C_VEC_ASSERT(_vec->used > 0 && "vector has to contain items to pop");
 #endif
-  _vec->destructor(_vec->data + (_vec->used - 1) * _vec->item_size);
+  /* other owners of a shared buffer still use the item. unsharing first
+     would copy it bitwise and destroy what the other copies still own */
+  if (DE_C_VEC_claim_data(_vec))
+    DE_C_VEC_destroy_range(_vec, _vec->used - 1, 1);
   --_vec->used;
 }
 
@@ -825,6 +1732,7 @@ DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_erase(de_vec *const _vec,
 #ifndef DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
   DE_C_VEC_ASSERT(_idx < _vec->used && " has to recieve a valid index");
 #endif
+  de_vec_check_unique(_vec);
   const usize item_size = _vec->item_size;
   DE_C_VEC_VOID_REPLACEMENT *accesspoint = _vec->data + _idx * item_size;
   DE_C_VEC_MEMMOV(accesspoint, accesspoint + item_size,
@@ -843,6 +1751,7 @@ DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_erase_batch(de_vec *const _vec,
   DE_C_VEC_ASSERT((_idx + _amount) <= _vec->used &&
                   "has to delete a valid amount of elements");
 #endif
+  de_vec_check_unique(_vec);
   const usize item_size = _vec->item_size;
   DE_C_VEC_VOID_REPLACEMENT *accesspoint = _vec->data + _idx * item_size;
   DE_C_VEC_MEMMOV(accesspoint, accesspoint + item_size * _amount,
@@ -956,19 +1865,21 @@ DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_foreach_range(de_vec *const _vec,
 /* sorts the vector based on the provided search function*/
 DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_sort(de_vec *const _vec,
                                             de_vec_cmp_func _cmp) {
+  de_vec_check_unique(_vec);
   qsort(_vec->data, _vec->used, _vec->item_size, _cmp);
 }
 
-/* sorts the vector based on the provided search function in the provided
- * range*/
+/* sorts the vector based on the provided search function in the range
+ * [_start_idx, _end_idx) */
 DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_sort_range(de_vec *const _vec,
                                                   de_vec_cmp_func _cmp,
                                                   const usize _start_idx,
                                                   const usize _end_idx) {
 #ifndef DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
-  DE_C_VEC_ASSERT(_start_idx < _vec->used && " has to recieve a valid index");
-  DE_C_VEC_ASSERT(_end_idx < _vec->used && " has to recieve a valid index");
+  DE_C_VEC_ASSERT(_start_idx <= _end_idx && " has to recieve a valid range");
+  DE_C_VEC_ASSERT(_end_idx <= _vec->used && " has to recieve a valid index");
 #endif
+  de_vec_check_unique(_vec);
   usize item_size = _vec->item_size;
   qsort(_vec->data + item_size * _start_idx, _end_idx - _start_idx, item_size,
         _cmp);
@@ -979,6 +1890,7 @@ DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_reverse(de_vec *const _vec) {
   usize used = _vec->used;
   if (used <= 1)
     return;
+  de_vec_check_unique(_vec);
 
   usize item_size = _vec->item_size;
 
@@ -993,6 +1905,1794 @@ DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_reverse(de_vec *const _vec) {
   }
 }
 
+/*
+  selection
+*/
+
+DE_CONTAINER_VECTOR_INTERNAL u0 DE_C_VEC_swap_bytes(
+    DE_C_VEC_VOID_REPLACEMENT *_a, DE_C_VEC_VOID_REPLACEMENT *_b,
+    usize _item_size) {
+  while (_item_size--) {
+    DE_C_VEC_VOID_REPLACEMENT tmp = *_a;
+    *_a++ = *_b;
+    *_b++ = tmp;
+  }
+}
+
+/* max heap over the _count elements at _base, restores the heap below _idx */
+DE_CONTAINER_VECTOR_INTERNAL u0 DE_C_VEC_heap_sift_down(
+    DE_C_VEC_VOID_REPLACEMENT *_base, usize _idx, const usize _count,
+    const usize _item_size, de_vec_cmp_func _cmp) {
+  for (;;) {
+    usize child = 2 * _idx + 1;
+    if (child >= _count)
+      return;
+    if (child + 1 < _count && _cmp(_base + child * _item_size,
+                                   _base + (child + 1) * _item_size) < 0)
+      ++child;
+    if (_cmp(_base + _idx * _item_size, _base + child * _item_size) >= 0)
+      return;
+    DE_C_VEC_swap_bytes(_base + _idx * _item_size, _base + child * _item_size,
+                        _item_size);
+    _idx = child;
+  }
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u0 DE_C_VEC_heap_sift_up(
+    DE_C_VEC_VOID_REPLACEMENT *_base, usize _idx, const usize _item_size,
+    de_vec_cmp_func _cmp) {
+  while (_idx) {
+    const usize parent = (_idx - 1) / 2;
+    if (_cmp(_base + parent * _item_size, _base + _idx * _item_size) >= 0)
+      return;
+    DE_C_VEC_swap_bytes(_base + parent * _item_size, _base + _idx * _item_size,
+                        _item_size);
+    _idx = parent;
+  }
+}
+
+/* sorts a max heap of _count elements ascending */
+DE_CONTAINER_VECTOR_INTERNAL u0 DE_C_VEC_heap_sort_heap(
+    DE_C_VEC_VOID_REPLACEMENT *_base, usize _count, const usize _item_size,
+    de_vec_cmp_func _cmp) {
+  while (_count > 1) {
+    --_count;
+    DE_C_VEC_swap_bytes(_base, _base + _count * _item_size, _item_size);
+    DE_C_VEC_heap_sift_down(_base, 0, _count, _item_size, _cmp);
+  }
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u0 DE_C_VEC_heap_sort(
+    DE_C_VEC_VOID_REPLACEMENT *_base, const usize _count,
+    const usize _item_size, de_vec_cmp_func _cmp) {
+  for (usize i = _count / 2; i-- > 0;)
+    DE_C_VEC_heap_sift_down(_base, i, _count, _item_size, _cmp);
+  DE_C_VEC_heap_sort_heap(_base, _count, _item_size, _cmp);
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u0 DE_C_VEC_insertion_sort(
+    DE_C_VEC_VOID_REPLACEMENT *_base, const usize _count,
+    const usize _item_size, de_vec_cmp_func _cmp) {
+  for (usize i = 1; i < _count; ++i) {
+    for (usize j = i; j > 0 && _cmp(_base + (j - 1) * _item_size,
+                                    _base + j * _item_size) > 0;
+         --j)
+      DE_C_VEC_swap_bytes(_base + (j - 1) * _item_size,
+                          _base + j * _item_size, _item_size);
+  }
+}
+
+/* moves the median of _a, _b, _c to _a */
+DE_CONTAINER_VECTOR_INTERNAL u0 DE_C_VEC_median_to_front(
+    DE_C_VEC_VOID_REPLACEMENT *_a, DE_C_VEC_VOID_REPLACEMENT *_b,
+    DE_C_VEC_VOID_REPLACEMENT *_c, const usize _item_size,
+    de_vec_cmp_func _cmp) {
+  if (_cmp(_b, _a) < 0)
+    DE_C_VEC_swap_bytes(_a, _b, _item_size);
+  if (_cmp(_c, _b) < 0) {
+    DE_C_VEC_swap_bytes(_b, _c, _item_size);
+    if (_cmp(_b, _a) < 0)
+      DE_C_VEC_swap_bytes(_a, _b, _item_size);
+  }
+  /* _a <= _b <= _c now */
+  DE_C_VEC_swap_bytes(_a, _b, _item_size);
+}
+
+/* partitions [_lo, _hi) around the pivot at _lo, returns its final index.
+   elements before it are <= pivot, elements after it are >= pivot */
+DE_CONTAINER_VECTOR_INTERNAL usize DE_C_VEC_partition(
+    DE_C_VEC_VOID_REPLACEMENT *_base, const usize _lo, const usize _hi,
+    const usize _item_size, de_vec_cmp_func _cmp) {
+  DE_C_VEC_VOID_REPLACEMENT *pivot = _base + _lo * _item_size;
+  usize i = _lo, j = _hi;
+  for (;;) {
+    do
+      ++i;
+    while (i < _hi && _cmp(_base + i * _item_size, pivot) < 0);
+    do
+      --j;
+    while (_cmp(_base + j * _item_size, pivot) > 0);
+    if (i >= j)
+      break;
+    DE_C_VEC_swap_bytes(_base + i * _item_size, _base + j * _item_size,
+                        _item_size);
+  }
+  DE_C_VEC_swap_bytes(pivot, _base + j * _item_size, _item_size);
+  return j;
+}
+
+/* introselect on [_lo, _hi), falls back to a heap based partial sort once the
+ * depth budget is used up */
+DE_CONTAINER_VECTOR_INTERNAL u0 DE_C_VEC_select(
+    DE_C_VEC_VOID_REPLACEMENT *_base, usize _lo, usize _hi, const usize _nth,
+    const usize _item_size, de_vec_cmp_func _cmp) {
+  usize depth = 2 * (usize)(63 - __builtin_clzll((u64)(_hi - _lo) | 1));
+  while (_hi - _lo > 16) {
+    if (depth-- == 0) {
+      DE_C_VEC_VOID_REPLACEMENT *base = _base + _lo * _item_size;
+      const usize count = _hi - _lo;
+      const usize k = _nth - _lo + 1;
+      /* max heap of the k smallest, the heap top ends up as the nth */
+      for (usize i = k / 2; i-- > 0;)
+        DE_C_VEC_heap_sift_down(base, i, k, _item_size, _cmp);
+      for (usize i = k; i < count; ++i) {
+        if (_cmp(base + i * _item_size, base) < 0) {
+          DE_C_VEC_swap_bytes(base + i * _item_size, base, _item_size);
+          DE_C_VEC_heap_sift_down(base, 0, k, _item_size, _cmp);
+        }
+      }
+      DE_C_VEC_swap_bytes(base, base + (k - 1) * _item_size, _item_size);
+      return;
+    }
+    const usize mid = _lo + (_hi - _lo) / 2;
+    DE_C_VEC_median_to_front(_base + _lo * _item_size, _base + mid * _item_size,
+                             _base + (_hi - 1) * _item_size, _item_size, _cmp);
+    const usize p = DE_C_VEC_partition(_base, _lo, _hi, _item_size, _cmp);
+    if (p == _nth)
+      return;
+    if (_nth < p)
+      _hi = p;
+    else
+      _lo = p + 1;
+  }
+  DE_C_VEC_insertion_sort(_base + _lo * _item_size, _hi - _lo, _item_size,
+                          _cmp);
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_nth_element(de_vec *const _vec,
+                                                   const usize _nth,
+                                                   de_vec_cmp_func _cmp) {
+#ifndef DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
+  DE_C_VEC_ASSERT(_nth < _vec->used && " has to recieve a valid index");
+#endif
+  de_vec_check_unique(_vec);
+  DE_C_VEC_select(_vec->data, 0, _vec->used, _nth, _vec->item_size, _cmp);
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_partial_sort(de_vec *const _vec,
+                                                    const usize _k,
+                                                    de_vec_cmp_func _cmp) {
+  const usize k = _k < _vec->used ? _k : _vec->used;
+  if (k == 0)
+    return;
+  de_vec_check_unique(_vec);
+  /* select the k smallest in O(n), then heapsort only those */
+  DE_C_VEC_select(_vec->data, 0, _vec->used, k - 1, _vec->item_size, _cmp);
+  DE_C_VEC_heap_sort(_vec->data, k - 1, _vec->item_size, _cmp);
+}
+
+DE_CONTAINER_VECTOR_INTERNAL bool de_vec_top_k_push(de_vec *const _heap,
+                                                   const usize _k,
+                                                   const u0 *const _element,
+                                                   de_vec_cmp_func _cmp) {
+  if (_k == 0)
+    return false;
+  if (_heap->used < _k) {
+    de_vec_push_back(_heap, _element);
+    DE_C_VEC_heap_sift_up(_heap->data, _heap->used - 1, _heap->item_size,
+                          _cmp);
+    return true;
+  }
+  /* the heap top is the largest kept element */
+  if (_cmp(_element, _heap->data) >= 0)
+    return false;
+  de_vec_check_unique(_heap);
+  DE_C_VEC_MEMCPY(_heap->data, _element, _heap->item_size);
+  DE_C_VEC_heap_sift_down(_heap->data, 0, _heap->used, _heap->item_size, _cmp);
+  return true;
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_top_k_finish(de_vec *const _heap,
+                                                    de_vec_cmp_func _cmp) {
+  de_vec_check_unique(_heap);
+  DE_C_VEC_heap_sort_heap(_heap->data, _heap->used, _heap->item_size, _cmp);
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_top_k(de_vec *const _vec,
+                                             const usize _k,
+                                             de_vec_cmp_func _cmp,
+                                             de_vec *const _out) {
+#ifndef DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
+  DE_C_VEC_ASSERT(_out->item_size == _vec->item_size &&
+                  "output has to store the same items");
+  DE_C_VEC_ASSERT(_out != _vec && "output can not alias the input");
+#endif
+  de_vec_clear(_out);
+  de_vec_reserve(_out, _k < _vec->used ? _k : _vec->used);
+  const usize item_size = _vec->item_size;
+  for (usize i = 0; i < _vec->used; ++i)
+    de_vec_top_k_push(_out, _k, _vec->data + i * item_size, _cmp);
+  de_vec_top_k_finish(_out, _cmp);
+}
+
+/*
+  stable sort
+  run detection and merge policy follow powersort (as in CPython's listsort),
+  merges trim their inputs and switch to galloping once one side keeps winning
+*/
+
+#define DE_C_VEC_MIN_GALLOP 7
+#define DE_C_VEC_MAX_RUNS 86
+
+typedef struct {
+  usize start;
+  usize len;
+  int power; /* power of the boundary to the next run */
+} DE_C_VEC_run;
+
+typedef struct {
+  DE_C_VEC_VOID_REPLACEMENT *base;
+  usize count;
+  usize item_size;
+  de_vec_cmp_func cmp;
+  bool indirect; /* items are pointers, cmp compares their targets */
+  DE_C_VEC_VOID_REPLACEMENT *tmp; /* allocated on first use */
+  usize min_gallop;
+  DE_C_VEC_run runs[DE_C_VEC_MAX_RUNS];
+  usize run_count;
+} DE_C_VEC_sort_state;
+
+DE_CONTAINER_VECTOR_INTERNAL DE_C_VEC_VOID_REPLACEMENT *
+DE_C_VEC_sort_tmp(DE_C_VEC_sort_state *const _st) {
+  if (!_st->tmp)
+    _st->tmp = (DE_C_VEC_VOID_REPLACEMENT *)malloc((_st->count / 2 + 1) *
+                                                  _st->item_size);
+  return _st->tmp;
+}
+
+DE_CONTAINER_VECTOR_INTERNAL int
+DE_C_VEC_sort_cmp(const DE_C_VEC_sort_state *const _st, const u0 *const _a,
+                  const u0 *const _b) {
+  if (_st->indirect)
+    return _st->cmp(*(const u0 *const *)_a, *(const u0 *const *)_b);
+  return _st->cmp(_a, _b);
+}
+
+/* first index in [0, _n) of _base where base[i] >= _key (_strict: > _key),
+   _n if there is none. exponential search from the left or right end */
+DE_CONTAINER_VECTOR_INTERNAL usize
+DE_C_VEC_gallop(const DE_C_VEC_sort_state *const _st, const u0 *const _key,
+                const DE_C_VEC_VOID_REPLACEMENT *_base, const usize _n,
+                const bool _strict, const bool _from_right) {
+#define DE_C_VEC_GALLOP_PRED(i)                                                \
+  (_strict ? DE_C_VEC_sort_cmp(_st, _base + (i) * _st->item_size, _key) > 0    \
+           : DE_C_VEC_sort_cmp(_st, _base + (i) * _st->item_size, _key) >= 0)
+  usize lo = 0, hi = _n, step = 1;
+  if (!_from_right) {
+    usize off = 0;
+    while (off < _n && !DE_C_VEC_GALLOP_PRED(off)) {
+      lo = off + 1;
+      off += step;
+      step <<= 1;
+    }
+    if (off < _n)
+      hi = off;
+  } else {
+    usize off = _n;
+    while (off > 0 && DE_C_VEC_GALLOP_PRED(off - 1)) {
+      hi = off - 1;
+      off = off > step ? off - step : 0;
+      step <<= 1;
+    }
+    lo = off;
+  }
+  while (lo < hi) {
+    const usize mid = lo + (hi - lo) / 2;
+    if (DE_C_VEC_GALLOP_PRED(mid))
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+  return lo;
+#undef DE_C_VEC_GALLOP_PRED
+}
+
+/* extends [_lo, _lo + _sorted) to [_lo, _hi) by binary insertion */
+DE_CONTAINER_VECTOR_INTERNAL u0 DE_C_VEC_binary_insertion(
+    DE_C_VEC_sort_state *const _st, const usize _lo, const usize _hi,
+    usize _sorted) {
+  const usize sz = _st->item_size;
+  DE_C_VEC_VOID_REPLACEMENT *base = _st->base + _lo * sz;
+  DE_C_VEC_VOID_REPLACEMENT *pivot = DE_C_VEC_sort_tmp(_st);
+  for (; _sorted < _hi - _lo; ++_sorted) {
+    DE_C_VEC_VOID_REPLACEMENT *item = base + _sorted * sz;
+    /* upper bound keeps equal elements in their original order */
+    const usize pos =
+        DE_C_VEC_gallop(_st, item, base, _sorted, true, true);
+    if (pos == _sorted)
+      continue;
+    DE_C_VEC_MEMCPY(pivot, item, sz);
+    DE_C_VEC_MEMMOV(base + (pos + 1) * sz, base + pos * sz,
+                    (_sorted - pos) * sz);
+    DE_C_VEC_MEMCPY(base + pos * sz, pivot, sz);
+  }
+}
+
+/* length of the run starting at _lo, descending runs are reversed */
+DE_CONTAINER_VECTOR_INTERNAL usize
+DE_C_VEC_count_run(DE_C_VEC_sort_state *const _st, const usize _lo) {
+  const usize sz = _st->item_size;
+  DE_C_VEC_VOID_REPLACEMENT *base = _st->base + _lo * sz;
+  const usize n = _st->count - _lo;
+  if (n < 2)
+    return n;
+  usize len = 2;
+  if (DE_C_VEC_sort_cmp(_st, base + sz, base) < 0) {
+    /* strictly descending, so reversing it keeps the sort stable */
+    while (len < n &&
+           DE_C_VEC_sort_cmp(_st, base + len * sz, base + (len - 1) * sz) < 0)
+      ++len;
+    for (usize i = 0; i < len / 2; ++i)
+      DE_C_VEC_swap_bytes(base + i * sz, base + (len - 1 - i) * sz, sz);
+  } else {
+    while (len < n &&
+           DE_C_VEC_sort_cmp(_st, base + len * sz, base + (len - 1) * sz) >= 0)
+      ++len;
+  }
+  return len;
+}
+
+DE_CONTAINER_VECTOR_INTERNAL usize DE_C_VEC_min_run(usize _n) {
+  usize r = 0;
+  while (_n >= 64) {
+    r |= _n & 1;
+    _n >>= 1;
+  }
+  return _n + r;
+}
+
+/* depth of the node between run 1 [_s1, _s1 + _n1) and run 2 of length _n2
+ * in the perfectly balanced merge tree over _n elements */
+DE_CONTAINER_VECTOR_INTERNAL int DE_C_VEC_node_power(const usize _s1,
+                                                     const usize _n1,
+                                                     const usize _n2,
+                                                     const usize _n) {
+  int power = 0;
+  usize a = 2 * _s1 + _n1;
+  usize b = a + _n1 + _n2;
+  for (;;) {
+    ++power;
+    if (a >= _n) {
+      a -= _n;
+      b -= _n;
+    } else if (b >= _n) {
+      break;
+    }
+    a <<= 1;
+    b <<= 1;
+  }
+  return power;
+}
+
+/* merges _a[0, _na) with the following _nb elements, _na <= _nb.
+   requires _b[0] < _a[0] and _a[_na - 1] > _b[_nb - 1] */
+DE_CONTAINER_VECTOR_INTERNAL u0 DE_C_VEC_merge_lo(
+    DE_C_VEC_sort_state *const _st, DE_C_VEC_VOID_REPLACEMENT *const _a,
+    usize _na, usize _nb) {
+  const usize sz = _st->item_size;
+  DE_C_VEC_VOID_REPLACEMENT *tmp = DE_C_VEC_sort_tmp(_st);
+  DE_C_VEC_MEMCPY(tmp, _a, _na * sz);
+  DE_C_VEC_VOID_REPLACEMENT *pa = tmp;
+  DE_C_VEC_VOID_REPLACEMENT *pb = _a + _na * sz;
+  DE_C_VEC_VOID_REPLACEMENT *dest = _a;
+  usize min_gallop = _st->min_gallop;
+
+  DE_C_VEC_MEMCPY(dest, pb, sz);
+  dest += sz, pb += sz, --_nb;
+  if (_nb == 0)
+    goto succeed;
+  if (_na == 1)
+    goto copy_b;
+
+  for (;;) {
+    usize acount = 0, bcount = 0;
+    /* one element at a time until one side wins min_gallop times */
+    do {
+      if (DE_C_VEC_sort_cmp(_st, pb, pa) < 0) {
+        DE_C_VEC_MEMCPY(dest, pb, sz);
+        dest += sz, pb += sz, --_nb;
+        ++bcount, acount = 0;
+        if (_nb == 0)
+          goto succeed;
+      } else {
+        DE_C_VEC_MEMCPY(dest, pa, sz);
+        dest += sz, pa += sz, --_na;
+        ++acount, bcount = 0;
+        if (_na == 1)
+          goto copy_b;
+      }
+    } while ((acount | bcount) < min_gallop);
+
+    /* galloping, copy whole chunks while they stay long */
+    ++min_gallop;
+    do {
+      min_gallop -= min_gallop > 1;
+      usize k = DE_C_VEC_gallop(_st, pb, pa, _na, true, false);
+      acount = k;
+      if (k) {
+        DE_C_VEC_MEMCPY(dest, pa, k * sz);
+        dest += k * sz, pa += k * sz, _na -= k;
+        if (_na == 1)
+          goto copy_b;
+        if (_na == 0)
+          goto succeed;
+      }
+      DE_C_VEC_MEMCPY(dest, pb, sz);
+      dest += sz, pb += sz, --_nb;
+      if (_nb == 0)
+        goto succeed;
+
+      k = DE_C_VEC_gallop(_st, pa, pb, _nb, false, false);
+      bcount = k;
+      if (k) {
+        DE_C_VEC_MEMMOV(dest, pb, k * sz);
+        dest += k * sz, pb += k * sz, _nb -= k;
+        if (_nb == 0)
+          goto succeed;
+      }
+      DE_C_VEC_MEMCPY(dest, pa, sz);
+      dest += sz, pa += sz, --_na;
+      if (_na == 1)
+        goto copy_b;
+    } while (acount >= DE_C_VEC_MIN_GALLOP || bcount >= DE_C_VEC_MIN_GALLOP);
+    ++min_gallop;
+  }
+
+succeed:
+  if (_na)
+    DE_C_VEC_MEMCPY(dest, pa, _na * sz);
+  _st->min_gallop = min_gallop;
+  return;
+copy_b:
+  /* the last element of a is larger than everything left in b */
+  DE_C_VEC_MEMMOV(dest, pb, _nb * sz);
+  DE_C_VEC_MEMCPY(dest + _nb * sz, pa, sz);
+  _st->min_gallop = min_gallop;
+}
+
+/* merges _a[0, _na) with the following _nb elements from the back, _nb <= _na.
+   same requirements as DE_C_VEC_merge_lo */
+DE_CONTAINER_VECTOR_INTERNAL u0 DE_C_VEC_merge_hi(
+    DE_C_VEC_sort_state *const _st, DE_C_VEC_VOID_REPLACEMENT *const _a,
+    usize _na, usize _nb) {
+  const usize sz = _st->item_size;
+  DE_C_VEC_VOID_REPLACEMENT *tmp = DE_C_VEC_sort_tmp(_st);
+  DE_C_VEC_MEMCPY(tmp, _a + _na * sz, _nb * sz);
+  usize min_gallop = _st->min_gallop;
+
+  /* _a[0, _na) and tmp[0, _nb) are left, writes go to _a[_na + _nb - 1]
+     downwards */
+#define DE_C_VEC_TAKE_A()                                                      \
+  (DE_C_VEC_MEMCPY(_a + (_na + _nb - 1) * sz, _a + (_na - 1) * sz, sz), --_na)
+#define DE_C_VEC_TAKE_B()                                                      \
+  (DE_C_VEC_MEMCPY(_a + (_na + _nb - 1) * sz, tmp + (_nb - 1) * sz, sz), --_nb)
+
+  DE_C_VEC_TAKE_A();
+  if (_na == 0)
+    goto succeed;
+  if (_nb == 1)
+    goto copy_a;
+
+  for (;;) {
+    usize acount = 0, bcount = 0;
+    do {
+      if (DE_C_VEC_sort_cmp(_st, tmp + (_nb - 1) * sz, _a + (_na - 1) * sz) <
+          0) {
+        DE_C_VEC_TAKE_A();
+        ++acount, bcount = 0;
+        if (_na == 0)
+          goto succeed;
+      } else {
+        DE_C_VEC_TAKE_B();
+        ++bcount, acount = 0;
+        if (_nb == 1)
+          goto copy_a;
+      }
+    } while ((acount | bcount) < min_gallop);
+
+    ++min_gallop;
+    do {
+      min_gallop -= min_gallop > 1;
+      /* elements of a greater than the last of b */
+      usize k =
+          _na - DE_C_VEC_gallop(_st, tmp + (_nb - 1) * sz, _a, _na, true, true);
+      acount = k;
+      if (k) {
+        DE_C_VEC_MEMMOV(_a + (_na + _nb - k) * sz, _a + (_na - k) * sz,
+                        k * sz);
+        _na -= k;
+        if (_na == 0)
+          goto succeed;
+      }
+      DE_C_VEC_TAKE_B();
+      if (_nb == 1)
+        goto copy_a;
+
+      /* elements of b greater or equal to the last of a */
+      k = _nb - DE_C_VEC_gallop(_st, _a + (_na - 1) * sz, tmp, _nb, false, true);
+      bcount = k;
+      if (k) {
+        DE_C_VEC_MEMCPY(_a + (_na + _nb - k) * sz, tmp + (_nb - k) * sz,
+                        k * sz);
+        _nb -= k;
+        if (_nb == 1)
+          goto copy_a;
+        if (_nb == 0)
+          goto succeed;
+      }
+      DE_C_VEC_TAKE_A();
+      if (_na == 0)
+        goto succeed;
+    } while (acount >= DE_C_VEC_MIN_GALLOP || bcount >= DE_C_VEC_MIN_GALLOP);
+    ++min_gallop;
+  }
+#undef DE_C_VEC_TAKE_A
+#undef DE_C_VEC_TAKE_B
+
+succeed:
+  if (_nb)
+    DE_C_VEC_MEMCPY(_a, tmp, _nb * sz);
+  _st->min_gallop = min_gallop;
+  return;
+copy_a:
+  /* the first element of b is smaller than everything left in a */
+  DE_C_VEC_MEMMOV(_a + sz, _a, _na * sz);
+  DE_C_VEC_MEMCPY(_a, tmp, sz);
+  _st->min_gallop = min_gallop;
+}
+
+/* merges runs _i and _i + 1 of the stack */
+DE_CONTAINER_VECTOR_INTERNAL u0 DE_C_VEC_merge_at(DE_C_VEC_sort_state *const _st,
+                                                  const usize _i) {
+  const usize sz = _st->item_size;
+  DE_C_VEC_run *run_a = _st->runs + _i;
+  DE_C_VEC_run *run_b = _st->runs + _i + 1;
+  DE_C_VEC_VOID_REPLACEMENT *a = _st->base + run_a->start * sz;
+  DE_C_VEC_VOID_REPLACEMENT *b = _st->base + run_b->start * sz;
+  usize na = run_a->len, nb = run_b->len;
+
+  run_a->len += nb;
+  run_a->power = run_b->power;
+  for (usize r = _i + 1; r + 1 < _st->run_count; ++r)
+    _st->runs[r] = _st->runs[r + 1];
+  --_st->run_count;
+
+  /* elements of a that are <= b[0] are already in place */
+  const usize k = DE_C_VEC_gallop(_st, b, a, na, true, false);
+  a += k * sz;
+  na -= k;
+  if (na == 0)
+    return;
+  /* elements of b that are >= the last of a are already in place */
+  nb = DE_C_VEC_gallop(_st, a + (na - 1) * sz, b, nb, false, true);
+  if (nb == 0)
+    return;
+
+  if (na <= nb)
+    DE_C_VEC_merge_lo(_st, a, na, nb);
+  else
+    DE_C_VEC_merge_hi(_st, a, na, nb);
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u0 DE_C_VEC_sort_stable(
+    DE_C_VEC_VOID_REPLACEMENT *const _base, const usize _count,
+    const usize _item_size, de_vec_cmp_func _cmp, const bool _indirect) {
+  if (_count < 2)
+    return;
+  DE_C_VEC_sort_state st = {.base = _base,
+                            .count = _count,
+                            .item_size = _item_size,
+                            .cmp = _cmp,
+                            .indirect = _indirect,
+                            .tmp = NULL,
+                            .min_gallop = DE_C_VEC_MIN_GALLOP,
+                            .run_count = 0};
+  const usize min_run = DE_C_VEC_min_run(_count);
+
+  for (usize lo = 0; lo < _count;) {
+    usize len = DE_C_VEC_count_run(&st, lo);
+    if (len < min_run) {
+      const usize forced = _count - lo < min_run ? _count - lo : min_run;
+      DE_C_VEC_binary_insertion(&st, lo, lo + forced, len);
+      len = forced;
+    }
+    if (st.run_count) {
+      DE_C_VEC_run *top = st.runs + st.run_count - 1;
+      const int power = DE_C_VEC_node_power(top->start, top->len, len, _count);
+      while (st.run_count > 1 && st.runs[st.run_count - 2].power > power)
+        DE_C_VEC_merge_at(&st, st.run_count - 2);
+      st.runs[st.run_count - 1].power = power;
+    }
+    st.runs[st.run_count++] = (DE_C_VEC_run){lo, len, 0};
+    lo += len;
+  }
+  while (st.run_count > 1)
+    DE_C_VEC_merge_at(&st, st.run_count - 2);
+  free(st.tmp);
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_sort_stable(de_vec *const _vec,
+                                                   de_vec_cmp_func _cmp) {
+  de_vec_check_unique(_vec);
+  DE_C_VEC_sort_stable(_vec->data, _vec->used, _vec->item_size, _cmp, false);
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_sort_stable_range(
+    de_vec *const _vec, de_vec_cmp_func _cmp, const usize _start_idx,
+    const usize _end_idx) {
+#ifndef DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
+  DE_C_VEC_ASSERT(_start_idx <= _end_idx && " has to recieve a valid range");
+  DE_C_VEC_ASSERT(_end_idx <= _vec->used && " has to recieve a valid index");
+#endif
+  de_vec_check_unique(_vec);
+  DE_C_VEC_sort_stable(_vec->data + _start_idx * _vec->item_size,
+                       _end_idx - _start_idx, _vec->item_size, _cmp, false);
+}
+
+/*
+  indirect sorting and permutations
+*/
+
+DE_CONTAINER_VECTOR_INTERNAL usize DE_C_VEC_index_at(const de_vec *const _idx,
+                                                     const usize _i) {
+  if (_idx->item_size == sizeof(u32))
+    return ((const u32 *)_idx->data)[_i];
+  return (usize)((const u64 *)_idx->data)[_i];
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u0 DE_C_VEC_index_set(de_vec *const _idx,
+                                                   const usize _i,
+                                                   const usize _value) {
+  if (_idx->item_size == sizeof(u32))
+    ((u32 *)_idx->data)[_i] = (u32)_value;
+  else
+    ((u64 *)_idx->data)[_i] = (u64)_value;
+}
+
+/* empties _idx and sizes it for _count indices */
+DE_CONTAINER_VECTOR_INTERNAL u0 DE_C_VEC_index_prepare(de_vec *const _idx,
+                                                       const usize _count) {
+#ifndef DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
+  DE_C_VEC_ASSERT((_idx->item_size == sizeof(u32) ||
+                   _idx->item_size == sizeof(u64)) &&
+                  "indices have to be u32 or u64");
+  DE_C_VEC_ASSERT((_idx->item_size == sizeof(u64) || _count <= UINT32_MAX) &&
+                  "u32 indices can not address the vector");
+#endif
+  de_vec_clear(_idx);
+  de_vec_check_unique(_idx);
+  de_vec_reserve(_idx, _count);
+  _idx->used = _count;
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_argsort(de_vec *const _vec,
+                                               de_vec_cmp_func _cmp,
+                                               de_vec *const _out_indices) {
+  const usize used = _vec->used;
+  const usize item_size = _vec->item_size;
+  DE_C_VEC_index_prepare(_out_indices, used);
+  /* sort pointers to the items, so only 8 bytes move per step */
+  const DE_C_VEC_VOID_REPLACEMENT **ptrs =
+      (const DE_C_VEC_VOID_REPLACEMENT **)malloc(
+          (used ? used : 1) * sizeof(DE_C_VEC_VOID_REPLACEMENT *));
+  for (usize i = 0; i < used; ++i)
+    ptrs[i] = _vec->data + i * item_size;
+  DE_C_VEC_sort_stable((DE_C_VEC_VOID_REPLACEMENT *)ptrs, used,
+                       sizeof(DE_C_VEC_VOID_REPLACEMENT *), _cmp, true);
+  for (usize i = 0; i < used; ++i)
+    DE_C_VEC_index_set(_out_indices, i,
+                       (usize)(ptrs[i] - _vec->data) / item_size);
+  free(ptrs);
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_argsort_by_key(
+    de_vec *const _vec, const usize _key_offset, const usize _key_size,
+    de_vec *const _out_indices) {
+#ifndef DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
+  DE_C_VEC_ASSERT((_key_size == 1 || _key_size == 2 || _key_size == 4 ||
+                   _key_size == 8) &&
+                  "key has to be 1, 2, 4 or 8 bytes");
+  DE_C_VEC_ASSERT(_key_offset + _key_size <= _vec->item_size &&
+                  "key has to lie inside the item");
+#endif
+  const usize used = _vec->used;
+  const usize item_size = _vec->item_size;
+  DE_C_VEC_index_prepare(_out_indices, used);
+
+  /* (key, index) pairs, ping-ponged between two buffers per byte pass */
+  u64 *keys = (u64 *)malloc((used ? used : 1) * 2 * sizeof(u64));
+  usize *idx = (usize *)malloc((used ? used : 1) * 2 * sizeof(usize));
+  u64 *keys_tmp = keys + used;
+  usize *idx_tmp = idx + used;
+  for (usize i = 0; i < used; ++i) {
+    u64 key = 0;
+    /* little endian: the low bytes of key hold the item key */
+    DE_C_VEC_MEMCPY(&key, _vec->data + i * item_size + _key_offset, _key_size);
+    keys[i] = key;
+    idx[i] = i;
+  }
+
+  for (usize shift = 0; shift < _key_size * 8; shift += 8) {
+    usize counts[256] = {0};
+    for (usize i = 0; i < used; ++i)
+      ++counts[(keys[i] >> shift) & 0xFF];
+    /* every key shares this byte, the pass would not change the order */
+    if (used == 0 || counts[(keys[0] >> shift) & 0xFF] == used)
+      continue;
+    usize sum = 0;
+    for (usize b = 0; b < 256; ++b) {
+      const usize c = counts[b];
+      counts[b] = sum;
+      sum += c;
+    }
+    for (usize i = 0; i < used; ++i) {
+      const usize pos = counts[(keys[i] >> shift) & 0xFF]++;
+      keys_tmp[pos] = keys[i];
+      idx_tmp[pos] = idx[i];
+    }
+    u64 *swap_keys = keys;
+    keys = keys_tmp;
+    keys_tmp = swap_keys;
+    usize *swap_idx = idx;
+    idx = idx_tmp;
+    idx_tmp = swap_idx;
+  }
+
+  for (usize i = 0; i < used; ++i)
+    DE_C_VEC_index_set(_out_indices, i, idx[i]);
+  free(keys < keys_tmp ? keys : keys_tmp);
+  free(idx < idx_tmp ? idx : idx_tmp);
+}
+
+DE_CONTAINER_VECTOR_INTERNAL bool
+de_vec_apply_permutation(de_vec *const _vec, de_vec *const _indices) {
+#ifndef DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
+  DE_C_VEC_ASSERT(_indices->used == _vec->used &&
+                  "permutation has to cover the vector");
+#endif
+  const usize used = _vec->used;
+  const usize item_size = _vec->item_size;
+  if (!used)
+    return true;
+  /* a repeated index would never close its cycle, check all of them first.
+     afterwards every bit is set, the cycle walk clears the ones it moved */
+  u64 *pending = (u64 *)calloc((used + 63) / 64, sizeof(u64));
+  for (usize i = 0; i < used; ++i) {
+    const usize src = DE_C_VEC_index_at(_indices, i);
+    if (src >= used || pending[src / 64] >> (src % 64) & 1) {
+      free(pending);
+      return false;
+    }
+    pending[src / 64] |= (u64)1 << (src % 64);
+  }
+
+  de_vec_check_unique(_vec);
+  DE_C_VEC_VOID_REPLACEMENT *data = _vec->data;
+  DE_C_VEC_VOID_REPLACEMENT *tmp = (DE_C_VEC_VOID_REPLACEMENT *)malloc(item_size);
+  for (usize start = 0; start < used; ++start) {
+    if (!(pending[start / 64] >> (start % 64) & 1))
+      continue;
+    usize src = DE_C_VEC_index_at(_indices, start);
+    if (src == start)
+      continue;
+    /* walk the cycle, each slot pulls its item from the slot it points to */
+    DE_C_VEC_MEMCPY(tmp, data + start * item_size, item_size);
+    usize dst = start;
+    for (;;) {
+      pending[dst / 64] &= ~((u64)1 << (dst % 64));
+      if (src == start) {
+        DE_C_VEC_MEMCPY(data + dst * item_size, tmp, item_size);
+        break;
+      }
+      DE_C_VEC_MEMCPY(data + dst * item_size, data + src * item_size,
+                      item_size);
+      dst = src;
+      src = DE_C_VEC_index_at(_indices, dst);
+    }
+  }
+  free(pending);
+  free(tmp);
+  return true;
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_gather(de_vec *const _vec,
+                                              de_vec *const _indices,
+                                              de_vec *const _out) {
+#ifndef DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
+  DE_C_VEC_ASSERT(_out->item_size == _vec->item_size &&
+                  "output has to store the same items");
+  DE_C_VEC_ASSERT(_out != _vec && "output can not alias the input");
+#endif
+  const usize count = _indices->used;
+  const usize item_size = _vec->item_size;
+  de_vec_clear(_out);
+  de_vec_check_unique(_out);
+  de_vec_reserve(_out, count);
+  for (usize i = 0; i < count; ++i) {
+    const usize src = DE_C_VEC_index_at(_indices, i);
+#ifndef DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
+    DE_C_VEC_ASSERT(src < _vec->used && "index out of range");
+#endif
+    DE_C_VEC_MEMCPY(_out->data + i * item_size, _vec->data + src * item_size,
+                    item_size);
+  }
+  _out->used = count;
+}
+
+/*
+  hashing algorithms
+*/
+
+/* temporary open addressing table, idx 0 marks an empty slot, otherwise idx - 1
+ * is the referenced position */
+typedef struct {
+  u64 hash;
+  usize idx;
+} DE_C_VEC_hslot;
+
+DE_CONTAINER_VECTOR_INTERNAL u64 DE_C_VEC_hash_mix(u64 _h) {
+  _h ^= _h >> 33;
+  _h *= 0xFF51AFD7ED558CCDull;
+  _h ^= _h >> 33;
+  _h *= 0xC4CEB9FE1A85EC53ull;
+  _h ^= _h >> 33;
+  return _h;
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u64 DE_C_VEC_hash_bytes(const u0 *_item,
+                                                     usize _size) {
+  const u8 *p = (const u8 *)_item;
+  u64 h = 0x9E3779B97F4A7C15ull ^ (u64)_size;
+  while (_size >= 8) {
+    u64 word;
+    DE_C_VEC_MEMCPY(&word, p, 8);
+    h = DE_C_VEC_hash_mix(h ^ word);
+    p += 8;
+    _size -= 8;
+  }
+  if (_size) {
+    u64 word = 0;
+    DE_C_VEC_MEMCPY(&word, p, _size);
+    h = DE_C_VEC_hash_mix(h ^ word);
+  }
+  return h;
+}
+
+/* table with at least 2 * _count slots, writes slot_count - 1 to _mask */
+DE_CONTAINER_VECTOR_INTERNAL DE_C_VEC_hslot *
+DE_C_VEC_htable_create(const usize _count, usize *const _mask) {
+  const usize slots = _next_power_of_2(_count < 8 ? 16 : _count * 2);
+  *_mask = slots - 1;
+  return (DE_C_VEC_hslot *)calloc(slots, sizeof(DE_C_VEC_hslot));
+}
+
+/* looks for an element equal to _item among the referenced positions of _base.
+   inserts _idx for it if none is found. returns the referenced position */
+DE_CONTAINER_VECTOR_INTERNAL usize DE_C_VEC_htable_insert_item(
+    DE_C_VEC_hslot *const _table, const usize _mask, const u8 *const _base,
+    const usize _item_size, const u0 *const _item, const usize _idx,
+    de_vec_hash_func _hash, de_vec_cmp_func _cmp) {
+  const u64 hash =
+      _hash ? _hash(_item) : DE_C_VEC_hash_bytes(_item, _item_size);
+  usize pos = (usize)DE_C_VEC_hash_mix(hash) & _mask;
+  for (;; pos = (pos + 1) & _mask) {
+    DE_C_VEC_hslot *slot = _table + pos;
+    if (!slot->idx) {
+      slot->hash = hash;
+      slot->idx = _idx + 1;
+      return _idx;
+    }
+    if (slot->hash != hash)
+      continue;
+    const u8 *other = _base + (slot->idx - 1) * _item_size;
+    if (_cmp ? _cmp(other, _item) == 0
+             : DE_C_VEC_MEMCMP(other, _item, _item_size) == 0)
+      return slot->idx - 1;
+  }
+}
+
+DE_CONTAINER_VECTOR_INTERNAL usize de_vec_unique_hashed(
+    de_vec *const _vec, de_vec_hash_func _hash,
+    de_vec_cmp_func _cmp /* comparator: returns 0 when equal */) {
+  de_vec_check_unique(_vec);
+  const usize used = _vec->used;
+  const usize item_size = _vec->item_size;
+  usize mask;
+  DE_C_VEC_hslot *table = DE_C_VEC_htable_create(used, &mask);
+
+  /* kept elements are compacted to the front, the table references their new
+     position so later duplicates compare against the kept copy */
+  usize kept = 0;
+  for (usize i = 0; i < used; ++i) {
+    DE_C_VEC_VOID_REPLACEMENT *item = _vec->data + i * item_size;
+    if (i != kept)
+      DE_C_VEC_MEMCPY(_vec->data + kept * item_size, item, item_size);
+    if (DE_C_VEC_htable_insert_item(table, mask, _vec->data, item_size,
+                                    _vec->data + kept * item_size, kept, _hash,
+                                    _cmp) == kept)
+      ++kept;
+  }
+  free(table);
+  _vec->used = kept;
+  return used - kept;
+}
+
+DE_CONTAINER_VECTOR_INTERNAL usize de_vec_count_distinct(
+    de_vec *const _vec, de_vec_hash_func _hash,
+    de_vec_cmp_func _cmp /* comparator: returns 0 when equal */) {
+  const usize item_size = _vec->item_size;
+  usize mask;
+  DE_C_VEC_hslot *table = DE_C_VEC_htable_create(_vec->used, &mask);
+
+  usize distinct = 0;
+  for (usize i = 0; i < _vec->used; ++i) {
+    if (DE_C_VEC_htable_insert_item(table, mask, _vec->data, item_size,
+                                    _vec->data + i * item_size, i, _hash,
+                                    _cmp) == i)
+      ++distinct;
+  }
+  free(table);
+  return distinct;
+}
+
+DE_CONTAINER_VECTOR_INTERNAL usize de_vec_group_by(de_vec *const _vec,
+                                                   de_vec_key_func _key,
+                                                   u0 *_data,
+                                                   de_vec *const _out,
+                                                   de_vec *const _out_offsets) {
+#ifndef DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
+  DE_C_VEC_ASSERT(_out->item_size == _vec->item_size &&
+                  "output has to store the same items");
+  DE_C_VEC_ASSERT(_out_offsets->item_size == sizeof(usize) &&
+                  "offsets have to be usize");
+  DE_C_VEC_ASSERT(_out != _vec && "output can not alias the input");
+#endif
+  const usize used = _vec->used;
+  const usize item_size = _vec->item_size;
+  usize mask;
+  DE_C_VEC_hslot *table = DE_C_VEC_htable_create(used, &mask);
+  usize *group_of = (usize *)malloc((used ? used : 1) * sizeof(usize));
+
+  /* pass 1: assign group ids in order of first appearance and count them,
+     counts are stored shifted by one so the prefix sum yields start offsets */
+  de_vec_clear(_out_offsets);
+  de_vec_check_unique(_out_offsets);
+  de_vec_reserve(_out_offsets, used + 1);
+  usize *counts = (usize *)_out_offsets->data;
+  counts[0] = 0;
+  usize groups = 0;
+  for (usize i = 0; i < used; ++i) {
+    const u64 key = _key(_vec->data + i * item_size, _data);
+    usize pos = (usize)DE_C_VEC_hash_mix(key) & mask;
+    while (table[pos].idx && table[pos].hash != key)
+      pos = (pos + 1) & mask;
+    if (!table[pos].idx) {
+      table[pos].hash = key;
+      table[pos].idx = ++groups;
+      counts[groups] = 0;
+    }
+    group_of[i] = table[pos].idx - 1;
+    ++counts[table[pos].idx];
+  }
+  free(table);
+
+  for (usize g = 1; g <= groups; ++g)
+    counts[g] += counts[g - 1];
+  _out_offsets->used = groups + 1;
+
+  /* pass 2: scatter, counts[g] acts as the write cursor of group g */
+  de_vec_clear(_out);
+  de_vec_check_unique(_out);
+  de_vec_reserve(_out, used);
+  for (usize i = 0; i < used; ++i) {
+    DE_C_VEC_MEMCPY(_out->data + counts[group_of[i]]++ * item_size,
+                    _vec->data + i * item_size, item_size);
+  }
+  _out->used = used;
+  free(group_of);
+
+  /* cursors now hold the end of each group, shift them back into starts */
+  for (usize g = groups; g > 0; --g)
+    counts[g] = counts[g - 1];
+  counts[0] = 0;
+  return groups;
+}
+
+/*
+  reductions and prefix sums
+*/
+
+typedef struct {
+  de_vec *vec;
+  de_vec_combine_func combine;
+  u0 *data;
+  DE_C_VEC_VOID_REPLACEMENT *partials; /* one item per block */
+  const DE_C_VEC_VOID_REPLACEMENT *carries;
+  bool inclusive;
+} DE_C_VEC_fold_ctx;
+
+/* folds [_begin, _end) of the vector into _acc */
+DE_CONTAINER_VECTOR_INTERNAL u0 DE_C_VEC_fold_range(
+    const DE_C_VEC_fold_ctx *const _ctx, u0 *const _acc, const usize _begin,
+    const usize _end) {
+  const usize item_size = _ctx->vec->item_size;
+  const DE_C_VEC_VOID_REPLACEMENT *item = _ctx->vec->data + _begin * item_size;
+  for (usize i = _begin; i < _end; ++i, item += item_size)
+    _ctx->combine(_acc, item, _ctx->data);
+}
+
+/* block partial: first element of the block folded with the rest, so no
+ * identity element is needed */
+DE_CONTAINER_VECTOR_INTERNAL u0 DE_C_VEC_fold_block(const usize _block,
+                                                    const usize _begin,
+                                                    const usize _end,
+                                                    u0 *_ctx) {
+  DE_C_VEC_fold_ctx *ctx = (DE_C_VEC_fold_ctx *)_ctx;
+  const usize item_size = ctx->vec->item_size;
+  if (_begin == _end)
+    return;
+  u0 *acc = ctx->partials + _block * item_size;
+  DE_C_VEC_MEMCPY(acc, ctx->vec->data + _begin * item_size, item_size);
+  DE_C_VEC_fold_range(ctx, acc, _begin + 1, _end);
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u0 DE_C_VEC_scan_block(const usize _block,
+                                                    const usize _begin,
+                                                    const usize _end,
+                                                    u0 *_ctx) {
+  DE_C_VEC_fold_ctx *ctx = (DE_C_VEC_fold_ctx *)_ctx;
+  const usize item_size = ctx->vec->item_size;
+  /* partials are free again after the carries were computed, reuse them as
+     running prefix and the carry slot as scratch for exclusive scans */
+  u0 *carry = ctx->partials + _block * item_size;
+  DE_C_VEC_VOID_REPLACEMENT *item = ctx->vec->data + _begin * item_size;
+  DE_C_VEC_MEMCPY(carry, ctx->carries + _block * item_size, item_size);
+  if (ctx->inclusive) {
+    for (usize i = _begin; i < _end; ++i, item += item_size) {
+      ctx->combine(carry, item, ctx->data);
+      DE_C_VEC_MEMCPY(item, carry, item_size);
+    }
+  } else {
+    u0 *tmp = (u0 *)(ctx->carries + _block * item_size);
+    for (usize i = _begin; i < _end; ++i, item += item_size) {
+      DE_C_VEC_MEMCPY(tmp, item, item_size);
+      DE_C_VEC_MEMCPY(item, carry, item_size);
+      ctx->combine(carry, tmp, ctx->data);
+    }
+  }
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_reduce(de_vec *const _vec,
+                                              u0 *const _acc,
+                                              de_vec_combine_func _combine,
+                                              u0 *_data, const usize _threads) {
+  DE_C_VEC_fold_ctx ctx = {_vec, _combine, _data, NULL, NULL, false};
+  const usize blocks = DE_C_VEC_block_count(
+      _vec->used, DE_OPTIONS_VECTOR_PARALLEL_MIN_BLOCK, _threads);
+  if (blocks == 1) {
+    DE_C_VEC_fold_range(&ctx, _acc, 0, _vec->used);
+    return;
+  }
+  ctx.partials =
+      (DE_C_VEC_VOID_REPLACEMENT *)malloc(blocks * _vec->item_size);
+  DE_C_VEC_parallel_blocks(_vec->used, blocks, DE_C_VEC_fold_block, &ctx);
+  for (usize b = 0; b < blocks; ++b)
+    _combine(_acc, ctx.partials + b * _vec->item_size, _data);
+  free(ctx.partials);
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_scan(de_vec *const _vec,
+                                            const u0 *const _init,
+                                            de_vec_combine_func _combine,
+                                            u0 *_data, const bool _inclusive,
+                                            const usize _threads) {
+  de_vec_check_unique(_vec);
+  const usize item_size = _vec->item_size;
+  const usize blocks = DE_C_VEC_block_count(
+      _vec->used, DE_OPTIONS_VECTOR_PARALLEL_MIN_BLOCK, _threads);
+  DE_C_VEC_VOID_REPLACEMENT *partials =
+      (DE_C_VEC_VOID_REPLACEMENT *)malloc(blocks * item_size);
+  DE_C_VEC_VOID_REPLACEMENT *carries =
+      (DE_C_VEC_VOID_REPLACEMENT *)malloc(blocks * item_size);
+  DE_C_VEC_fold_ctx ctx = {_vec,     _combine, _data,
+                           partials, carries,  _inclusive};
+
+  /* pass 1: fold each block, then chain the partials into block carries */
+  DE_C_VEC_MEMCPY(carries, _init, item_size);
+  if (blocks > 1) {
+    DE_C_VEC_parallel_blocks(_vec->used, blocks, DE_C_VEC_fold_block, &ctx);
+    for (usize b = 1; b < blocks; ++b) {
+      DE_C_VEC_MEMCPY(carries + b * item_size, carries + (b - 1) * item_size,
+                      item_size);
+      _combine(carries + b * item_size, partials + (b - 1) * item_size, _data);
+    }
+  }
+
+  /* pass 2: scan each block starting from its carry */
+  DE_C_VEC_parallel_blocks(_vec->used, blocks, DE_C_VEC_scan_block, &ctx);
+  free(carries);
+  free(partials);
+}
+
+/*
+  typed kernels, [_begin, _end) of _src
+*/
+
+DE_CONTAINER_VECTOR_INTERNAL u64 DE_C_VEC_sum_u32_kernel(const u32 *_src,
+                                                         usize _begin,
+                                                         const usize _end) {
+  u64 out = 0;
+#ifdef __SSE2__
+  const __m128i zero = _mm_setzero_si128();
+  __m128i acc_lo = zero, acc_hi = zero;
+  for (; _begin + 4 <= _end; _begin += 4) {
+    const __m128i x = _mm_loadu_si128((const __m128i *)(_src + _begin));
+    acc_lo = _mm_add_epi64(acc_lo, _mm_unpacklo_epi32(x, zero));
+    acc_hi = _mm_add_epi64(acc_hi, _mm_unpackhi_epi32(x, zero));
+  }
+  u64 lanes[2];
+  _mm_storeu_si128((__m128i *)lanes, _mm_add_epi64(acc_lo, acc_hi));
+  out = lanes[0] + lanes[1];
+#endif
+  for (; _begin < _end; ++_begin)
+    out += _src[_begin];
+  return out;
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u64 DE_C_VEC_sum_u64_kernel(const u64 *_src,
+                                                         usize _begin,
+                                                         const usize _end) {
+  u64 out = 0;
+#ifdef __SSE2__
+  __m128i acc0 = _mm_setzero_si128(), acc1 = _mm_setzero_si128();
+  for (; _begin + 4 <= _end; _begin += 4) {
+    acc0 = _mm_add_epi64(
+        acc0, _mm_loadu_si128((const __m128i *)(_src + _begin)));
+    acc1 = _mm_add_epi64(
+        acc1, _mm_loadu_si128((const __m128i *)(_src + _begin + 2)));
+  }
+  u64 lanes[2];
+  _mm_storeu_si128((__m128i *)lanes, _mm_add_epi64(acc0, acc1));
+  out = lanes[0] + lanes[1];
+#endif
+  for (; _begin < _end; ++_begin)
+    out += _src[_begin];
+  return out;
+}
+
+DE_CONTAINER_VECTOR_INTERNAL f64 DE_C_VEC_sum_f32_kernel(const f32 *_src,
+                                                         usize _begin,
+                                                         const usize _end) {
+  f64 out = 0;
+#ifdef __SSE2__
+  __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+  for (; _begin + 4 <= _end; _begin += 4) {
+    const __m128 x = _mm_loadu_ps(_src + _begin);
+    acc0 = _mm_add_pd(acc0, _mm_cvtps_pd(x));
+    acc1 = _mm_add_pd(acc1, _mm_cvtps_pd(_mm_movehl_ps(x, x)));
+  }
+  f64 lanes[2];
+  _mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+  out = lanes[0] + lanes[1];
+#endif
+  for (; _begin < _end; ++_begin)
+    out += _src[_begin];
+  return out;
+}
+
+DE_CONTAINER_VECTOR_INTERNAL f64 DE_C_VEC_sum_f64_kernel(const f64 *_src,
+                                                         usize _begin,
+                                                         const usize _end) {
+  f64 out = 0;
+#ifdef __SSE2__
+  __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+  for (; _begin + 4 <= _end; _begin += 4) {
+    acc0 = _mm_add_pd(acc0, _mm_loadu_pd(_src + _begin));
+    acc1 = _mm_add_pd(acc1, _mm_loadu_pd(_src + _begin + 2));
+  }
+  f64 lanes[2];
+  _mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+  out = lanes[0] + lanes[1];
+#endif
+  for (; _begin < _end; ++_begin)
+    out += _src[_begin];
+  return out;
+}
+
+/* in place inclusive / exclusive prefix sum of [_begin, _end) starting from
+ * _carry, returns the carry after the range */
+DE_CONTAINER_VECTOR_INTERNAL u32 DE_C_VEC_scan_u32_kernel(u32 *_dst,
+                                                          usize _begin,
+                                                          const usize _end,
+                                                          u32 _carry,
+                                                          const bool _incl) {
+#ifdef __SSE2__
+  for (; _begin + 4 <= _end; _begin += 4) {
+    const __m128i x = _mm_loadu_si128((const __m128i *)(_dst + _begin));
+    __m128i s = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+    s = _mm_add_epi32(s, _mm_slli_si128(s, 8));
+    s = _mm_add_epi32(s, _mm_set1_epi32((int)_carry));
+    _mm_storeu_si128((__m128i *)(_dst + _begin),
+                     _incl ? s : _mm_sub_epi32(s, x));
+    _carry = (u32)_mm_cvtsi128_si32(_mm_shuffle_epi32(s, 0xFF));
+  }
+#endif
+  for (; _begin < _end; ++_begin) {
+    const u32 x = _dst[_begin];
+    _dst[_begin] = _incl ? _carry + x : _carry;
+    _carry += x;
+  }
+  return _carry;
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u64 DE_C_VEC_scan_u64_kernel(u64 *_dst,
+                                                          usize _begin,
+                                                          const usize _end,
+                                                          u64 _carry,
+                                                          const bool _incl) {
+#ifdef __SSE2__
+  for (; _begin + 2 <= _end; _begin += 2) {
+    const __m128i x = _mm_loadu_si128((const __m128i *)(_dst + _begin));
+    __m128i s = _mm_add_epi64(x, _mm_slli_si128(x, 8));
+    s = _mm_add_epi64(s, _mm_set1_epi64x((long long)_carry));
+    _mm_storeu_si128((__m128i *)(_dst + _begin),
+                     _incl ? s : _mm_sub_epi64(s, x));
+    _carry = (u64)_mm_cvtsi128_si64(_mm_unpackhi_epi64(s, s));
+  }
+#endif
+  for (; _begin < _end; ++_begin) {
+    const u64 x = _dst[_begin];
+    _dst[_begin] = _incl ? _carry + x : _carry;
+    _carry += x;
+  }
+  return _carry;
+}
+
+typedef struct {
+  u0 *src;
+  u64 *sums_u;   /* per block */
+  f64 *sums_f;   /* per block */
+  bool inclusive;
+} DE_C_VEC_typed_ctx;
+
+#define DE_C_VEC_TYPED_BLOCK_FUNC(_name, T, _sums, _body)                      \
+  DE_CONTAINER_VECTOR_INTERNAL u0 _name(const usize _block,                    \
+                                        const usize _begin, const usize _end,  \
+                                        u0 *_ctx) {                            \
+    DE_C_VEC_typed_ctx *ctx = (DE_C_VEC_typed_ctx *)_ctx;                      \
+    T *src = (T *)ctx->src;                                                    \
+    ctx->_sums[_block] = _body;                                                \
+  }
+
+DE_C_VEC_TYPED_BLOCK_FUNC(DE_C_VEC_sum_u32_block, u32, sums_u,
+                          DE_C_VEC_sum_u32_kernel(src, _begin, _end))
+DE_C_VEC_TYPED_BLOCK_FUNC(DE_C_VEC_sum_u64_block, u64, sums_u,
+                          DE_C_VEC_sum_u64_kernel(src, _begin, _end))
+DE_C_VEC_TYPED_BLOCK_FUNC(DE_C_VEC_sum_f32_block, f32, sums_f,
+                          DE_C_VEC_sum_f32_kernel(src, _begin, _end))
+DE_C_VEC_TYPED_BLOCK_FUNC(DE_C_VEC_sum_f64_block, f64, sums_f,
+                          DE_C_VEC_sum_f64_kernel(src, _begin, _end))
+/* on the second pass sums_u holds the carry of each block */
+DE_C_VEC_TYPED_BLOCK_FUNC(DE_C_VEC_scan_u32_block, u32, sums_u,
+                          DE_C_VEC_scan_u32_kernel(src, _begin, _end,
+                                                   (u32)ctx->sums_u[_block],
+                                                   ctx->inclusive))
+DE_C_VEC_TYPED_BLOCK_FUNC(DE_C_VEC_scan_u64_block, u64, sums_u,
+                          DE_C_VEC_scan_u64_kernel(src, _begin, _end,
+                                                   ctx->sums_u[_block],
+                                                   ctx->inclusive))
+
+DE_CONTAINER_VECTOR_INTERNAL u64 DE_C_VEC_sum_u(de_vec *const _vec,
+                                                const usize _threads,
+                                                DE_C_VEC_block_func _func) {
+  const usize blocks = DE_C_VEC_block_count(
+      _vec->used, DE_OPTIONS_VECTOR_PARALLEL_MIN_BLOCK, _threads);
+  u64 *sums = (u64 *)malloc(blocks * sizeof(u64));
+  DE_C_VEC_typed_ctx ctx = {_vec->data, sums, NULL, false};
+  DE_C_VEC_parallel_blocks(_vec->used, blocks, _func, &ctx);
+  u64 out = 0;
+  for (usize b = 0; b < blocks; ++b)
+    out += sums[b];
+  free(sums);
+  return out;
+}
+
+DE_CONTAINER_VECTOR_INTERNAL f64 DE_C_VEC_sum_f(de_vec *const _vec,
+                                                const usize _threads,
+                                                DE_C_VEC_block_func _func) {
+  const usize blocks = DE_C_VEC_block_count(
+      _vec->used, DE_OPTIONS_VECTOR_PARALLEL_MIN_BLOCK, _threads);
+  f64 *sums = (f64 *)malloc(blocks * sizeof(f64));
+  DE_C_VEC_typed_ctx ctx = {_vec->data, NULL, sums, false};
+  DE_C_VEC_parallel_blocks(_vec->used, blocks, _func, &ctx);
+  f64 out = 0;
+  for (usize b = 0; b < blocks; ++b)
+    out += sums[b];
+  free(sums);
+  return out;
+}
+
+/* pass 1 sums the blocks, pass 2 scans each block from its carry */
+DE_CONTAINER_VECTOR_INTERNAL u0 DE_C_VEC_scan_sum(de_vec *const _vec,
+                                                  const bool _inclusive,
+                                                  const usize _threads,
+                                                  DE_C_VEC_block_func _sum,
+                                                  DE_C_VEC_block_func _scan) {
+  de_vec_check_unique(_vec);
+  const usize blocks = DE_C_VEC_block_count(
+      _vec->used, DE_OPTIONS_VECTOR_PARALLEL_MIN_BLOCK, _threads);
+  u64 *sums = (u64 *)malloc(blocks * sizeof(u64));
+  DE_C_VEC_typed_ctx ctx = {_vec->data, sums, NULL, _inclusive};
+  u64 carry = 0;
+  if (blocks > 1) {
+    DE_C_VEC_parallel_blocks(_vec->used, blocks, _sum, &ctx);
+    for (usize b = 0; b < blocks; ++b) {
+      const u64 block_sum = sums[b];
+      sums[b] = carry;
+      carry += block_sum;
+    }
+  } else {
+    sums[0] = 0;
+  }
+  DE_C_VEC_parallel_blocks(_vec->used, blocks, _scan, &ctx);
+  free(sums);
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u64 de_vec_sum_u32(de_vec *const _vec,
+                                                const usize _threads) {
+#ifndef DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
+  DE_C_VEC_ASSERT(_vec->item_size == sizeof(u32) && "vector has to hold u32");
+#endif
+  return DE_C_VEC_sum_u(_vec, _threads, DE_C_VEC_sum_u32_block);
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u64 de_vec_sum_u64(de_vec *const _vec,
+                                                const usize _threads) {
+#ifndef DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
+  DE_C_VEC_ASSERT(_vec->item_size == sizeof(u64) && "vector has to hold u64");
+#endif
+  return DE_C_VEC_sum_u(_vec, _threads, DE_C_VEC_sum_u64_block);
+}
+
+DE_CONTAINER_VECTOR_INTERNAL f64 de_vec_sum_f32(de_vec *const _vec,
+                                                const usize _threads) {
+#ifndef DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
+  DE_C_VEC_ASSERT(_vec->item_size == sizeof(f32) && "vector has to hold f32");
+#endif
+  return DE_C_VEC_sum_f(_vec, _threads, DE_C_VEC_sum_f32_block);
+}
+
+DE_CONTAINER_VECTOR_INTERNAL f64 de_vec_sum_f64(de_vec *const _vec,
+                                                const usize _threads) {
+#ifndef DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
+  DE_C_VEC_ASSERT(_vec->item_size == sizeof(f64) && "vector has to hold f64");
+#endif
+  return DE_C_VEC_sum_f(_vec, _threads, DE_C_VEC_sum_f64_block);
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_scan_sum_u32(de_vec *const _vec,
+                                                    const bool _inclusive,
+                                                    const usize _threads) {
+#ifndef DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
+  DE_C_VEC_ASSERT(_vec->item_size == sizeof(u32) && "vector has to hold u32");
+#endif
+  DE_C_VEC_scan_sum(_vec, _inclusive, _threads, DE_C_VEC_sum_u32_block,
+                    DE_C_VEC_scan_u32_block);
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u0 de_vec_scan_sum_u64(de_vec *const _vec,
+                                                    const bool _inclusive,
+                                                    const usize _threads) {
+#ifndef DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
+  DE_C_VEC_ASSERT(_vec->item_size == sizeof(u64) && "vector has to hold u64");
+#endif
+  DE_C_VEC_scan_sum(_vec, _inclusive, _threads, DE_C_VEC_sum_u64_block,
+                    DE_C_VEC_scan_u64_block);
+}
+
+/*
+  external sorting
+*/
+
+typedef struct {
+  FILE *file;
+  usize count;
+} DE_C_VEC_ext_run;
+
+/* buffered reader over one run */
+typedef struct {
+  FILE *file;
+  usize left; /* items still in the file */
+  DE_C_VEC_VOID_REPLACEMENT *buf;
+  usize pos, len; /* bytes */
+} DE_C_VEC_ext_src;
+
+/* either buffers raw items for a file or hands them to a callback */
+typedef struct {
+  FILE *file;
+  de_vec_extsort_emit_func emit;
+  u0 *data;
+  DE_C_VEC_VOID_REPLACEMENT *buf;
+  usize len, cap; /* bytes */
+  bool failed;
+} DE_C_VEC_ext_out;
+
+DE_CONTAINER_VECTOR_INTERNAL de_vec_extsort
+de_vec_extsort_create(const usize _item_size, de_vec_cmp_func _cmp,
+                      const de_vec_extsort_config *const _config) {
+  usize memory = DE_OPTIONS_VECTOR_EXTSORT_MEMORY;
+  usize fan_in = DE_OPTIONS_VECTOR_EXTSORT_FAN_IN;
+  const char *temp_dir = NULL;
+  if (_config) {
+    if (_config->memory_limit)
+      memory = _config->memory_limit;
+    if (_config->fan_in)
+      fan_in = _config->fan_in;
+    temp_dir = _config->temp_dir;
+  }
+#ifndef DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
+  DE_C_VEC_ASSERT(_item_size && _cmp && " has to recieve an item size and cmp");
+  DE_C_VEC_ASSERT(fan_in >= 2 && " fan in has to be at least 2");
+#endif
+  /* sorting a run merges through run_items / 2 + 1 scratch items, both have
+     to fit into the budget together */
+  const usize memory_items = memory / _item_size;
+  usize run_items = memory_items ? (memory_items - 1) / 3 * 2 : 0;
+  if (run_items < 2)
+    run_items = 2;
+  /* the merge holds fan_in input buffers and one output buffer */
+  usize io_items = memory / (fan_in + 1) / _item_size;
+  if (io_items < 1)
+    io_items = 1;
+  de_vec_extsort out = {0};
+  out.item_size = _item_size;
+  out.cmp = _cmp;
+  out.fan_in = fan_in;
+  out.io_buffer_size = io_items * _item_size;
+  out.run_items = run_items;
+  out.temp_dir = temp_dir;
+  out.runs = de_vec_create(sizeof(DE_C_VEC_ext_run));
+  return out;
+}
+
+/* unlinked temporary file, removed by the os once closed */
+DE_CONTAINER_VECTOR_INTERNAL FILE *DE_C_VEC_ext_tmpfile(const char *_dir) {
+  FILE *f = NULL;
+#ifndef _WIN32
+  if (_dir) {
+    static const char name[] = "/de_vec_extsort_XXXXXX";
+    const usize len = strlen(_dir);
+    char *path = (char *)malloc(len + sizeof(name));
+    memcpy(path, _dir, len);
+    memcpy(path + len, name, sizeof(name));
+    const int fd = mkstemp(path);
+    if (fd >= 0) {
+      unlink(path);
+      f = fdopen(fd, "w+b");
+      if (!f)
+        close(fd);
+    }
+    free(path);
+  } else
+#else
+  (void)_dir;
+#endif
+  {
+    f = tmpfile();
+  }
+  /* all reads and writes are already large blocks */
+  if (f)
+    setvbuf(f, NULL, _IONBF, 0);
+  return f;
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u0 DE_C_VEC_ext_flush(DE_C_VEC_ext_out *_out) {
+  if (_out->len && fwrite(_out->buf, 1, _out->len, _out->file) != _out->len)
+    _out->failed = true;
+  _out->len = 0;
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u0 DE_C_VEC_ext_put(DE_C_VEC_ext_out *_out,
+                                                 const u0 *_item,
+                                                 const usize _item_size) {
+  if (_out->emit) {
+    _out->emit(_item, _out->data);
+    return;
+  }
+  if (_out->len + _item_size > _out->cap)
+    DE_C_VEC_ext_flush(_out);
+  DE_C_VEC_MEMCPY(_out->buf + _out->len, _item, _item_size);
+  _out->len += _item_size;
+}
+
+/* reads the next block of a run, a short read ends the run early */
+DE_CONTAINER_VECTOR_INTERNAL bool DE_C_VEC_ext_refill(DE_C_VEC_ext_src *_src,
+                                                      const usize _item_size,
+                                                      const usize _cap_items) {
+  const usize items = _src->left < _cap_items ? _src->left : _cap_items;
+  _src->pos = 0;
+  _src->len = 0;
+  if (!items)
+    return true;
+  const usize got = fread(_src->buf, _item_size, items, _src->file);
+  _src->len = got * _item_size;
+  _src->left = got == items ? _src->left - items : 0;
+  return got == items;
+}
+
+/* strict order of the current heads, exhausted runs lose, ties go to the
+ * earlier run so the merge stays stable */
+DE_CONTAINER_VECTOR_INTERNAL bool
+DE_C_VEC_ext_less(const DE_C_VEC_ext_src *_src, const usize _a,
+                  const usize _b, de_vec_cmp_func _cmp) {
+  if (_src[_a].pos == _src[_a].len)
+    return false;
+  if (_src[_b].pos == _src[_b].len)
+    return true;
+  const int c = _cmp(_src[_a].buf + _src[_a].pos, _src[_b].buf + _src[_b].pos);
+  return c < 0 || (c == 0 && _a < _b);
+}
+
+/* k way merge of _runs[0, _k) into _out with a loser tree, closes the runs */
+DE_CONTAINER_VECTOR_INTERNAL bool DE_C_VEC_ext_merge(de_vec_extsort *_sorter,
+                                                     DE_C_VEC_ext_run *_runs,
+                                                     const usize _k,
+                                                     DE_C_VEC_ext_out *_out) {
+  const usize item_size = _sorter->item_size;
+  const usize cap_items = _sorter->io_buffer_size / item_size;
+  de_vec_cmp_func cmp = _sorter->cmp;
+  bool ok = true;
+
+  DE_C_VEC_ext_src *src =
+      (DE_C_VEC_ext_src *)malloc(_k * sizeof(DE_C_VEC_ext_src));
+  DE_C_VEC_VOID_REPLACEMENT *bufs =
+      (DE_C_VEC_VOID_REPLACEMENT *)malloc(_k * _sorter->io_buffer_size);
+  /* tree[0] is the winner, tree[1, k) the losers of the inner nodes, leaves
+   * are the virtual nodes [k, 2k) */
+  usize *tree = (usize *)malloc(3 * _k * sizeof(usize));
+  usize *win = tree + _k;
+  usize total = 0;
+  for (usize i = 0; i < _k; ++i) {
+    src[i] = (DE_C_VEC_ext_src){_runs[i].file, _runs[i].count,
+                                bufs + i * _sorter->io_buffer_size, 0, 0};
+    total += _runs[i].count;
+    if (fseek(src[i].file, 0, SEEK_SET) != 0)
+      src[i].left = 0, ok = false;
+    ok &= DE_C_VEC_ext_refill(src + i, item_size, cap_items);
+  }
+
+  for (usize i = 0; i < _k; ++i)
+    win[_k + i] = i;
+  for (usize n = _k - 1; n >= 1; --n) {
+    const usize a = win[2 * n], b = win[2 * n + 1];
+    const bool a_wins = DE_C_VEC_ext_less(src, a, b, cmp);
+    win[n] = a_wins ? a : b;
+    tree[n] = a_wins ? b : a;
+  }
+  tree[0] = win[1];
+
+  for (; total; --total) {
+    usize w = tree[0];
+    DE_C_VEC_ext_src *s = src + w;
+    if (s->pos == s->len) {
+      ok = false; /* a run ended early */
+      break;
+    }
+    DE_C_VEC_ext_put(_out, s->buf + s->pos, item_size);
+    s->pos += item_size;
+    if (s->pos == s->len)
+      ok &= DE_C_VEC_ext_refill(s, item_size, cap_items);
+    for (usize n = (_k + w) / 2; n >= 1; n /= 2) {
+      if (DE_C_VEC_ext_less(src, tree[n], w, cmp)) {
+        const usize t = tree[n];
+        tree[n] = w;
+        w = t;
+      }
+    }
+    tree[0] = w;
+  }
+
+  for (usize i = 0; i < _k; ++i)
+    fclose(_runs[i].file);
+  free(tree);
+  free(bufs);
+  free(src);
+  return ok;
+}
+
+/* sorts the buffer and writes it as a new run */
+DE_CONTAINER_VECTOR_INTERNAL bool DE_C_VEC_ext_spill(de_vec_extsort *_sorter) {
+  de_vec *const buffer = &_sorter->buffer;
+  if (!buffer->used)
+    return true;
+  DE_C_VEC_sort_stable(buffer->data, buffer->used, buffer->item_size,
+                       _sorter->cmp, false);
+  DE_C_VEC_ext_run run = {DE_C_VEC_ext_tmpfile(_sorter->temp_dir),
+                          buffer->used};
+  if (!run.file ||
+      fwrite(buffer->data, buffer->item_size, buffer->used, run.file) !=
+          buffer->used) {
+    if (run.file)
+      fclose(run.file);
+    _sorter->failed = true;
+    return false;
+  }
+  de_vec_push_back(&_sorter->runs, &run);
+  buffer->used = 0;
+  return true;
+}
+
+DE_CONTAINER_VECTOR_INTERNAL bool de_vec_extsort_push(
+    de_vec_extsort *const _sorter, const u0 *const _items, const usize _count) {
+  de_vec *const buffer = &_sorter->buffer;
+  if (!buffer->data) {
+    /* exact size, a power of two capacity could overshoot the budget */
+    buffer->data = (DE_C_VEC_VOID_REPLACEMENT *)DE_C_VEC_D_MALLOC(
+        _sorter->run_items * _sorter->item_size);
+    buffer->item_size = _sorter->item_size;
+    buffer->capacity = _sorter->run_items;
+    buffer->used = 0;
+  }
+  const usize item_size = _sorter->item_size;
+  const DE_C_VEC_VOID_REPLACEMENT *items =
+      (const DE_C_VEC_VOID_REPLACEMENT *)_items;
+  usize left = _count;
+  while (left) {
+    /* a failed spill keeps the buffer full, give up with the rest */
+    if (buffer->used == buffer->capacity && !DE_C_VEC_ext_spill(_sorter)) {
+      _sorter->total += _count - left;
+      return false;
+    }
+    usize amount = buffer->capacity - buffer->used;
+    if (amount > left)
+      amount = left;
+    DE_C_VEC_MEMCPY(buffer->data + buffer->used * item_size, items,
+                    amount * item_size);
+    buffer->used += amount;
+    items += amount * item_size;
+    left -= amount;
+  }
+  _sorter->total += _count;
+  return true;
+}
+
+DE_CONTAINER_VECTOR_INTERNAL bool
+de_vec_extsort_push_vec(de_vec_extsort *const _sorter, de_vec *const _vec) {
+#ifndef DE_OPTIONS_VECTOR_NO_SAFETY_ASSERTS
+  DE_C_VEC_ASSERT(_vec->item_size == _sorter->item_size &&
+                  " item sizes have to match");
+#endif
+  return de_vec_extsort_push(_sorter, _vec->data, _vec->used);
+}
+
+DE_CONTAINER_VECTOR_INTERNAL bool
+DE_C_VEC_ext_finish(de_vec_extsort *const _sorter, DE_C_VEC_ext_out *_out) {
+  de_vec *const buffer = &_sorter->buffer;
+  const usize item_size = _sorter->item_size;
+  bool ok = !_sorter->failed;
+
+  if (!_sorter->runs.used) {
+    /* everything fit into memory */
+    if (buffer->used) {
+      DE_C_VEC_sort_stable(buffer->data, buffer->used, item_size,
+                           _sorter->cmp, false);
+      if (_out->emit) {
+        const DE_C_VEC_VOID_REPLACEMENT *it = buffer->data;
+        const DE_C_VEC_VOID_REPLACEMENT *const end =
+            it + buffer->used * item_size;
+        for (; it != end; it += item_size)
+          _out->emit(it, _out->data);
+      } else if (fwrite(buffer->data, item_size, buffer->used, _out->file) !=
+                 buffer->used) {
+        ok = false;
+      }
+    }
+  } else {
+    ok &= DE_C_VEC_ext_spill(_sorter);
+    /* the run buffer is not needed while merging */
+    DE_C_VEC_D_FREE(buffer->data);
+    *buffer = (de_vec){0};
+
+    DE_C_VEC_ext_out tmp = {0};
+    tmp.buf = (DE_C_VEC_VOID_REPLACEMENT *)malloc(_sorter->io_buffer_size);
+    tmp.cap = _sorter->io_buffer_size;
+    /* merge consecutive groups so equal items keep their order */
+    while (_sorter->runs.used > _sorter->fan_in) {
+      de_vec next = de_vec_create(sizeof(DE_C_VEC_ext_run));
+      DE_C_VEC_ext_run *runs = (DE_C_VEC_ext_run *)_sorter->runs.data;
+      const usize count = _sorter->runs.used;
+      for (usize i = 0; i < count; i += _sorter->fan_in) {
+        const usize k =
+            count - i < _sorter->fan_in ? count - i : _sorter->fan_in;
+        DE_C_VEC_ext_run run = {runs[i].file, runs[i].count};
+        if (k > 1) {
+          run.file = DE_C_VEC_ext_tmpfile(_sorter->temp_dir);
+          run.count = 0;
+          if (!run.file) {
+            for (usize j = i; j < i + k; ++j)
+              fclose(runs[j].file);
+            ok = false;
+            continue;
+          }
+          for (usize j = i; j < i + k; ++j)
+            run.count += runs[j].count;
+          tmp.file = run.file;
+          tmp.failed = false;
+          ok &= DE_C_VEC_ext_merge(_sorter, runs + i, k, &tmp);
+          DE_C_VEC_ext_flush(&tmp);
+          ok &= !tmp.failed;
+        }
+        de_vec_push_back(&next, &run);
+      }
+      de_vec_delete(&_sorter->runs);
+      _sorter->runs = next;
+    }
+    free(tmp.buf);
+
+    if (_sorter->runs.used)
+      ok &= DE_C_VEC_ext_merge(_sorter, (DE_C_VEC_ext_run *)_sorter->runs.data,
+                               _sorter->runs.used, _out);
+    _sorter->runs.used = 0;
+  }
+  if (buffer->data)
+    buffer->used = 0;
+  _sorter->total = 0;
+  _sorter->failed = false;
+  return ok;
+}
+
+DE_CONTAINER_VECTOR_INTERNAL bool
+de_vec_extsort_finish(de_vec_extsort *const _sorter,
+                      de_vec_extsort_emit_func _emit, u0 *_data) {
+  DE_C_VEC_ext_out out = {0};
+  out.emit = _emit;
+  out.data = _data;
+  return DE_C_VEC_ext_finish(_sorter, &out);
+}
+
+DE_CONTAINER_VECTOR_INTERNAL bool
+de_vec_extsort_finish_to_file(de_vec_extsort *const _sorter, FILE *_out) {
+  DE_C_VEC_ext_out out = {0};
+  out.file = _out;
+  out.cap = _sorter->io_buffer_size;
+  out.buf = (DE_C_VEC_VOID_REPLACEMENT *)malloc(out.cap);
+  bool ok = DE_C_VEC_ext_finish(_sorter, &out);
+  DE_C_VEC_ext_flush(&out);
+  free(out.buf);
+  return ok && !out.failed;
+}
+
+DE_CONTAINER_VECTOR_INTERNAL u0
+de_vec_extsort_delete(de_vec_extsort *const _sorter) {
+  DE_C_VEC_ext_run *runs = (DE_C_VEC_ext_run *)_sorter->runs.data;
+  for (usize i = 0; i < _sorter->runs.used; ++i)
+    fclose(runs[i].file);
+  de_vec_delete(&_sorter->runs);
+  if (_sorter->buffer.data)
+    DE_C_VEC_D_FREE(_sorter->buffer.data);
+  *_sorter = (de_vec_extsort){0};
+}
+
 /*
    swap and unpack
 */